@@ -0,0 +1,83 @@
+#ifndef FLEMU_ADD_PROBE_HPP
+#define FLEMU_ADD_PROBE_HPP
+
+#include <cstdint>
+
+#include <array>
+
+namespace flemu
+{
+
+// the decisions in add that a probe observes. each of them is reported as
+// probe(point, taken) once per add, so that a fuzzer can see which way every
+// one of them went (see src/fuzz.cpp), and the counters can count them (see
+// counters.hpp).
+//
+// denormal_to_normal is never taken: a tiny sum is exact, so it is not
+// rounded. it is kept to confirm that, and for formats and modes to come.
+enum class add_point : std::uint32_t
+{
+    swap,                  // |x| > |y| before the swap
+    subtraction,           // the signs differ
+    zero_operand,          // one of them is zero (then it is x)
+    x_denormal,            // the smaller one is denormalized (or zero)
+    y_denormal,            // the larger one is denormalized (or zero)
+    same_exponent,         // no alignment shift
+    exponent_gap_one,      // alignment by 1
+    all_sticky,            // x is shifted out entirely into the sticky bit
+    sticky,                // the sticky bit is 1 after the alignment
+    carry,                 // carry-up by addition
+    shift_one,             // normalization by 1
+    cancellation,          // normalization by more than 1
+    denormal_boundary,     // the normalization stopped at exponent == 1
+    tiny,                  // denormalized before rounding
+    tie,                   // the extra bits are exactly a half
+    round_up,              // the rounding mode rounds the magnitude up
+    rounding_carry,        // rounding up carries into the exponent
+    denormal_to_normal,    // 0.111...1 rounds up to 1.000...0
+    overflow,              // the rounded magnitude reaches inf
+    exact_zero,            // the sum is exactly zero
+    nan,                   // y is nan
+    inf_minus_inf,         // inf - inf
+    inf,                   // y is inf, the sum is inf
+};
+inline constexpr std::size_t num_add_points = 23;
+
+inline constexpr std::array<const char*, num_add_points> add_point_names = {
+    "swap", "subtraction", "zero_operand", "x_denormal", "y_denormal", "same_exponent",
+    "exponent_gap_one", "all_sticky", "sticky", "carry", "shift_one", "cancellation",
+    "denormal_boundary", "tiny", "tie", "round_up", "rounding_carry", "denormal_to_normal",
+    "overflow", "exact_zero", "nan", "inf_minus_inf", "inf",
+};
+
+constexpr const char* add_point_name(const add_point p) noexcept
+{
+    return add_point_names[static_cast<std::uint32_t>(p)];
+}
+
+// the amounts in add that a probe can observe as probe(measure, value), if
+// it has that overload. the values are clamped to add_measure_bins - 1.
+//
+//   - exponent_gap        : the alignment shift, |exp(y) - exp(x)|
+//   - normalization_shift : the left shift after a cancellation (0 if the sum is 0)
+enum class add_measure : std::uint32_t
+{
+    exponent_gap,
+    normalization_shift,
+};
+inline constexpr std::size_t num_add_measures = 2;
+inline constexpr std::size_t add_measure_bins = 32;
+
+namespace detail
+{
+
+// the probe that add_unrecorded uses by default. it is not called.
+struct no_probe
+{
+    static constexpr bool enabled = false;
+    constexpr void operator()(add_point, bool) const noexcept {}
+};
+
+} // detail
+} // flemu
+#endif // FLEMU_ADD_PROBE_HPP
@@ -2,423 +2,355 @@
 #define FLEMU_ADDER_HPP
 
 #include "float32.hpp"
+#include "add_probe.hpp"
+#include "assumptions.hpp"
+#include "flags.hpp"
+#include "rounding.hpp"
+
+// the hooks and their headers are compiled only if they are enabled.
+#ifdef FLEMU_ENABLE_COUNTERS
+#  include "counters.hpp"
+#endif
+#ifdef FLEMU_ENABLE_RECORDER
+#  include "recorder.hpp"
+#endif
 
-#include <boost/ut.hpp>
+#include <cassert>
+#include <cstdint>
 
-#include <random>
-#include <tuple>
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <type_traits>
 
 namespace flemu
 {
 
-inline float32 add(const float32& x_, const float32& y_) noexcept
+namespace detail
 {
-    // ------------------------------------------------------------------------
-    // always make x <= y
-    const auto [x, y] = [&]
-    {
-        if(x_.exponent() == y_.exponent())
-        {
-            if(x_.mantissa() < y_.mantissa())
-            {
-                return std::make_pair(x_, y_);
-            }
-            else
-            {
-                return std::make_pair(y_, x_);
-            }
-        }
-        else
-        {
-            if(x_.exponent() < y_.exponent())
-            {
-                return std::make_pair(x_, y_);
-            }
-            else
-            {
-                return std::make_pair(y_, x_);
-            }
-        }
-    }();
 
-    const std::uint32_t xsgn(x.sign());
-    const std::uint32_t xexp(x.exponent());
-    const std::uint32_t xman(x.mantissa());
+// bit positions and constants used in add, as functions of the format and
+// the rounding mode.
+//
+// the mantissa is extended with the implicit 1 and `extra_bits` additional
+// bits (guard, round and sticky in the deterministic modes), and one more bit
+// is needed for the carry-up by addition. for float32 with 3 extra bits, the
+// implicit 1 is at bit 26 and the carry is at bit 27.
+template<typename Float, rounding_policy Rounding = rounding::nearest_even>
+struct add_traits
+{
+    static constexpr std::size_t mantissa_bits = Float::mantissa_bits;
+    static constexpr std::size_t extra_bits    = Rounding::extra_bits;
+    static_assert(mantissa_bits + extra_bits + 2 <= 64,
+                  "the mantissa and the extra bits of the rounding mode should fit in 64 bits; "
+                  "float64 allows at most 10 extra bits (e.g. stochastic<RNG, 10>)");
+
+    using work_type = std::conditional_t<(mantissa_bits + extra_bits + 2 <= 32),
+                                         std::uint32_t, std::uint64_t>;
+
+    static constexpr std::size_t work_bits      = sizeof(work_type) * 8;
+    static constexpr std::size_t implicit_bit   = mantissa_bits + extra_bits;
+    static constexpr std::size_t carry_bit      = mantissa_bits + extra_bits + 1;
+    static constexpr work_type   implicit       = work_type(1) << mantissa_bits;
+    static constexpr work_type   exponent_max   = Float::exponent_max;
+    static constexpr work_type   magnitude_mask = Float::magnitude_mask;
+    static constexpr work_type   inf            = exponent_max << mantissa_bits;
+    static constexpr work_type   nan            = inf | work_type(1);
+};
 
-    const std::uint32_t ysgn(y.sign());
-    const std::uint32_t yexp(y.exponent());
-    const std::uint32_t yman(y.mantissa());
+// shifts `man` right, OR-ing all the bits shifted out into the lowest bit
+// (the sticky bit). the shift width is clamped to keep it well-defined; if
+// `man` does not use the highest bit, the result is the same.
+template<std::unsigned_integral UInt>
+constexpr UInt shift_right_sticky(const UInt man, const UInt shift) noexcept
+{
+    const UInt s = std::min<UInt>(shift, sizeof(UInt) * 8 - 1);
+    const UInt sticky = (man & ((UInt(1) << s) - 1)) == 0 ? 0 : 1;
+    return (man >> s) | sticky;
+}
 
-    // ------------------------------------------------------------------------
-    // check special values
-    const auto xinf  = (xexp == 0b1111'1111) && (xman == 0);
-    const auto yinf  = (yexp == 0b1111'1111) && (yman == 0);
-    const auto xnan  = (xexp == 0b1111'1111) && (xman != 0);
-    const auto ynan  = (yexp == 0b1111'1111) && (yman != 0);
-    const auto xzero = (xexp == 0) && (xman == 0);
-    const auto yzero = (yexp == 0) && (yman == 0);
-    const auto xdenorm = (xexp == 0) && (xman != 0);
-    const auto ydenorm = (yexp == 0) && (yman != 0);
-
-    if(xnan || ynan) // z + nan == nan,  nan + z == nan
-    {
-        return float32(0b0, 0b1111'1111, 0b1);
-    }
-    else if (xinf || yinf)
-    {
-        if(xinf && yinf)
-        {
-            if(xsgn != ysgn) // inf - inf == nan, -inf + inf == nan
-            {
-                return float32(0b0, 0b1111'1111, 0b1);
-            }
-            else // inf + inf == inf, -inf + (-inf) = -inf
-            {
-                return float32(std::uint32_t(xsgn), 0b1111'1111, 0b0);
-            }
-        }
-        else if((xinf && xsgn == 0) || (yinf && ysgn == 0)) // inf + * == inf
-        {
-            return float32(0b0, 0b1111'1111, 0b0);
-        }
-        else  // -inf + * == -inf
-        {
-            return float32(0b1, 0b1111'1111, 0b0);
-        }
-    }
-    else if (xzero || yzero)
-    {
-        if(xzero && yzero)
-        {
-            // we here consider only nearest-(even)-rounding.
-            // in case of negative-inf-rounding, (+0) + (-0) should be (-0).
-            return float32(0);
-        }
-        else if (xzero)
-        {
-            return y;
-        }
-        else // yzero
-        {
-            return x;
-        }
-    }
+// packs a mantissa that has the implicit 1 at `implicit_bit` and `extra_bits`
+// additional bits with the rounding mode. denormalized numbers have zexp == 1
+// without the implicit 1.
+//
+// the implicit 1 (at bit `mantissa_bits` after >> extra_bits) adds 1 to
+// (zexp - 1), so a denormalized result (zexp == 1 without the implicit 1)
+// becomes exponent 0. carry-up by rounding (1.111...1 -> 10.000...0)
+// propagates into the exponent in the same way, and also turns 0.111...1 into
+// 1.000...0.
+//
+// an overflow (it was not nan) becomes inf, or the max finite (inf - 1) if the
+// rounding mode does not round its magnitude up.
+template<typename Float, rounding_policy Rounding, std::unsigned_integral UInt>
+constexpr UInt pack_rounded(const Rounding& rnd, const UInt zsgn, const UInt zexp, const UInt zman) noexcept
+{
+    using traits = add_traits<Float, Rounding>;
+
+    UInt zmag = ((zexp - 1) << traits::mantissa_bits) + (zman >> traits::extra_bits) +
+                rnd.round_up(zsgn, zman);
+    zmag = std::min<UInt>(zmag, traits::inf - Rounding::overflow_to_max(zsgn));
+    return (zsgn << Float::sign_bit) | zmag;
+}
+
+// exception flags of pack_rounded with the same arguments. it does not touch
+// the packed value, so it can run beside it.
+//
+//   - inexact   : any of the extra bits is 1, or overflow
+//   - overflow  : the rounded magnitude reached the exponent of inf
+//   - underflow : tiny (no implicit 1, i.e. denormalized before rounding) and inexact
+template<typename Float, rounding_policy Rounding, std::unsigned_integral UInt>
+constexpr std::uint32_t rounding_flags(const Rounding& rnd, const UInt zsgn, const UInt zexp,
+                                       const UInt zman) noexcept
+{
+    using traits = add_traits<Float, Rounding>;
+
+    const UInt zmag = ((zexp - 1) << traits::mantissa_bits) + (zman >> traits::extra_bits) +
+                      rnd.round_up(zsgn, zman);
+    const bool overflow = zmag >= traits::inf;
+    const bool inexact  = (zman & mask<UInt>(traits::extra_bits - 1, 0)) != 0 || overflow;
+    const bool tiny     = (zman >> traits::implicit_bit) == 0;
+
+    return (overflow ? flag_overflow : 0u) | (inexact ? flag_inexact : 0u) |
+           (tiny && inexact ? flag_underflow : 0u);
+}
+
+// add without the recorder hook. fma adds a zero product by this, so that it
+// is recorded once, as fma. a probe observes the decisions; see add_point.
+// the stages that Assume rules out are not compiled; see assumptions.hpp.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags, typename Probe = no_probe,
+         assumption_policy Assume = assume::none>
+constexpr basic_float<E, M, B, S> add_unrecorded(const basic_float<E, M, B, S>& x_,
+                            const basic_float<E, M, B, S>& y_,
+                            const Rounding& rnd, const Flags& flg,
+                            const Probe& probe = Probe{}, const Assume& = Assume{}) noexcept
+{
+    using float_type = basic_float<E, M, B, S>;
+    using base_type  = typename float_type::base_type;
+    using traits     = add_traits<float_type, Rounding>;
+    constexpr std::size_t extra_bits = traits::extra_bits;
+    using work_type  = typename traits::work_type;
+
+    assert(satisfies<Assume>(x_) && satisfies<Assume>(y_)); // the assumption holds?
 
     // ------------------------------------------------------------------------
-    // align mantissa (always x.exp <= y.exp)
+    // always make |x| <= |y|. comparing the bits except the sign is the same
+    // as comparing (exponent, mantissa) lexicographically.
 
-    const auto [xman_aligned, yman_aligned, xexp_norm, yexp_norm] = [&]
-    {
-        std::uint32_t xexp_norm = xexp;
-        std::uint32_t yexp_norm = yexp;
-        std::uint32_t xman_aligned = (1 << 23);
-        std::uint32_t yman_aligned = (1 << 23);
+    const bool swap = (x_.base() & float_type::magnitude_mask) >
+                      (y_.base() & float_type::magnitude_mask);
+    const float_type x = swap ? y_ : x_;
+    const float_type y = swap ? x_ : y_;
 
-        if(xdenorm)
-        {
-            xman_aligned = 0; // remove implicit 1
-            xexp_norm   += 1;
-        }
-        if(ydenorm)
-        {
-            yman_aligned = 0;
-            yexp_norm   += 1;
-        }
+    const work_type xsgn = base_type(x.sign());
+    const work_type xexp = base_type(x.exponent());
+    const work_type xman = base_type(x.mantissa());
 
-        xman_aligned += std::uint32_t(xman);
-        yman_aligned += std::uint32_t(yman);
-        xman_aligned <<= 3;
-        yman_aligned <<= 3;
+    const work_type ysgn = base_type(y.sign());
+    const work_type yexp = base_type(y.exponent());
+    const work_type yman = base_type(y.mantissa());
 
-        if(xexp_norm == yexp_norm)
-        {
-            return std::make_tuple(xman_aligned, yman_aligned, xexp_norm, yexp_norm);
-        }
-        // exponent is different
-        const std::uint32_t expdiff = std::uint32_t(yexp_norm) - std::uint32_t(xexp_norm);
-
-        //         mantissa      additional bits
-        //    .---------------. .---.
-        // y:| 1.xxxxxxxxxxxxxx|0|0|0|
-        // x:     | 1.xxxxxxxxx|x|x|x|x|x|0|0|0| >> expdiff == e.g. 5
-        //                      | | | '-------'
-        //                      | | |  sticky region
-        //                      | | + sticky bit
-        //                      | + round bit
-        //                      + guard bit
-
-        if(expdiff >= 27) // 1 + 23 + 3
-        {
-            xman_aligned = 0;
-        }
-        else
-        {
-            std::uint32_t sticky = 0;
-            if(expdiff > 3)
-            {
-                const auto sticky_region = xman_aligned & mask<std::uint32_t>(expdiff - 1, 0);
-                sticky = (sticky_region == 0) ? 0 : 1;
-            }
-            xman_aligned >>= expdiff;
-            xman_aligned |= sticky;
-        }
-        return std::make_tuple(xman_aligned, yman_aligned, xexp_norm, yexp_norm);
-    }();
+    // ------------------------------------------------------------------------
+    // align mantissa (always x.exp <= y.exp)
 
-//     std::cerr << "xman_aligned = " << as_bit(xman_aligned) << std::endl;
-//     std::cerr << "yman_aligned = " << as_bit(yman_aligned) << std::endl;
+    //         mantissa      additional bits (3 in the deterministic modes)
+    //    .---------------. .---.
+    // y:| 1.xxxxxxxxxxxxxx|0|0|0|
+    // x:     | 1.xxxxxxxxx|x|x|x|x|x|0|0|0| >> expdiff == e.g. 5
+    //                      | | | '-------'
+    //                      | | |  sticky region
+    //                      | | + sticky bit
+    //                      | + round bit
+    //                      + guard bit
+    //
+    // denormalized numbers do not have the implicit 1 but have the same scale
+    // as the numbers with exponent == 1. with DAZ, they are zeros, and the
+    // scale of a zero does not matter.
+
+    constexpr bool daz = Assume::denormals_are_zero;
+    const work_type xexp_norm = daz ? xexp : std::max<work_type>(xexp, 1);
+    const work_type yexp_norm = daz ? yexp : std::max<work_type>(yexp, 1);
+    const work_type xman_ext  = daz ? (xexp == 0 ? 0 : (traits::implicit + xman) << extra_bits)
+                                    : ((xexp == 0 ? 0 : traits::implicit) + xman) << extra_bits;
+    const work_type yman_ext  = daz ? (yexp == 0 ? 0 : (traits::implicit + yman) << extra_bits)
+                                    : ((yexp == 0 ? 0 : traits::implicit) + yman) << extra_bits;
+
+    // if expdiff >= mantissa_bits + extra_bits + 1 (27 in float32), all the
+    // bits go to the sticky region.
+    const work_type xman_aligned =
+        shift_right_sticky(xman_ext, yexp_norm - xexp_norm);
 
     // ------------------------------------------------------------------------
-    // add/sub mantissa and round
-
-    //           26 25       22 ...  03 02 01 00
-    // y: | 0...| 1| z| z| z| z|... | z| 0| 0| 0|
-    // x: | 0...| 0| 0| 0| 1| z|... | z| z| z| z|
-    //             '-------------------' |  |  +- sticky
-    //                   mantissa        |  +---- round
-    //                                   +------- guard
-
-    std::uint32_t zsgn(ysgn);
-    std::uint32_t zexp(yexp_norm);
-    if(xsgn != ysgn) // subtract. always abs(x) < abs(y), so the sign is y.
-    {
-        std::uint32_t zman = yman_aligned - xman_aligned;
+    // add/sub mantissa
+
+    // float32 case with 3 extra bits:
+    //        27 26 25       22 ...  03 02 01 00
+    // y: | 0| 0| 1| z| z| z| z|... | z| 0| 0| 0|
+    // x: | 0| 0| 0| 0| 0| 1| z|... | z| z| z| z|
+    //     |     '-------------------' |  |  +- sticky
+    //     |           mantissa        |  +---- round
+    //     +- carry                    +------- guard
+    //
+    // since |x| <= |y|, the sign is y's one and subtraction never underflows.
+
+    work_type zman = (xsgn == ysgn) ? yman_ext + xman_aligned
+                                    : yman_ext - xman_aligned;
+    work_type zexp = yexp_norm;
+
+    // check carry-up by addition (1x.xxx -> 1.xxxx). keep the sticky bit.
+    const work_type carry = zman >> traits::carry_bit;
+    zman   = shift_right_sticky(zman, carry);
+    zexp  += carry;
+
+    // normalize in one shift. if it would go below the denormal boundary,
+    // stop at exponent == 1 and leave it denormalized. with FTZ, the result
+    // is flushed there instead, so the shift is not clamped and zexp may wrap.
+    const work_type leading_zeros = work_type(std::countl_zero(zman)) -
+                                    work_type(traits::work_bits - 1 - traits::implicit_bit);
+    const bool      flush = Assume::flush_to_zero && zman != 0 && leading_zeros >= zexp;
+    const work_type shift = Assume::flush_to_zero ? leading_zeros : std::min<work_type>(leading_zeros, zexp - 1);
+    zman <<= shift;
+    zexp  -= shift;
+    assert(bit_at(zman, traits::implicit_bit) == 1 || zexp == 1 || zman == 0); // normalized?
 
-        if(zman == 0)
-        {
-            // zero cannot be normalized
-            return float32(zsgn, 0u, 0u);
-        }
+    // ------------------------------------------------------------------------
+    // round and pack
 
-        while(bit_at(zman, 26) == 0)
-        {
-            zexp  -= 1;
-            if(zexp == 0)
-            {
-                // since it becomes denormalized number, we don't need to
-                // normalize it.
-                break;
-            }
-            zman <<= 1;
-        }
+    work_type z = pack_rounded<float_type>(rnd, ysgn, zexp, zman);
 
-        if(zexp == 0)
-        {
-            // if it is 0.111...111, then it will be 1.00 after rounding and
-            // will become normalized.
-            if((zman & mask<std::uint32_t>(25, 2)) >> 2 == (1<<24)-1)
-            {
-                return float32(zsgn, std::uint32_t(1), std::uint32_t(0));
-            }
-        }
+    // FTZ. a tiny result becomes a zero of its sign.
+    z = flush ? (ysgn << float_type::sign_bit) : z;
 
-        // consider nearest-even rounding only
-        if(bit_at(zman, 2) == 1)
-        {
-            if(bit_at(zman, 1) == 0 && bit_at(zman, 0) == 0) // to even
-            {
-                if(bit_at(zman, 3) == 0)
-                {
-                    // already even. do nothing.
-                }
-                else // its odd.
-                {
-                    zman += 0b1000;
-                }
-            }
-            else // to nearest (upper)
-            {
-                zman += 0b1000;
-            }
-        }
+    // an exact zero. (-0) + (-0) == (-0) in all the modes. x + (-x) and
+    // (+0) + (-0) are (-0) in negative-inf-rounding and (+0) otherwise.
+    z = (zman == 0) ? (Rounding::exact_zero_sign(xsgn, ysgn) << float_type::sign_bit) : z;
 
-        // check carry-up by rounding (1.11111 -> 10.0000)
-        // 10.0000e+2 == 1.0000e+3
-        if(bit_at(zman, 27) == 1)
-        {
-            zexp  += 1;
-            zman >>= 1;
-        }
-        assert(bit_at(zman, 26) == 1 || zexp == 0); // normalized?
+    // ------------------------------------------------------------------------
+    // special values. since |x| <= |y|, y is inf or nan if any of them is.
+    //   z + nan == nan, inf - inf == nan, inf + * == inf, -inf + * == -inf
+    // if the operands are assumed to be finite, there are none.
+
+    const bool is_special = !Assume::finite && (yexp == traits::exponent_max);
+    const bool ynan       = is_special && (yman != 0);
+    const bool inf_inf    = is_special && (xexp == traits::exponent_max) && (xsgn != ysgn);
+    if constexpr(!Assume::finite)
+    {
+        const work_type special = (ynan || inf_inf) ? traits::nan : work_type(y.base());
+        z = is_special ? special : z;
+    }
 
-        if(zexp == 0b1111'1111)
+    // ------------------------------------------------------------------------
+    // probe. nothing above depends on it, and without a probe it is not compiled.
+
+    if constexpr(Probe::enabled)
+    {
+        const work_type expdiff  = yexp_norm - xexp_norm;
+        const work_type extra    = zman & mask<work_type>(extra_bits - 1, 0);
+        const work_type rounded  = (zman >> extra_bits) + rnd.round_up(ysgn, zman);
+        const bool      tiny     = zman != 0 && (zman >> traits::implicit_bit) == 0;
+        const bool      rcarry   = (rounded >> traits::mantissa_bits) != (zman >> traits::implicit_bit);
+        probe(add_point::swap,               swap);
+        probe(add_point::subtraction,        xsgn != ysgn);
+        probe(add_point::zero_operand,       xexp == 0 && xman == 0);
+        probe(add_point::x_denormal,         xexp == 0);
+        probe(add_point::y_denormal,         yexp == 0);
+        probe(add_point::same_exponent,      expdiff == 0);
+        probe(add_point::exponent_gap_one,   expdiff == 1);
+        probe(add_point::all_sticky,         expdiff > traits::implicit_bit);
+        probe(add_point::sticky,             (xman_aligned & 1) != 0);
+        probe(add_point::carry,              carry != 0);
+        probe(add_point::shift_one,          zman != 0 && leading_zeros == 1);
+        probe(add_point::cancellation,       zman != 0 && leading_zeros > 1);
+        probe(add_point::denormal_boundary,  zman != 0 && shift < leading_zeros);
+        probe(add_point::tiny,               tiny);
+        probe(add_point::tie,                extra == (work_type(1) << (extra_bits - 1)));
+        probe(add_point::round_up,           rounded != (zman >> extra_bits));
+        probe(add_point::rounding_carry,     rcarry);
+        probe(add_point::denormal_to_normal, tiny && rcarry);
+        probe(add_point::overflow,           !is_special && ((zexp - 1) << traits::mantissa_bits) + rounded >= traits::inf);
+        probe(add_point::exact_zero,         !is_special && zman == 0);
+        probe(add_point::nan,                ynan);
+        probe(add_point::inf_minus_inf,      inf_inf && !ynan);
+        probe(add_point::inf,                is_special && !ynan && !inf_inf);
+
+        if constexpr(requires {probe(add_measure::exponent_gap, std::uint32_t(0));})
         {
-            // it was not nan, so here it should be inf
-            zman = 0;
+            constexpr work_type max_bin = add_measure_bins - 1;
+            probe(add_measure::exponent_gap,        std::uint32_t(std::min(expdiff, max_bin)));
+            probe(add_measure::normalization_shift, std::uint32_t(zman == 0 ? 0 : std::min(shift, max_bin)));
         }
-        return float32(zsgn, zexp, std::uint32_t(bit_proxy(zman, 25, 3)));
     }
-    else // add.
-    {
-        assert(bit_at(xman_aligned, 27) == 0);
-        assert(bit_at(yman_aligned, 27) == 0);
-        std::uint32_t zman = yman_aligned + xman_aligned;
 
-        // check carry-up by addition
-        if(bit_at(zman, 27) == 1)
-        {
-            // if we shift before checking round, the sticky bit will be lost.
-
-            if(bit_at(zman, 3) == 1) // need to round up.
-            {
-                if(bit_at(zman, 2) == 0 && bit_at(zman, 1) == 0 && bit_at(zman, 0) == 0) // to even
-                {
-                    if(bit_at(zman, 4) == 0)
-                    {
-                        // already even. do nothing.
-                    }
-                    else
-                    {
-                        zman += 0b1'0000;
-                    }
-                }
-                else // to nearest (upper)
-                {
-                    zman += 0b1'0000;
-                }
-            }
-            if(bit_at(zman, 28) == 1)
-            {
-                zexp  += 2;
-                zman >>= 2;
-            }
-            else if(bit_at(zman, 27) == 1)
-            {
-                zexp  += 1;
-                zman >>= 1;
-            }
-            else
-            {
-                assert(false);
-            }
-        }
-        else
-        {
-            if(bit_at(zman, 2) == 1) // need to round up.
-            {
-                if(bit_at(zman, 1) == 0 && bit_at(zman, 0) == 0) // to even
-                {
-                    if(bit_at(zman, 3) == 0)
-                    {
-                        // already even. do nothing.
-                    }
-                    else
-                    {
-                        zman += 0b1000;
-                    }
-                }
-                else // to nearest (upper)
-                {
-                    zman += 0b1000;
-                }
-            }
-            // check carry-up by rounding.
-            if(bit_at(zman, 27) == 1)
-            {
-                zexp  += 1;
-                zman >>= 1;
-            }
-        }
-        assert(bit_at(zman, 26) == 1); // normalized?
+    // ------------------------------------------------------------------------
+    // exception flags. nothing above depends on them.
 
-        if(zexp == 0b1111'1111)
-        {
-            // it was not nan, so here it should be inf
-            zman = 0;
-        }
-        return float32(zsgn, zexp, std::uint32_t(bit_proxy(zman, 25, 3)));
+    if constexpr(Flags::enabled)
+    {
+        const std::uint32_t invalid = (inf_inf && !ynan) ? flag_invalid : 0u;
+        flg.raise(is_special ? invalid :
+                  flush      ? (flag_underflow | flag_inexact) :
+                  zman == 0  ? 0u : // zexp may have wrapped with DAZ or FTZ
+                  rounding_flags<float_type>(rnd, ysgn, zexp, zman));
     }
+    return float_type(base_type(z));
 }
 
-#ifdef FLEMU_ACTIVATE_UNIT_TESTS
-inline boost::ut::suite tests_adder = []
+} // detail
+
+// x + y rounded by the rounding mode, under the assumptions of `assume` (see
+// assumptions.hpp); e.g. add(x, y, rounding::nearest_even{}, flags::ignore{},
+// assume::finite_ftz_daz{}). each combination has its own instantiation.
+//
+// an operation with DAZ or FTZ is recorded with rounding_id::other, since the
+// replay runs add without them.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags, assumption_policy Assume>
+constexpr basic_float<E, M, B, S> add(const basic_float<E, M, B, S>& x, const basic_float<E, M, B, S>& y,
+                            const Rounding& rnd, const Flags& flg, const Assume& assume) noexcept
 {
-    using namespace boost::ut::literals;
-
-    "add(float32, float32)"_test = []
+#ifdef FLEMU_ENABLE_COUNTERS
+    const auto z = std::is_constant_evaluated() ? detail::add_unrecorded(x, y, rnd, flg, detail::no_probe{}, assume) :
+                   detail::add_unrecorded(x, y, rnd, flg, counters::add_probe(), assume);
+#else
+    const auto z = detail::add_unrecorded(x, y, rnd, flg, detail::no_probe{}, assume);
+#endif
+#ifdef FLEMU_ENABLE_RECORDER
+    if(!std::is_constant_evaluated())
     {
-        const auto x1 = to_flemu(1.0f);
-        const auto y1 = to_flemu(1.0f);
-        const auto z1 = add(x1, y1);
-
-        boost::ut::expect(to_float(z1) == 2.0f);
-
-//         std::cout << to_float(x1) << " + " << to_float(y1) << " = " << to_float(z1) << " != 2.0f"<< std::endl;
-//         std::cout << z1.sign() << "|" << z1.exponent() << "|" << z1.mantissa() << std::endl;
-//         std::cout << "========================================================================" << std::endl;
-
-        const auto x2 = to_flemu( 1.0f);
-        const auto y2 = to_flemu(10.0f);
-        const auto z2 = add(x2, y2);
-
-        boost::ut::expect(to_float(z2) == 11.0f);
-
-//         std::cout << to_float(x2) << " + " << to_float(y2) << " = " << to_float(z2) << " != 11.0f"<< std::endl;
-//         std::cout << z2.sign() << "|" << z2.exponent() << "|" << z2.mantissa() << std::endl;
-//         std::cout << "========================================================================" << std::endl;
-
-        const auto x3 = to_flemu(1.0e-30f);
-        const auto y3 = to_flemu(1.0e+30f);
-        const auto z3 = add(x3, y3);
-
-        boost::ut::expect(to_float(z3) == 1.0e+30f);
-
-//         std::cout << to_float(x3) << " + " << to_float(y3) << " = " << to_float(z3) << " != 1.0e+30f"<< std::endl;
-//         std::cout << z3.sign() << "|" << z3.exponent() << "|" << z3.mantissa() << std::endl;
-//         std::cout << "========================================================================" << std::endl;
-
-        std::mt19937 rng(123456789);
-
-        std::uniform_int_distribution<std::uint32_t> sgn(0,   1);
-        std::uniform_int_distribution<std::uint32_t> exp(0, 255); // not including denormalized
-        std::uniform_int_distribution<std::uint32_t> man(0, 0x007F'FFFF);
-
-        const std::size_t N = 10000;
-        for(std::size_t i=0; i<N; ++i)
-        {
-            const std::uint32_t xi = (sgn(rng) << 31) + (exp(rng) << 23) + man(rng);
-            const std::uint32_t yi = (sgn(rng) << 31) + (exp(rng) << 23) + man(rng);
-//             const std::uint32_t xi = (0 << 31) + (exp(rng) << 23) + man(rng);
-//             const std::uint32_t yi = (0 << 31) + (exp(rng) << 23) + man(rng);
-//             const std::uint32_t xi = 0b1101'1100'0000'1001'0010'1110'0100'0000;
-//             const std::uint32_t yi = 0b1101'1010'0011'0100'0101'1100'0010'1001;
-//             const std::uint32_t xi = 0b1100'1101'1111'1110'1111'1100'1100'1101;
-//             const std::uint32_t yi = 0b1100'1011'0010'1101'1011'0101'0000'0100;
-
-            boost::ut::log << "----------------------------------------------";
-            boost::ut::log << "     sxxx'xxxx'xmmm'mmmm'mmmm'mmmm'mmmm'mmmm";
-            boost::ut::log << "xr =" << as_bit(xi);
-            boost::ut::log << "yr =" << as_bit(yi);
-
-            const float xr = bit_cast<float>(xi);
-            const float yr = bit_cast<float>(yi);
-            const float zr = xr + yr;
-
-            boost::ut::log << "zr =" << as_bit(bit_cast<std::uint32_t>(zr));
-
-            const auto x = to_flemu(xr);
-            const auto y = to_flemu(yr);
-            const auto z = add(x, y);
-
-            boost::ut::log << "z  =" << as_bit(z.base());
-
-            if(z.is_nan())
-            {
-                boost::ut::expect(std::isnan(zr))
-                    << "z = " << as_bit(z.base()) << " is NaN but "
-                    << "zr = " << as_bit(bit_cast<std::uint32_t>(zr)) << " is not nan";
-            }
-            else
-            {
-                boost::ut::expect(to_float(z) == zr)
-                    << as_bit(z.base()) << " != " << as_bit(bit_cast<std::uint32_t>(zr));
-            }
-        }
-    };
-};
+        using recorded = std::conditional_t<Assume::denormals_are_zero || Assume::flush_to_zero, void, Rounding>;
+        recorder::record_op<basic_float<E, M, B, S>, recorded>(recorder::opcode::add, x, y,
+                                                               basic_float<E, M, B, S>(), z);
+    }
 #endif
+    return z;
+}
 
+// x + y rounded by the rounding mode. each rounding mode has its own
+// instantiation; e.g. add(x, y, rounding::toward_zero{}).
+//
+// the exception flags are reported to `flg`; see flags.hpp. a tiny sum is
+// always exact, so add never raises underflow.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags>
+constexpr basic_float<E, M, B, S> add(const basic_float<E, M, B, S>& x, const basic_float<E, M, B, S>& y,
+                            const Rounding& rnd, const Flags& flg) noexcept
+{
+    return add(x, y, rnd, flg, assume::none{});
+}
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S, rounding_policy Rounding>
+constexpr basic_float<E, M, B, S> add(const basic_float<E, M, B, S>& x, const basic_float<E, M, B, S>& y,
+                            const Rounding& rnd) noexcept
+{
+    return add(x, y, rnd, flags::ignore{});
+}
 
+// x + y with nearest-(even)-rounding.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr basic_float<E, M, B, S> add(const basic_float<E, M, B, S>& x, const basic_float<E, M, B, S>& y) noexcept
+{
+    return add(x, y, rounding::nearest_even{});
+}
 
 } // flemu
 #endif // FLEMU_ADDER_HPP
@@ -0,0 +1,68 @@
+#ifndef FLEMU_ASSUMPTIONS_HPP
+#define FLEMU_ASSUMPTIONS_HPP
+
+#include "float32.hpp"
+
+#include <cstdint>
+
+#include <concepts>
+
+namespace flemu
+{
+
+// What add may assume about its operands, and how it treats denormals. It is
+// passed to add as a policy object after the rounding mode and the flags, and
+// selected at compile time, so each combination is its own kernel and the
+// paths that it rules out are not compiled.
+//
+//   - finite             : no operand is inf or nan. the special-value
+//                          stage is removed. a finite overflow still becomes
+//                          inf (or the max finite, by the rounding mode).
+//   - denormals_are_zero : (DAZ) a denormal operand is read as a zero of its
+//                          sign. an operand is then either normal or zero,
+//                          and the alignment does not need the denormal scale.
+//   - flush_to_zero      : (FTZ) a result that is tiny before rounding
+//                          becomes a zero of its sign, and raises underflow
+//                          and inexact. the normalization does not need to
+//                          stop at the denormal boundary.
+//
+// DAZ and FTZ change the results, as on the accelerators that run in these
+// modes. `finite` does not; it is an assumption, and if it does not hold the
+// result is unspecified. in a build without NDEBUG, add asserts it for each
+// operand (see satisfies).
+namespace assume
+{
+
+template<bool Finite, bool DenormalsAreZero, bool FlushToZero>
+struct mode
+{
+    static constexpr bool finite             = Finite;
+    static constexpr bool denormals_are_zero = DenormalsAreZero;
+    static constexpr bool flush_to_zero      = FlushToZero;
+};
+
+// all the IEEE semantics. this is the default.
+using none           = mode<false, false, false>;
+using finite         = mode<true,  false, false>;
+using ftz_daz        = mode<false, true,  true >;
+using finite_ftz_daz = mode<true,  true,  true >;
+
+} // assume
+
+template<typename Assume>
+concept assumption_policy = requires
+{
+    {Assume::finite}             -> std::convertible_to<bool>;
+    {Assume::denormals_are_zero} -> std::convertible_to<bool>;
+    {Assume::flush_to_zero}      -> std::convertible_to<bool>;
+};
+
+// true if x is an operand that Assume allows. DAZ and FTZ accept any operand.
+template<assumption_policy Assume, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr bool satisfies(const basic_float<E, M, B, S>& x) noexcept
+{
+    return !Assume::finite || x.exponent() != basic_float<E, M, B, S>::exponent_max;
+}
+
+} // flemu
+#endif // FLEMU_ASSUMPTIONS_HPP
@@ -0,0 +1,662 @@
+#ifndef FLEMU_BATCH_ADDER_HPP
+#define FLEMU_BATCH_ADDER_HPP
+
+#include "float32.hpp"
+#include "adder.hpp"
+#include "assumptions.hpp"
+#include "flags.hpp"
+#include "rounding.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include <span>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define FLEMU_BATCH_ADDER_X86 1
+#  include <immintrin.h>
+#endif
+
+namespace flemu
+{
+namespace detail
+{
+
+// z[i] = add(x[i], y[i]) for i in [0, n). if Flags is true, the kernels
+// return the exception flags of all the elements OR-ed together, otherwise 0.
+using add_kernel_type   = std::uint32_t (*)(const float32*, const float32*, float32*, std::size_t) noexcept;
+using add_kernel64_type = std::uint32_t (*)(const float64*, const float64*, float64*, std::size_t) noexcept;
+
+template<bool Flags = false, typename Float>
+std::uint32_t add_kernel_scalar(const Float* x, const Float* y, Float* z,
+                                const std::size_t n) noexcept
+{
+    std::uint32_t f = 0;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        if constexpr(Flags)
+        {
+            z[i] = add(x[i], y[i], rounding::nearest_even{}, flags::accumulate{f});
+        }
+        else
+        {
+            z[i] = add(x[i], y[i]);
+        }
+    }
+    return f;
+}
+
+#ifdef FLEMU_BATCH_ADDER_X86
+
+// The vector kernels compute the same thing as the scalar `add`, but without
+// any data-dependent branch. All the lanes go through the same sequence.
+//
+//  1. swap so that |x| <= |y| (compare the bit patterns without the sign)
+//  2. unpack mantissa with implicit bit and 3 additional bits (G, R, S)
+//  3. align x by the exponent difference (clamped to 31), OR-ing the bits
+//     shifted out into the sticky bit
+//  4. add or subtract
+//  5. normalize: shift right by 1 on carry-up, or shift left by the number of
+//     leading zeros, but never below the denormal boundary
+//  6. round to nearest-even: up = (GRS + lsb + 3) >> 3
+//  7. pack as ((exp-1) << 23) + (implicit|mantissa) + up. the implicit bit
+//     and the rounding carry propagate into the exponent, and a denormal
+//     result (no implicit bit, exp == 1) gets the exponent 0 automatically.
+//  8. clamp the magnitude to inf and override zero, nan and inf lanes.
+//
+// With Flags, the lanes fold their intermediate values into an accumulator,
+// and the flags are derived from it once at the end of the batch; the result
+// does not wait for them. per lane, it takes a couple of instructions.
+//   - GRS of the finite lanes are OR-ed (inexact if non-zero)
+//   - the max of the unclamped magnitudes of the finite lanes (overflow if >= inf)
+//   - inf - inf lanes are OR-ed (invalid)
+// A tiny sum is exact, so underflow is never raised.
+
+struct add_flags_avx2
+{
+    __m256i grs;
+    __m256i zmag;
+    __m256i invalid;
+};
+
+template<bool Flags>
+__attribute__((target("avx2")))
+inline __m256i add_lanes_avx2(const __m256i a, const __m256i b, add_flags_avx2& flags) noexcept
+{
+    const __m256i zero    = _mm256_setzero_si256();
+    const __m256i one     = _mm256_set1_epi32(1);
+    const __m256i sgnmask = _mm256_set1_epi32(static_cast<int>(0x8000'0000u));
+    const __m256i absmask = _mm256_set1_epi32(0x7FFF'FFFF);
+    const __m256i manmask = _mm256_set1_epi32(0x007F'FFFF);
+    const __m256i implicit= _mm256_set1_epi32(0x0080'0000);
+    const __m256i inf     = _mm256_set1_epi32(0x7F80'0000);
+    const __m256i nan     = _mm256_set1_epi32(0x7F80'0001);
+
+    // always make |x| <= |y|. magnitudes fit in 31 bits, so signed cmp is ok.
+    const __m256i swap = _mm256_cmpgt_epi32(_mm256_and_si256(a, absmask),
+                                            _mm256_and_si256(b, absmask));
+    const __m256i x  = _mm256_blendv_epi8(a, b, swap);
+    const __m256i y  = _mm256_blendv_epi8(b, a, swap);
+    const __m256i xm = _mm256_and_si256(x, absmask);
+    const __m256i ym = _mm256_and_si256(y, absmask);
+
+    const __m256i xexp = _mm256_srli_epi32(xm, 23);
+    const __m256i yexp = _mm256_srli_epi32(ym, 23);
+
+    const __m256i xman = _mm256_slli_epi32(_mm256_or_si256(_mm256_and_si256(xm, manmask),
+        _mm256_andnot_si256(_mm256_cmpeq_epi32(xexp, zero), implicit)), 3);
+    const __m256i yman = _mm256_slli_epi32(_mm256_or_si256(_mm256_and_si256(ym, manmask),
+        _mm256_andnot_si256(_mm256_cmpeq_epi32(yexp, zero), implicit)), 3);
+
+    // denormalized numbers have the same scale as exponent == 1
+    const __m256i xexp_norm = _mm256_max_epu32(xexp, one);
+    const __m256i yexp_norm = _mm256_max_epu32(yexp, one);
+
+    const __m256i expdiff = _mm256_min_epu32(_mm256_sub_epi32(yexp_norm, xexp_norm),
+                                             _mm256_set1_epi32(31));
+    const __m256i sticky_region = _mm256_and_si256(xman,
+        _mm256_sub_epi32(_mm256_sllv_epi32(one, expdiff), one));
+    const __m256i sticky = _mm256_andnot_si256(_mm256_cmpeq_epi32(sticky_region, zero), one);
+    const __m256i xman_aligned = _mm256_or_si256(_mm256_srlv_epi32(xman, expdiff), sticky);
+
+    // negate x if the signs are different (all-1 or all-0)
+    const __m256i sub = _mm256_srai_epi32(_mm256_xor_si256(x, y), 31);
+    __m256i zman = _mm256_add_epi32(yman,
+        _mm256_sub_epi32(_mm256_xor_si256(xman_aligned, sub), sub));
+    __m256i zexp = yexp_norm;
+
+    // carry-up by addition. keep the sticky bit while shifting.
+    const __m256i carry = _mm256_srli_epi32(zman, 27);
+    zman = _mm256_or_si256(_mm256_srlv_epi32(zman, carry), _mm256_and_si256(zman, carry));
+    zexp = _mm256_add_epi32(zexp, carry);
+
+    // position of the leading one. int -> float conversion is exact up to
+    // 24 bits; if it rounds up to the next power of two, step back by one.
+    __m256i msb = _mm256_sub_epi32(_mm256_srli_epi32(
+        _mm256_castps_si256(_mm256_cvtepi32_ps(zman)), 23), _mm256_set1_epi32(127));
+    msb = _mm256_add_epi32(msb, _mm256_cmpgt_epi32(_mm256_sllv_epi32(one, msb), zman));
+
+    // normalize, but stop at the denormal boundary.
+    const __m256i lz    = _mm256_sub_epi32(_mm256_set1_epi32(26), msb);
+    const __m256i shift = _mm256_min_epu32(lz, _mm256_sub_epi32(zexp, one));
+    zman = _mm256_sllv_epi32(zman, shift);
+    zexp = _mm256_sub_epi32(zexp, shift);
+
+    // nearest-even rounding
+    const __m256i grs = _mm256_and_si256(zman, _mm256_set1_epi32(0b111));
+    const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(zman, 3), one);
+    const __m256i up  = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(grs, lsb),
+                                          _mm256_set1_epi32(3)), 3);
+
+    const __m256i zmag_unclamped = _mm256_add_epi32(_mm256_add_epi32(
+        _mm256_slli_epi32(_mm256_sub_epi32(zexp, one), 23), _mm256_srli_epi32(zman, 3)), up);
+    const __m256i zmag = _mm256_min_epu32(zmag_unclamped, inf);
+
+    __m256i z = _mm256_or_si256(_mm256_and_si256(y, sgnmask), zmag);
+
+    // x + (-x) == +0, (-0) + (-0) == -0
+    z = _mm256_blendv_epi8(z, _mm256_and_si256(_mm256_and_si256(x, y), sgnmask),
+                           _mm256_cmpeq_epi32(zman, zero));
+
+    // nan or inf. since |x| <= |y|, y is inf or nan if any of them is.
+    const __m256i special = _mm256_cmpgt_epi32(ym, _mm256_set1_epi32(0x7F7F'FFFF));
+    const __m256i is_nan  = _mm256_or_si256(_mm256_cmpgt_epi32(ym, inf),
+        _mm256_andnot_si256(_mm256_cmpeq_epi32(x, y), _mm256_cmpeq_epi32(xm, ym)));
+    z = _mm256_blendv_epi8(z, _mm256_blendv_epi8(y, nan, is_nan), special);
+
+    if constexpr(Flags)
+    {
+        flags.grs     = _mm256_or_si256(flags.grs, _mm256_andnot_si256(special, grs));
+        flags.zmag    = _mm256_max_epu32(flags.zmag, _mm256_andnot_si256(special, zmag_unclamped));
+        flags.invalid = _mm256_or_si256(flags.invalid, _mm256_andnot_si256(
+            _mm256_cmpgt_epi32(ym, inf), _mm256_and_si256(special, is_nan)));
+    }
+    return z;
+}
+
+template<bool Flags = false>
+__attribute__((target("avx2")))
+inline std::uint32_t add_kernel_avx2(const float32* x, const float32* y, float32* z,
+                                     const std::size_t n) noexcept
+{
+    static_assert(sizeof(float32) == sizeof(std::uint32_t));
+
+    add_flags_avx2 flags{_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(z + i), add_lanes_avx2<Flags>(a, b, flags));
+    }
+    std::uint32_t f = add_kernel_scalar<Flags>(x + i, y + i, z + i, n - i);
+    if constexpr(Flags)
+    {
+        const __m256i inf      = _mm256_set1_epi32(0x7F80'0000);
+        const __m256i zero     = _mm256_setzero_si256();
+        const __m256i overflow = _mm256_cmpeq_epi32(_mm256_max_epu32(flags.zmag, inf), flags.zmag);
+        const __m256i inexact  = _mm256_or_si256(overflow,
+            _mm256_xor_si256(_mm256_cmpeq_epi32(flags.grs, zero), _mm256_set1_epi32(-1)));
+        f |= (_mm256_testz_si256(flags.invalid, flags.invalid) ? 0u : flag_invalid ) |
+             (_mm256_testz_si256(overflow, overflow)           ? 0u : flag_overflow) |
+             (_mm256_testz_si256(inexact, inexact)             ? 0u : flag_inexact );
+    }
+    return f;
+}
+
+// gcc warns that _mm512_undefined_epi32() in the intrinsics is uninitialized.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+
+struct add_flags_avx512
+{
+    __m512i   grs;
+    __m512i   zmag;
+    __mmask16 invalid;
+};
+
+template<bool Flags>
+__attribute__((target("avx512f,avx512cd")))
+inline __m512i add_lanes_avx512(const __m512i a, const __m512i b, add_flags_avx512& flags) noexcept
+{
+    const __m512i zero    = _mm512_setzero_si512();
+    const __m512i one     = _mm512_set1_epi32(1);
+    const __m512i sgnmask = _mm512_set1_epi32(static_cast<int>(0x8000'0000u));
+    const __m512i absmask = _mm512_set1_epi32(0x7FFF'FFFF);
+    const __m512i manmask = _mm512_set1_epi32(0x007F'FFFF);
+    const __m512i implicit= _mm512_set1_epi32(0x0080'0000);
+    const __m512i inf     = _mm512_set1_epi32(0x7F80'0000);
+    const __m512i nan     = _mm512_set1_epi32(0x7F80'0001);
+
+    const __mmask16 swap = _mm512_cmpgt_epu32_mask(_mm512_and_si512(a, absmask),
+                                                   _mm512_and_si512(b, absmask));
+    const __m512i x  = _mm512_mask_blend_epi32(swap, a, b);
+    const __m512i y  = _mm512_mask_blend_epi32(swap, b, a);
+    const __m512i xm = _mm512_and_si512(x, absmask);
+    const __m512i ym = _mm512_and_si512(y, absmask);
+
+    const __m512i xexp = _mm512_srli_epi32(xm, 23);
+    const __m512i yexp = _mm512_srli_epi32(ym, 23);
+
+    const __m512i xman = _mm512_slli_epi32(_mm512_mask_or_epi32(
+        _mm512_and_si512(xm, manmask), _mm512_test_epi32_mask(xexp, xexp),
+        _mm512_and_si512(xm, manmask), implicit), 3);
+    const __m512i yman = _mm512_slli_epi32(_mm512_mask_or_epi32(
+        _mm512_and_si512(ym, manmask), _mm512_test_epi32_mask(yexp, yexp),
+        _mm512_and_si512(ym, manmask), implicit), 3);
+
+    const __m512i xexp_norm = _mm512_max_epu32(xexp, one);
+    const __m512i yexp_norm = _mm512_max_epu32(yexp, one);
+
+    const __m512i expdiff = _mm512_min_epu32(_mm512_sub_epi32(yexp_norm, xexp_norm),
+                                             _mm512_set1_epi32(31));
+    const __mmask16 sticky = _mm512_test_epi32_mask(xman,
+        _mm512_sub_epi32(_mm512_sllv_epi32(one, expdiff), one));
+    const __m512i xman_aligned = _mm512_mask_or_epi32(_mm512_srlv_epi32(xman, expdiff),
+        sticky, _mm512_srlv_epi32(xman, expdiff), one);
+
+    const __mmask16 sub = _mm512_test_epi32_mask(_mm512_xor_si512(x, y), sgnmask);
+    __m512i zman = _mm512_mask_sub_epi32(_mm512_add_epi32(yman, xman_aligned),
+                                         sub, yman, xman_aligned);
+    __m512i zexp = yexp_norm;
+
+    const __m512i carry = _mm512_srli_epi32(zman, 27);
+    zman = _mm512_or_si512(_mm512_srlv_epi32(zman, carry), _mm512_and_si512(zman, carry));
+    zexp = _mm512_add_epi32(zexp, carry);
+
+    // lzcnt(0) == 32, it is overridden by the zero check below.
+    const __m512i lz    = _mm512_sub_epi32(_mm512_lzcnt_epi32(zman), _mm512_set1_epi32(5));
+    const __m512i shift = _mm512_min_epu32(lz, _mm512_sub_epi32(zexp, one));
+    zman = _mm512_sllv_epi32(zman, shift);
+    zexp = _mm512_sub_epi32(zexp, shift);
+
+    const __m512i grs = _mm512_and_si512(zman, _mm512_set1_epi32(0b111));
+    const __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(zman, 3), one);
+    const __m512i up  = _mm512_srli_epi32(_mm512_add_epi32(_mm512_add_epi32(grs, lsb),
+                                          _mm512_set1_epi32(3)), 3);
+
+    const __m512i zmag_unclamped = _mm512_add_epi32(_mm512_add_epi32(
+        _mm512_slli_epi32(_mm512_sub_epi32(zexp, one), 23), _mm512_srli_epi32(zman, 3)), up);
+    const __m512i zmag = _mm512_min_epu32(zmag_unclamped, inf);
+
+    __m512i z = _mm512_or_si512(_mm512_and_si512(y, sgnmask), zmag);
+
+    z = _mm512_mask_blend_epi32(_mm512_cmpeq_epi32_mask(zman, zero), z,
+            _mm512_and_si512(_mm512_and_si512(x, y), sgnmask));
+
+    const __mmask16 special = _mm512_cmpge_epu32_mask(ym, inf);
+    const __mmask16 is_nan  = _mm512_cmpgt_epu32_mask(ym, inf) |
+        (_mm512_cmpeq_epi32_mask(xm, ym) & _mm512_cmpneq_epi32_mask(x, y));
+    z = _mm512_mask_blend_epi32(special, z, _mm512_mask_blend_epi32(is_nan, y, nan));
+
+    if constexpr(Flags)
+    {
+        flags.grs      = _mm512_mask_or_epi32(flags.grs, ~special, flags.grs, grs);
+        flags.zmag     = _mm512_mask_max_epu32(flags.zmag, ~special, flags.zmag, zmag_unclamped);
+        flags.invalid |= is_nan & special & ~_mm512_cmpgt_epu32_mask(ym, inf);
+    }
+    return z;
+}
+
+template<bool Flags = false>
+__attribute__((target("avx512f,avx512cd")))
+inline std::uint32_t add_kernel_avx512(const float32* x, const float32* y, float32* z,
+                                       const std::size_t n) noexcept
+{
+    static_assert(sizeof(float32) == sizeof(std::uint32_t));
+
+    add_flags_avx512 flags{_mm512_setzero_si512(), _mm512_setzero_si512(), 0};
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+        const __m512i a = _mm512_loadu_si512(x + i);
+        const __m512i b = _mm512_loadu_si512(y + i);
+        _mm512_storeu_si512(z + i, add_lanes_avx512<Flags>(a, b, flags));
+    }
+    std::uint32_t f = add_kernel_scalar<Flags>(x + i, y + i, z + i, n - i);
+    if constexpr(Flags)
+    {
+        const bool overflow = _mm512_reduce_max_epu32(flags.zmag) >= 0x7F80'0000u;
+        const bool inexact  = _mm512_test_epi32_mask(flags.grs, flags.grs) != 0 || overflow;
+        f |= (flags.invalid != 0 ? flag_invalid  : 0u) | (overflow ? flag_overflow : 0u) |
+             (inexact          ? flag_inexact  : 0u);
+    }
+    return f;
+}
+
+// float64 in 8 lanes of 64 bits. the same steps as add_lanes_avx512 with the
+// implicit bit at 52 + 3 == 55 and the carry at 56; the 64-bit lanes have
+// room for them, so nothing is wider than in the 32-bit kernel. AVX2 has no
+// 64-bit lzcnt, unsigned compare or min/max, so there is no AVX2 version.
+template<bool Flags>
+__attribute__((target("avx512f,avx512cd")))
+inline __m512i add_lanes_f64_avx512(const __m512i a, const __m512i b, add_flags_avx512& flags) noexcept
+{
+    const __m512i zero    = _mm512_setzero_si512();
+    const __m512i one     = _mm512_set1_epi64(1);
+    const __m512i sgnmask = _mm512_set1_epi64(static_cast<long long>(0x8000'0000'0000'0000ull));
+    const __m512i absmask = _mm512_set1_epi64(0x7FFF'FFFF'FFFF'FFFFll);
+    const __m512i manmask = _mm512_set1_epi64(0x000F'FFFF'FFFF'FFFFll);
+    const __m512i implicit= _mm512_set1_epi64(0x0010'0000'0000'0000ll);
+    const __m512i inf     = _mm512_set1_epi64(0x7FF0'0000'0000'0000ll);
+    const __m512i nan     = _mm512_set1_epi64(0x7FF0'0000'0000'0001ll);
+
+    const __mmask8 swap = _mm512_cmpgt_epu64_mask(_mm512_and_si512(a, absmask),
+                                                  _mm512_and_si512(b, absmask));
+    const __m512i x  = _mm512_mask_blend_epi64(swap, a, b);
+    const __m512i y  = _mm512_mask_blend_epi64(swap, b, a);
+    const __m512i xm = _mm512_and_si512(x, absmask);
+    const __m512i ym = _mm512_and_si512(y, absmask);
+
+    const __m512i xexp = _mm512_srli_epi64(xm, 52);
+    const __m512i yexp = _mm512_srli_epi64(ym, 52);
+
+    const __m512i xman = _mm512_slli_epi64(_mm512_mask_or_epi64(
+        _mm512_and_si512(xm, manmask), _mm512_test_epi64_mask(xexp, xexp),
+        _mm512_and_si512(xm, manmask), implicit), 3);
+    const __m512i yman = _mm512_slli_epi64(_mm512_mask_or_epi64(
+        _mm512_and_si512(ym, manmask), _mm512_test_epi64_mask(yexp, yexp),
+        _mm512_and_si512(ym, manmask), implicit), 3);
+
+    const __m512i xexp_norm = _mm512_max_epu64(xexp, one);
+    const __m512i yexp_norm = _mm512_max_epu64(yexp, one);
+
+    const __m512i expdiff = _mm512_min_epu64(_mm512_sub_epi64(yexp_norm, xexp_norm),
+                                             _mm512_set1_epi64(63));
+    const __mmask8 sticky = _mm512_test_epi64_mask(xman,
+        _mm512_sub_epi64(_mm512_sllv_epi64(one, expdiff), one));
+    const __m512i xman_aligned = _mm512_mask_or_epi64(_mm512_srlv_epi64(xman, expdiff),
+        sticky, _mm512_srlv_epi64(xman, expdiff), one);
+
+    const __mmask8 sub = _mm512_test_epi64_mask(_mm512_xor_si512(x, y), sgnmask);
+    __m512i zman = _mm512_mask_sub_epi64(_mm512_add_epi64(yman, xman_aligned),
+                                         sub, yman, xman_aligned);
+    __m512i zexp = yexp_norm;
+
+    const __m512i carry = _mm512_srli_epi64(zman, 56);
+    zman = _mm512_or_si512(_mm512_srlv_epi64(zman, carry), _mm512_and_si512(zman, carry));
+    zexp = _mm512_add_epi64(zexp, carry);
+
+    // lzcnt(0) == 64, it is overridden by the zero check below.
+    const __m512i lz    = _mm512_sub_epi64(_mm512_lzcnt_epi64(zman), _mm512_set1_epi64(8));
+    const __m512i shift = _mm512_min_epu64(lz, _mm512_sub_epi64(zexp, one));
+    zman = _mm512_sllv_epi64(zman, shift);
+    zexp = _mm512_sub_epi64(zexp, shift);
+
+    const __m512i grs = _mm512_and_si512(zman, _mm512_set1_epi64(0b111));
+    const __m512i lsb = _mm512_and_si512(_mm512_srli_epi64(zman, 3), one);
+    const __m512i up  = _mm512_srli_epi64(_mm512_add_epi64(_mm512_add_epi64(grs, lsb),
+                                          _mm512_set1_epi64(3)), 3);
+
+    const __m512i zmag_unclamped = _mm512_add_epi64(_mm512_add_epi64(
+        _mm512_slli_epi64(_mm512_sub_epi64(zexp, one), 52), _mm512_srli_epi64(zman, 3)), up);
+    const __m512i zmag = _mm512_min_epu64(zmag_unclamped, inf);
+
+    __m512i z = _mm512_or_si512(_mm512_and_si512(y, sgnmask), zmag);
+
+    z = _mm512_mask_blend_epi64(_mm512_cmpeq_epi64_mask(zman, zero), z,
+            _mm512_and_si512(_mm512_and_si512(x, y), sgnmask));
+
+    const __mmask8 special = _mm512_cmpge_epu64_mask(ym, inf);
+    const __mmask8 is_nan  = _mm512_cmpgt_epu64_mask(ym, inf) |
+        (_mm512_cmpeq_epi64_mask(xm, ym) & _mm512_cmpneq_epi64_mask(x, y));
+    z = _mm512_mask_blend_epi64(special, z, _mm512_mask_blend_epi64(is_nan, y, nan));
+
+    if constexpr(Flags)
+    {
+        flags.grs      = _mm512_mask_or_epi64(flags.grs, ~special, flags.grs, grs);
+        flags.zmag     = _mm512_mask_max_epu64(flags.zmag, ~special, flags.zmag, zmag_unclamped);
+        flags.invalid |= is_nan & special & ~_mm512_cmpgt_epu64_mask(ym, inf);
+    }
+    return z;
+}
+
+template<bool Flags = false>
+__attribute__((target("avx512f,avx512cd")))
+inline std::uint32_t add_kernel_f64_avx512(const float64* x, const float64* y, float64* z,
+                                           const std::size_t n) noexcept
+{
+    static_assert(sizeof(float64) == sizeof(std::uint64_t));
+
+    add_flags_avx512 flags{_mm512_setzero_si512(), _mm512_setzero_si512(), 0};
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m512i a = _mm512_loadu_si512(x + i);
+        const __m512i b = _mm512_loadu_si512(y + i);
+        _mm512_storeu_si512(z + i, add_lanes_f64_avx512<Flags>(a, b, flags));
+    }
+    std::uint32_t f = add_kernel_scalar<Flags>(x + i, y + i, z + i, n - i);
+    if constexpr(Flags)
+    {
+        const bool overflow = _mm512_reduce_max_epu64(flags.zmag) >= 0x7FF0'0000'0000'0000ull;
+        const bool inexact  = _mm512_test_epi64_mask(flags.grs, flags.grs) != 0 || overflow;
+        f |= (flags.invalid != 0 ? flag_invalid  : 0u) | (overflow ? flag_overflow : 0u) |
+             (inexact          ? flag_inexact  : 0u);
+    }
+    return f;
+}
+
+#pragma GCC diagnostic pop
+
+#endif // FLEMU_BATCH_ADDER_X86
+
+template<bool Flags = false>
+add_kernel64_type select_add_kernel64() noexcept
+{
+#ifdef FLEMU_BATCH_ADDER_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd"))
+    {
+        return &add_kernel_f64_avx512<Flags>;
+    }
+#endif
+    return &add_kernel_scalar<Flags>;
+}
+
+template<bool Flags = false>
+add_kernel_type select_add_kernel() noexcept
+{
+#ifdef FLEMU_BATCH_ADDER_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd"))
+    {
+        return &add_kernel_avx512<Flags>;
+    }
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return &add_kernel_avx2<Flags>;
+    }
+#endif
+    return &add_kernel_scalar<Flags>;
+}
+
+} // detail
+
+// z[i] = add(x[i], y[i], rnd.for_element(i)) for any format and rounding
+// mode. the rounding mode is resolved at compile time, so the loop body is the
+// branch-free scalar add specialized to it. the flags of the elements are
+// OR-ed in a local word and reported to flg once per batch.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags>
+constexpr void add(std::span<const basic_float<E, M, B, S>> x, std::span<const basic_float<E, M, B, S>> y,
+         std::span<basic_float<E, M, B, S>> z, const Rounding& rnd, const Flags& flg) noexcept
+{
+    assert(x.size() == z.size() && y.size() == z.size());
+    if constexpr(Flags::enabled)
+    {
+        std::uint32_t f = 0;
+        for(std::size_t i=0; i<z.size(); ++i)
+        {
+            z[i] = add(x[i], y[i], rnd.for_element(i), flags::accumulate{f});
+        }
+        flg.raise(f);
+    }
+    else
+    {
+        for(std::size_t i=0; i<z.size(); ++i)
+        {
+            z[i] = add(x[i], y[i], rnd.for_element(i));
+        }
+    }
+}
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S, rounding_policy Rounding>
+constexpr void add(std::span<const basic_float<E, M, B, S>> x, std::span<const basic_float<E, M, B, S>> y,
+         std::span<basic_float<E, M, B, S>> z, const Rounding& rnd) noexcept
+{
+    add(x, y, z, rnd, flags::ignore{});
+}
+
+// z[i] = add(x[i], y[i]) for any format. it runs the scalar add for each
+// element; float32 and float64 have vectorized overloads below.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr void add(std::span<const basic_float<E, M, B, S>> x, std::span<const basic_float<E, M, B, S>> y,
+         std::span<basic_float<E, M, B, S>> z) noexcept
+{
+    add(x, y, z, rounding::nearest_even{});
+}
+
+// z[i] = add(x[i], y[i]). Results are bit-identical to the scalar `add`.
+// The widest instruction set supported by the CPU is selected at the first call.
+inline void add(std::span<const float32> x, std::span<const float32> y,
+                std::span<float32> z) noexcept
+{
+    assert(x.size() == z.size() && y.size() == z.size());
+
+#ifdef FLEMU_ENABLE_RECORDER
+    // the kernels do not record; the scalar add does, element by element.
+    if(recorder::running())
+    {
+        add<8, 23, 127, std::uint32_t>(x, y, z, rounding::nearest_even{}, flags::ignore{});
+        return;
+    }
+#endif
+    static const detail::add_kernel_type kernel = detail::select_add_kernel();
+    kernel(x.data(), y.data(), z.data(), z.size());
+}
+
+// float32 with a rounding mode and flags. nearest-(even) goes to the
+// vectorized kernels, which OR-reduce the flags of the lanes.
+template<rounding_policy Rounding, flag_policy Flags>
+void add(std::span<const float32> x, std::span<const float32> y,
+         std::span<float32> z, const Rounding& rnd, const Flags& flg) noexcept
+{
+    if constexpr(std::is_same_v<Rounding, rounding::nearest_even> && Flags::enabled)
+    {
+        assert(x.size() == z.size() && y.size() == z.size());
+
+#ifdef FLEMU_ENABLE_RECORDER
+        if(recorder::running())
+        {
+            add<8, 23, 127, std::uint32_t>(x, y, z, rnd, flg);
+            return;
+        }
+#endif
+        static const detail::add_kernel_type kernel = detail::select_add_kernel<true>();
+        flg.raise(kernel(x.data(), y.data(), z.data(), z.size()));
+    }
+    else if constexpr(std::is_same_v<Rounding, rounding::nearest_even>)
+    {
+        add(x, y, z);
+    }
+    else
+    {
+        add<8, 23, 127, std::uint32_t>(x, y, z, rnd, flg);
+    }
+}
+
+template<rounding_policy Rounding>
+void add(std::span<const float32> x, std::span<const float32> y,
+         std::span<float32> z, const Rounding& rnd) noexcept
+{
+    add(x, y, z, rnd, flags::ignore{});
+}
+
+// z[i] = add(x[i], y[i]) for float64, on 8 lanes with AVX-512 and with the
+// scalar add otherwise. Results are bit-identical to the scalar `add`.
+inline void add(std::span<const float64> x, std::span<const float64> y,
+                std::span<float64> z) noexcept
+{
+    assert(x.size() == z.size() && y.size() == z.size());
+
+    static const detail::add_kernel64_type kernel = detail::select_add_kernel64();
+    kernel(x.data(), y.data(), z.data(), z.size());
+}
+
+template<rounding_policy Rounding, flag_policy Flags>
+void add(std::span<const float64> x, std::span<const float64> y,
+         std::span<float64> z, const Rounding& rnd, const Flags& flg) noexcept
+{
+    if constexpr(std::is_same_v<Rounding, rounding::nearest_even> && Flags::enabled)
+    {
+        assert(x.size() == z.size() && y.size() == z.size());
+
+        static const detail::add_kernel64_type kernel = detail::select_add_kernel64<true>();
+        flg.raise(kernel(x.data(), y.data(), z.data(), z.size()));
+    }
+    else if constexpr(std::is_same_v<Rounding, rounding::nearest_even>)
+    {
+        add(x, y, z);
+    }
+    else
+    {
+        add<11, 52, 1023, std::uint64_t>(x, y, z, rnd, flg);
+    }
+}
+
+template<rounding_policy Rounding>
+void add(std::span<const float64> x, std::span<const float64> y,
+         std::span<float64> z, const Rounding& rnd) noexcept
+{
+    add(x, y, z, rnd, flags::ignore{});
+}
+
+// z[i] = add(x[i], y[i], rnd.for_element(i), flg, assume) for any format; see
+// assumptions.hpp. with DAZ or FTZ, it runs the scalar add specialized to
+// them for each element. `finite` alone does not change the results, so it
+// goes to the overloads above (and the vectorized kernels of float32 and
+// float64), after checking the operands in a build without NDEBUG.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags, assumption_policy Assume>
+constexpr void add(std::span<const basic_float<E, M, B, S>> x, std::span<const basic_float<E, M, B, S>> y,
+         std::span<basic_float<E, M, B, S>> z, const Rounding& rnd, const Flags& flg,
+         const Assume& assume) noexcept
+{
+    assert(x.size() == z.size() && y.size() == z.size());
+    if constexpr(!Assume::denormals_are_zero && !Assume::flush_to_zero)
+    {
+        if(!std::is_constant_evaluated())
+        {
+#ifndef NDEBUG
+            for(std::size_t i=0; i<z.size(); ++i)
+            {
+                assert(satisfies<Assume>(x[i]) && satisfies<Assume>(y[i])); // the assumption holds?
+            }
+#endif
+            add(x, y, z, rnd, flg);
+            return;
+        }
+    }
+    if constexpr(Flags::enabled)
+    {
+        std::uint32_t f = 0;
+        for(std::size_t i=0; i<z.size(); ++i)
+        {
+            z[i] = add(x[i], y[i], rnd.for_element(i), flags::accumulate{f}, assume);
+        }
+        flg.raise(f);
+    }
+    else
+    {
+        for(std::size_t i=0; i<z.size(); ++i)
+        {
+            z[i] = add(x[i], y[i], rnd.for_element(i), flg, assume);
+        }
+    }
+}
+
+} // flemu
+#endif // FLEMU_BATCH_ADDER_HPP
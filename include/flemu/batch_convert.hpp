@@ -0,0 +1,590 @@
+#ifndef FLEMU_BATCH_CONVERT_HPP
+#define FLEMU_BATCH_CONVERT_HPP
+
+#include "float32.hpp"
+#include "convert.hpp"
+#include "flags.hpp"
+#include "rounding.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include <span>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define FLEMU_BATCH_CONVERT_X86 1
+#  include <immintrin.h>
+#endif
+
+namespace flemu
+{
+namespace detail
+{
+
+// the formats that the kernels convert from and to float32. the range of the
+// format is in that of float32, and its denormals are either normal in
+// float32 or have the same scale as in float32 (bfloat16, tfloat32).
+template<typename Float>
+inline constexpr bool is_vector_format = false;
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+inline constexpr bool is_vector_format<basic_float<E, M, B, S>> =
+    E <= 8 && M < 23 && sizeof(S) <= 4 && B <= 127 && (std::size_t(1) << E) - 2 <= B + 127 &&
+    (B == 127 || B + M <= 127);
+
+// the rounding modes that the kernels implement. the stochastic one runs the
+// scalar convert for each element.
+template<typename Rounding>
+inline constexpr bool is_vector_rounding =
+    std::is_same_v<Rounding, rounding::nearest_even>    || std::is_same_v<Rounding, rounding::toward_zero> ||
+    std::is_same_v<Rounding, rounding::toward_positive> || std::is_same_v<Rounding, rounding::toward_negative>;
+
+template<typename Rounding>
+inline constexpr bool is_vector_rounding<rounding::saturating<Rounding>> = is_vector_rounding<Rounding>;
+
+// float32 -> narrower format with a vector rounding mode, or the other way.
+// a conversion to float32 is exact, so it does not depend on the mode.
+template<typename From, typename To, typename Rounding>
+inline constexpr bool is_vector_conversion =
+    (std::is_same_v<From, float32> && is_vector_format<To> && is_vector_rounding<Rounding>) ||
+    (is_vector_format<From> && std::is_same_v<To, float32>);
+
+// the rounding of a mode without saturating<>.
+template<typename Rounding>
+struct unsaturated {using type = Rounding;};
+
+template<typename Rounding>
+struct unsaturated<rounding::saturating<Rounding>> {using type = Rounding;};
+
+// z[i] = convert<To>(x[i]) for i in [0, n). if Flags is true, the kernels
+// return the exception flags of all the elements OR-ed together, otherwise 0.
+template<typename From, typename To>
+using convert_kernel_type = std::uint32_t (*)(const From*, To*, std::size_t) noexcept;
+
+template<typename To, typename Rounding, bool Flags, typename From>
+constexpr std::uint32_t convert_kernel_scalar(const From* x, To* z, const std::size_t n) noexcept
+{
+    std::uint32_t f = 0;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        if constexpr(Flags)
+        {
+            z[i] = convert<To>(x[i], Rounding{}, flags::accumulate{f});
+        }
+        else
+        {
+            z[i] = convert<To>(x[i], Rounding{});
+        }
+    }
+    return f;
+}
+
+#ifdef FLEMU_BATCH_CONVERT_X86
+
+// The narrowing kernels compute the same thing as the scalar `convert`,
+// without any data-dependent branch. float32 x is 1.m * 2^e, and in To,
+//
+//  1. the biased exponent is zexp = max(exp, 1) - (127 - bias of To). the
+//     significand with the implicit 1 is shifted right by 23 - M, and by
+//     1 - zexp more if zexp <= 0, to make a denormal. from 25 on, all the
+//     bits are below the last bit.
+//  2. the bits shifted out (`rest`) decide the rounding. nearest-even rounds
+//     up iff rest + lsb > half.
+//  3. pack as ((max(zexp, 1) - 1) << M) + significand + up, as add does. the
+//     implicit 1 and the rounding carry propagate into the exponent.
+//  4. clamp the magnitude to inf or the max finite, and override inf and nan.
+//
+// With Flags, the lanes fold the rest, the unclamped magnitude and the tiny
+// inexact lanes into an accumulator, and the flags are derived at the end.
+//
+// The widening kernels are exact. A denormal of To that is normal in float32
+// is converted to float as an integer (exact below 2^24) and scaled by
+// moving its exponent.
+
+struct narrow_flags_avx2
+{
+    __m256i rest;
+    __m256i zmag;
+    __m256i underflow;
+};
+
+template<typename From>
+__attribute__((target("avx2")))
+inline __m256i load_lanes_avx2(const From* p) noexcept
+{
+    if constexpr(sizeof(From) == 4)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    else if constexpr(sizeof(From) == 2)
+    {
+        return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+    else
+    {
+        return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    }
+}
+
+// the lanes are < 2^16 (or 2^8), so the saturating packs keep them.
+template<typename To>
+__attribute__((target("avx2")))
+inline void store_lanes_avx2(To* p, const __m256i v) noexcept
+{
+    if constexpr(sizeof(To) == 4)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    else
+    {
+        const __m128i v16 = _mm256_castsi256_si128(
+            _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0b1000));
+        if constexpr(sizeof(To) == 2)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v16);
+        }
+        else
+        {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(v16, v16));
+        }
+    }
+}
+
+// 1 if the mode rounds the magnitude up, for the significand q and the bits
+// shifted out of it.
+template<typename Rounding>
+__attribute__((target("avx2")))
+inline __m256i round_up_avx2(const __m256i sgn, const __m256i q, const __m256i rest,
+                             const __m256i shift) noexcept
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i inexact = _mm256_andnot_si256(_mm256_cmpeq_epi32(rest, _mm256_setzero_si256()), one);
+    if constexpr(std::is_same_v<Rounding, rounding::nearest_even>)
+    {
+        const __m256i half = _mm256_sllv_epi32(one, _mm256_sub_epi32(shift, one));
+        return _mm256_and_si256(_mm256_cmpgt_epi32(
+            _mm256_add_epi32(rest, _mm256_and_si256(q, one)), half), one);
+    }
+    else if constexpr(std::is_same_v<Rounding, rounding::toward_positive>)
+    {
+        return _mm256_andnot_si256(sgn, inexact);
+    }
+    else if constexpr(std::is_same_v<Rounding, rounding::toward_negative>)
+    {
+        return _mm256_and_si256(sgn, inexact);
+    }
+    else
+    {
+        return _mm256_setzero_si256();
+    }
+}
+
+template<typename To, typename Rounding, bool Flags>
+__attribute__((target("avx2")))
+inline __m256i narrow_lanes_avx2(const __m256i a, narrow_flags_avx2& flags) noexcept
+{
+    constexpr int           M      = int(To::mantissa_bits);
+    constexpr int           rebias = 127 - int(To::exponent_bias);
+    constexpr std::uint32_t inf    = std::uint32_t(To::exponent_max) << M;
+    constexpr std::uint32_t max0   = Rounding::overflow_to_max(0u);
+    constexpr std::uint32_t max1   = Rounding::overflow_to_max(1u);
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one  = _mm256_set1_epi32(1);
+    const __m256i mag  = _mm256_and_si256(a, _mm256_set1_epi32(0x7FFF'FFFF));
+    const __m256i sgn  = _mm256_srli_epi32(a, 31);
+    const __m256i exp  = _mm256_srli_epi32(mag, 23);
+    const __m256i sig  = _mm256_or_si256(_mm256_and_si256(mag, _mm256_set1_epi32(0x007F'FFFF)),
+        _mm256_andnot_si256(_mm256_cmpeq_epi32(exp, zero), _mm256_set1_epi32(0x0080'0000)));
+
+    const __m256i zexp  = _mm256_sub_epi32(_mm256_max_epi32(exp, one), _mm256_set1_epi32(rebias));
+    const __m256i shift = _mm256_min_epi32(_mm256_add_epi32(_mm256_set1_epi32(23 - M),
+        _mm256_max_epi32(_mm256_sub_epi32(one, zexp), zero)), _mm256_set1_epi32(25));
+    const __m256i q     = _mm256_srlv_epi32(sig, shift);
+    const __m256i rest  = _mm256_and_si256(sig, _mm256_sub_epi32(_mm256_sllv_epi32(one, shift), one));
+    const __m256i up    = round_up_avx2<typename unsaturated<Rounding>::type>(sgn, q, rest, shift);
+
+    const __m256i zmag_unclamped = _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(
+        _mm256_max_epi32(_mm256_sub_epi32(zexp, one), zero), M), q), up);
+
+    // an overflow becomes inf, or the max finite if the mode does so for the sign
+    const __m256i to_max = (max0 == max1) ? _mm256_set1_epi32(int(max0)) :
+                           (max1 != 0)    ? sgn : _mm256_xor_si256(sgn, one);
+    const __m256i zmag   = _mm256_min_epu32(zmag_unclamped,
+                                            _mm256_sub_epi32(_mm256_set1_epi32(int(inf)), to_max));
+    const __m256i zsgn   = _mm256_slli_epi32(sgn, int(To::sign_bit));
+    __m256i z = _mm256_or_si256(zsgn, zmag);
+
+    // inf keeps the sign, nan becomes the nan of To
+    const __m256i special = _mm256_cmpgt_epi32(mag, _mm256_set1_epi32(0x7F7F'FFFF));
+    const __m256i is_nan  = _mm256_cmpgt_epi32(mag, _mm256_set1_epi32(0x7F80'0000));
+    z = _mm256_blendv_epi8(z, _mm256_blendv_epi8(_mm256_or_si256(zsgn, _mm256_set1_epi32(int(inf))),
+                                                 _mm256_set1_epi32(int(inf | 1u)), is_nan), special);
+
+    if constexpr(Flags)
+    {
+        const __m256i tiny = _mm256_cmpgt_epi32(_mm256_set1_epi32(1 << M), q);
+        flags.rest      = _mm256_or_si256(flags.rest, _mm256_andnot_si256(special, rest));
+        flags.zmag      = _mm256_max_epu32(flags.zmag, _mm256_andnot_si256(special, zmag_unclamped));
+        flags.underflow = _mm256_or_si256(flags.underflow, _mm256_andnot_si256(special,
+            _mm256_andnot_si256(_mm256_cmpeq_epi32(rest, zero), tiny)));
+    }
+    return z;
+}
+
+template<typename To, typename Rounding, bool Flags = false>
+__attribute__((target("avx2")))
+inline std::uint32_t narrow_kernel_avx2(const float32* x, To* z, const std::size_t n) noexcept
+{
+    static_assert(sizeof(To) == sizeof(typename To::base_type));
+
+    narrow_flags_avx2 flags{_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        store_lanes_avx2(z + i, narrow_lanes_avx2<To, Rounding, Flags>(load_lanes_avx2(x + i), flags));
+    }
+    std::uint32_t f = convert_kernel_scalar<To, Rounding, Flags>(x + i, z + i, n - i);
+    if constexpr(Flags)
+    {
+        const __m256i inf      = _mm256_set1_epi32(int(std::uint32_t(To::exponent_max) << To::mantissa_bits));
+        const __m256i overflow = _mm256_cmpeq_epi32(_mm256_max_epu32(flags.zmag, inf), flags.zmag);
+        const __m256i inexact  = _mm256_or_si256(overflow, _mm256_xor_si256(
+            _mm256_cmpeq_epi32(flags.rest, _mm256_setzero_si256()), _mm256_set1_epi32(-1)));
+        f |= (_mm256_testz_si256(overflow, overflow)               ? 0u : flag_overflow ) |
+             (_mm256_testz_si256(flags.underflow, flags.underflow) ? 0u : flag_underflow) |
+             (_mm256_testz_si256(inexact, inexact)                 ? 0u : flag_inexact  );
+    }
+    return f;
+}
+
+template<typename From>
+__attribute__((target("avx2")))
+inline __m256i widen_lanes_avx2(const __m256i a) noexcept
+{
+    constexpr int M      = int(From::mantissa_bits);
+    constexpr int rebias = 127 - int(From::exponent_bias);
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i exp  = _mm256_and_si256(_mm256_srli_epi32(a, M), _mm256_set1_epi32(int(From::exponent_max)));
+    const __m256i man  = _mm256_and_si256(a, _mm256_set1_epi32((1 << M) - 1));
+    const __m256i sgn  = _mm256_slli_epi32(_mm256_srli_epi32(a, int(From::sign_bit)), 31);
+
+    const __m256i normal = _mm256_or_si256(_mm256_slli_epi32(
+        _mm256_add_epi32(exp, _mm256_set1_epi32(rebias)), 23), _mm256_slli_epi32(man, 23 - M));
+    __m256i denormal;
+    if constexpr(From::exponent_bias == 127)
+    {
+        denormal = _mm256_slli_epi32(man, 23 - M);
+    }
+    else
+    {
+        constexpr int scale = int(From::exponent_bias) + M - 1;
+        denormal = _mm256_andnot_si256(_mm256_cmpeq_epi32(man, zero), _mm256_sub_epi32(
+            _mm256_castps_si256(_mm256_cvtepi32_ps(man)), _mm256_set1_epi32(scale << 23)));
+    }
+    __m256i z = _mm256_or_si256(sgn, _mm256_blendv_epi8(normal, denormal, _mm256_cmpeq_epi32(exp, zero)));
+
+    // inf keeps the sign, nan becomes the nan of float32
+    const __m256i special = _mm256_cmpeq_epi32(exp, _mm256_set1_epi32(int(From::exponent_max)));
+    const __m256i is_inf  = _mm256_cmpeq_epi32(man, zero);
+    z = _mm256_blendv_epi8(z, _mm256_blendv_epi8(_mm256_set1_epi32(0x7F80'0001),
+            _mm256_or_si256(sgn, _mm256_set1_epi32(0x7F80'0000)), is_inf), special);
+    return z;
+}
+
+template<typename From>
+__attribute__((target("avx2")))
+inline std::uint32_t widen_kernel_avx2(const From* x, float32* z, const std::size_t n) noexcept
+{
+    static_assert(sizeof(From) == sizeof(typename From::base_type));
+
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        store_lanes_avx2(z + i, widen_lanes_avx2<From>(load_lanes_avx2(x + i)));
+    }
+    convert_kernel_scalar<float32, rounding::nearest_even, false>(x + i, z + i, n - i);
+    return 0;
+}
+
+// gcc warns that _mm512_undefined_epi32() in the intrinsics is uninitialized.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+
+struct narrow_flags_avx512
+{
+    __m512i   rest;
+    __m512i   zmag;
+    __mmask16 underflow;
+};
+
+template<typename From>
+__attribute__((target("avx512f")))
+inline __m512i load_lanes_avx512(const From* p) noexcept
+{
+    if constexpr(sizeof(From) == 4)
+    {
+        return _mm512_loadu_si512(p);
+    }
+    else if constexpr(sizeof(From) == 2)
+    {
+        return _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    }
+    else
+    {
+        return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+}
+
+template<typename To>
+__attribute__((target("avx512f")))
+inline void store_lanes_avx512(To* p, const __m512i v) noexcept
+{
+    if constexpr(sizeof(To) == 4)
+    {
+        _mm512_storeu_si512(p, v);
+    }
+    else if constexpr(sizeof(To) == 2)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtepi32_epi16(v));
+    }
+    else
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtepi32_epi8(v));
+    }
+}
+
+template<typename Rounding>
+__attribute__((target("avx512f")))
+inline __mmask16 round_up_avx512(const __mmask16 sgn, const __m512i q, const __m512i rest,
+                                 const __m512i shift) noexcept
+{
+    const __mmask16 inexact = _mm512_test_epi32_mask(rest, rest);
+    if constexpr(std::is_same_v<Rounding, rounding::nearest_even>)
+    {
+        const __m512i one  = _mm512_set1_epi32(1);
+        const __m512i half = _mm512_sllv_epi32(one, _mm512_sub_epi32(shift, one));
+        return _mm512_cmpgt_epu32_mask(_mm512_add_epi32(rest, _mm512_and_si512(q, one)), half);
+    }
+    else if constexpr(std::is_same_v<Rounding, rounding::toward_positive>)
+    {
+        return inexact & ~sgn;
+    }
+    else if constexpr(std::is_same_v<Rounding, rounding::toward_negative>)
+    {
+        return inexact & sgn;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+template<typename To, typename Rounding, bool Flags>
+__attribute__((target("avx512f")))
+inline __m512i narrow_lanes_avx512(const __m512i a, narrow_flags_avx512& flags) noexcept
+{
+    constexpr int           M      = int(To::mantissa_bits);
+    constexpr int           rebias = 127 - int(To::exponent_bias);
+    constexpr std::uint32_t inf    = std::uint32_t(To::exponent_max) << M;
+    constexpr std::uint32_t max0   = Rounding::overflow_to_max(0u);
+    constexpr std::uint32_t max1   = Rounding::overflow_to_max(1u);
+
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one  = _mm512_set1_epi32(1);
+    const __m512i mag  = _mm512_and_si512(a, _mm512_set1_epi32(0x7FFF'FFFF));
+    const __mmask16 sgn = _mm512_cmplt_epi32_mask(a, zero);
+    const __m512i exp  = _mm512_srli_epi32(mag, 23);
+    const __m512i sig  = _mm512_mask_or_epi32(_mm512_and_si512(mag, _mm512_set1_epi32(0x007F'FFFF)),
+        _mm512_test_epi32_mask(exp, exp), _mm512_and_si512(mag, _mm512_set1_epi32(0x007F'FFFF)),
+        _mm512_set1_epi32(0x0080'0000));
+
+    const __m512i zexp  = _mm512_sub_epi32(_mm512_max_epi32(exp, one), _mm512_set1_epi32(rebias));
+    const __m512i shift = _mm512_min_epi32(_mm512_add_epi32(_mm512_set1_epi32(23 - M),
+        _mm512_max_epi32(_mm512_sub_epi32(one, zexp), zero)), _mm512_set1_epi32(25));
+    const __m512i q     = _mm512_srlv_epi32(sig, shift);
+    const __m512i rest  = _mm512_and_si512(sig, _mm512_sub_epi32(_mm512_sllv_epi32(one, shift), one));
+    const __mmask16 up  = round_up_avx512<typename unsaturated<Rounding>::type>(sgn, q, rest, shift);
+
+    const __m512i packed = _mm512_add_epi32(_mm512_slli_epi32(
+        _mm512_max_epi32(_mm512_sub_epi32(zexp, one), zero), M), q);
+    const __m512i zmag_unclamped = _mm512_mask_add_epi32(packed, up, packed, one);
+
+    // an overflow becomes inf, or the max finite if the mode does so for the sign
+    const __mmask16 to_max = (max0 == max1) ? __mmask16(max0 != 0 ? 0xFFFF : 0) :
+                             (max1 != 0)    ? sgn : __mmask16(~sgn);
+    const __m512i zmag = _mm512_min_epu32(zmag_unclamped,
+        _mm512_mask_sub_epi32(_mm512_set1_epi32(int(inf)), to_max, _mm512_set1_epi32(int(inf)), one));
+    const __m512i zsgn = _mm512_maskz_mov_epi32(sgn, _mm512_set1_epi32(int(1u << To::sign_bit)));
+    __m512i z = _mm512_or_si512(zsgn, zmag);
+
+    const __mmask16 special = _mm512_cmpgt_epu32_mask(mag, _mm512_set1_epi32(0x7F7F'FFFF));
+    const __mmask16 is_nan  = _mm512_cmpgt_epu32_mask(mag, _mm512_set1_epi32(0x7F80'0000));
+    z = _mm512_mask_blend_epi32(special, z, _mm512_mask_blend_epi32(is_nan,
+            _mm512_or_si512(zsgn, _mm512_set1_epi32(int(inf))), _mm512_set1_epi32(int(inf | 1u))));
+
+    if constexpr(Flags)
+    {
+        const __mmask16 tiny = _mm512_cmplt_epu32_mask(q, _mm512_set1_epi32(1 << M));
+        flags.rest       = _mm512_mask_or_epi32(flags.rest, ~special, flags.rest, rest);
+        flags.zmag       = _mm512_mask_max_epu32(flags.zmag, ~special, flags.zmag, zmag_unclamped);
+        flags.underflow |= tiny & _mm512_test_epi32_mask(rest, rest) & ~special;
+    }
+    return z;
+}
+
+template<typename To, typename Rounding, bool Flags = false>
+__attribute__((target("avx512f")))
+inline std::uint32_t narrow_kernel_avx512(const float32* x, To* z, const std::size_t n) noexcept
+{
+    static_assert(sizeof(To) == sizeof(typename To::base_type));
+
+    narrow_flags_avx512 flags{_mm512_setzero_si512(), _mm512_setzero_si512(), 0};
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+        store_lanes_avx512(z + i, narrow_lanes_avx512<To, Rounding, Flags>(load_lanes_avx512(x + i), flags));
+    }
+    std::uint32_t f = convert_kernel_scalar<To, Rounding, Flags>(x + i, z + i, n - i);
+    if constexpr(Flags)
+    {
+        const bool overflow = _mm512_reduce_max_epu32(flags.zmag) >=
+                              (std::uint32_t(To::exponent_max) << To::mantissa_bits);
+        const bool inexact  = _mm512_test_epi32_mask(flags.rest, flags.rest) != 0 || overflow;
+        f |= (overflow ? flag_overflow : 0u) | (flags.underflow != 0 ? flag_underflow : 0u) |
+             (inexact  ? flag_inexact  : 0u);
+    }
+    return f;
+}
+
+template<typename From>
+__attribute__((target("avx512f")))
+inline __m512i widen_lanes_avx512(const __m512i a) noexcept
+{
+    constexpr int M      = int(From::mantissa_bits);
+    constexpr int rebias = 127 - int(From::exponent_bias);
+
+    const __m512i exp = _mm512_and_si512(_mm512_srli_epi32(a, M), _mm512_set1_epi32(int(From::exponent_max)));
+    const __m512i man = _mm512_and_si512(a, _mm512_set1_epi32((1 << M) - 1));
+    const __m512i sgn = _mm512_slli_epi32(_mm512_srli_epi32(a, int(From::sign_bit)), 31);
+
+    const __m512i normal = _mm512_or_si512(_mm512_slli_epi32(
+        _mm512_add_epi32(exp, _mm512_set1_epi32(rebias)), 23), _mm512_slli_epi32(man, 23 - M));
+    __m512i denormal;
+    if constexpr(From::exponent_bias == 127)
+    {
+        denormal = _mm512_slli_epi32(man, 23 - M);
+    }
+    else
+    {
+        constexpr int scale = int(From::exponent_bias) + M - 1;
+        denormal = _mm512_maskz_sub_epi32(_mm512_test_epi32_mask(man, man),
+            _mm512_castps_si512(_mm512_cvtepi32_ps(man)), _mm512_set1_epi32(scale << 23));
+    }
+    __m512i z = _mm512_or_si512(sgn, _mm512_mask_blend_epi32(_mm512_test_epi32_mask(exp, exp), denormal, normal));
+
+    const __mmask16 special = _mm512_cmpeq_epi32_mask(exp, _mm512_set1_epi32(int(From::exponent_max)));
+    const __mmask16 is_nan  = _mm512_test_epi32_mask(man, man);
+    z = _mm512_mask_blend_epi32(special, z, _mm512_mask_blend_epi32(is_nan,
+            _mm512_or_si512(sgn, _mm512_set1_epi32(0x7F80'0000)), _mm512_set1_epi32(0x7F80'0001)));
+    return z;
+}
+
+template<typename From>
+__attribute__((target("avx512f")))
+inline std::uint32_t widen_kernel_avx512(const From* x, float32* z, const std::size_t n) noexcept
+{
+    static_assert(sizeof(From) == sizeof(typename From::base_type));
+
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+        store_lanes_avx512(z + i, widen_lanes_avx512<From>(load_lanes_avx512(x + i)));
+    }
+    convert_kernel_scalar<float32, rounding::nearest_even, false>(x + i, z + i, n - i);
+    return 0;
+}
+
+#pragma GCC diagnostic pop
+
+#endif // FLEMU_BATCH_CONVERT_X86
+
+template<typename From, typename To, typename Rounding, bool Flags = false>
+convert_kernel_type<From, To> select_convert_kernel() noexcept
+{
+    static_assert(is_vector_conversion<From, To, Rounding>);
+    constexpr bool narrowing = std::is_same_v<From, float32>;
+#ifdef FLEMU_BATCH_CONVERT_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+    {
+        if constexpr(narrowing) {return &narrow_kernel_avx512<To, Rounding, Flags>;}
+        else                    {return &widen_kernel_avx512<From>;}
+    }
+    if(__builtin_cpu_supports("avx2"))
+    {
+        if constexpr(narrowing) {return &narrow_kernel_avx2<To, Rounding, Flags>;}
+        else                    {return &widen_kernel_avx2<From>;}
+    }
+#endif
+    return &convert_kernel_scalar<To, Rounding, Flags, From>;
+}
+
+// the kernel is selected at the first call.
+template<typename From, typename To, typename Rounding, bool Flags>
+convert_kernel_type<From, To> convert_kernel() noexcept
+{
+    static const convert_kernel_type<From, To> kernel = select_convert_kernel<From, To, Rounding, Flags>();
+    return kernel;
+}
+
+} // detail
+
+// z[i] = convert<To>(x[i], rnd) from float32 to a narrower format, or the
+// other way. Results and flags are bit-identical to the scalar `convert`.
+// The widest instruction set supported by the CPU is selected at the first
+// call.
+//
+// These overloads take the place of the ones in convert.hpp for the formats
+// and the rounding modes that the kernels implement (see
+// detail::is_vector_conversion); the others, stochastic rounding included,
+// run the scalar convert for each element.
+template<typename To, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags>
+    requires detail::is_vector_conversion<basic_float<E, M, B, S>, To, Rounding>
+constexpr void convert(std::span<const basic_float<E, M, B, S>> x, std::span<To> z,
+                       const Rounding&, const Flags& flg) noexcept
+{
+    using from_type = basic_float<E, M, B, S>;
+    assert(x.size() == z.size());
+
+    if(std::is_constant_evaluated())
+    {
+        flg.raise(detail::convert_kernel_scalar<To, Rounding, Flags::enabled>(x.data(), z.data(), z.size()));
+        return;
+    }
+    const auto kernel = detail::convert_kernel<from_type, To, Rounding, Flags::enabled>();
+    flg.raise(kernel(x.data(), z.data(), z.size()));
+}
+
+template<typename To, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding>
+    requires detail::is_vector_conversion<basic_float<E, M, B, S>, To, Rounding>
+constexpr void convert(std::span<const basic_float<E, M, B, S>> x, std::span<To> z,
+                       const Rounding& rnd) noexcept
+{
+    convert(x, z, rnd, flags::ignore{});
+}
+
+template<typename To, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+    requires detail::is_vector_conversion<basic_float<E, M, B, S>, To, rounding::nearest_even>
+constexpr void convert(std::span<const basic_float<E, M, B, S>> x, std::span<To> z) noexcept
+{
+    convert(x, z, rounding::nearest_even{});
+}
+
+} // flemu
+#endif // FLEMU_BATCH_CONVERT_HPP
@@ -3,8 +3,6 @@
 
 #include "utility.hpp"
 
-#include <boost/ut.hpp>
-
 #include <cassert>
 #include <cstdint>
 
@@ -142,61 +140,127 @@ operator<<(std::basic_ostream<charT, traits>& os, const const_bit_proxy<Base>& b
     return os;
 }
 
-#ifdef FLEMU_ACTIVATE_UNIT_TESTS
-inline boost::ut::suite tests_bit_proxy = []
+// bit_proxy with the bounds [Start, Stop] fixed at compile time. It only holds
+// a pointer to the base; the masks are constants, so reading a field is one
+// shift and one mask. The accessors are force-inlined to keep it that way in
+// debug builds.
+template<std::unsigned_integral Base, std::size_t Start, std::size_t Stop>
+struct static_bit_proxy
 {
-    using namespace boost::ut::literals;
+  public:
+
+    static_assert(Start <= Stop && Stop < sizeof(Base) * 8);
+
+    using base_type = Base;
+
+    static constexpr base_type field_mask = mask<base_type>(Stop, Start);
+
+  public:
 
-    "bit_proxy_substitution"_test = []
+    FLEMU_FORCE_INLINE constexpr explicit static_bit_proxy(base_type& b) noexcept
+      : base_(&b) // no call to std::addressof in debug builds
+    {}
+
+    FLEMU_FORCE_INLINE constexpr static_bit_proxy& operator=(const base_type i) noexcept
     {
-        std::uint32_t u32 = 0x00FF'0F0F;
-        bit_proxy proxy1(u32, 15, 0);
+        (*base_) = base_type(((*base_) & ~field_mask) | ((i << Start) & field_mask));
+        return *this;
+    }
 
-        boost::ut::expect(proxy1.start() ==  0);
-        boost::ut::expect(proxy1.stop()  == 15);
-        boost::ut::expect(proxy1.width() == 16);
+    FLEMU_FORCE_INLINE constexpr explicit operator base_type() const noexcept
+    {
+        return base_type(((*base_) & field_mask) >> Start);
+    }
+
+    constexpr auto operator==(const base_type& other) const noexcept
+    {
+        return base_type(*this) == other;
+    }
+    constexpr auto operator<=>(const base_type& other) const noexcept
+    {
+        return base_type(*this) <=> other;
+    }
 
-        const std::uint32_t proxy1_data(proxy1);
-        boost::ut::expect(proxy1      == 0x0F0F);
-        boost::ut::expect(proxy1_data == 0x0F0F);
+    constexpr auto operator==(const static_bit_proxy& other) const noexcept
+    {
+        return base_type(*this) == base_type(other);
+    }
+    constexpr auto operator<=>(const static_bit_proxy& other) const noexcept
+    {
+        return base_type(*this) <=> base_type(other);
+    }
 
-        proxy1 = 0xF0F0;
-        boost::ut::expect(u32 == 0x00FF'F0F0);
+    static constexpr std::size_t start() noexcept {return Start;}
+    static constexpr std::size_t stop()  noexcept {return Stop;}
+    static constexpr std::size_t width() noexcept {return Stop - Start + 1;}
 
-        bit_proxy proxy2(u32, 23, 8);
-        boost::ut::expect(proxy2 == 0xFFF0);
+  private:
+    base_type* base_;
+};
 
-        proxy2 = 0x000F;
-        boost::ut::expect(u32 == 0x0000'0FF0);
-        boost::ut::expect(proxy2 == 0x000F);
+template<std::unsigned_integral Base, std::size_t Start, std::size_t Stop>
+struct const_static_bit_proxy
+{
+  public:
 
-        bit_proxy proxy3(u32, 31, 16);
-        boost::ut::expect(proxy3 == 0x0000);
+    static_assert(Start <= Stop && Stop < sizeof(Base) * 8);
 
-        proxy3 = 0xDEAD;
-        boost::ut::expect(u32 == 0xDEAD'0FF0);
-        boost::ut::expect(proxy3 == 0xDEAD);
+    using base_type = Base;
 
-        proxy1 = 0xBEEF'BEEF;
-        boost::ut::expect(u32 == 0xDEAD'BEEF);
+    static constexpr base_type field_mask = mask<base_type>(Stop, Start);
 
-        bit_proxy proxy4(u32, 31, 31);
-        boost::ut::expect(proxy4 == 1);
-    };
+  public:
 
-    "bit_proxy_comparison"_test = []
+    FLEMU_FORCE_INLINE constexpr explicit const_static_bit_proxy(const base_type& b) noexcept
+      : base_(&b)
+    {}
+
+    FLEMU_FORCE_INLINE constexpr explicit operator base_type() const noexcept
+    {
+        return base_type(((*base_) & field_mask) >> Start);
+    }
+
+    constexpr auto operator==(const base_type& other) const noexcept
     {
-        std::uint32_t u32 = 0x00FF'0F0F;
-        bit_proxy proxy1(u32, 15,  0); // 0F0F
-        bit_proxy proxy2(u32, 23,  8); // FF0F
-        bit_proxy proxy3(u32, 31, 16); // 00FF
+        return base_type(*this) == other;
+    }
+    constexpr auto operator<=>(const base_type& other) const noexcept
+    {
+        return base_type(*this) <=> other;
+    }
+
+    constexpr auto operator==(const const_static_bit_proxy& other) const noexcept
+    {
+        return base_type(*this) == base_type(other);
+    }
+    constexpr auto operator<=>(const const_static_bit_proxy& other) const noexcept
+    {
+        return base_type(*this) <=> base_type(other);
+    }
+
+    static constexpr std::size_t start() noexcept {return Start;}
+    static constexpr std::size_t stop()  noexcept {return Stop;}
+    static constexpr std::size_t width() noexcept {return Stop - Start + 1;}
 
-        boost::ut::expect(proxy1 < proxy2);
-        boost::ut::expect(proxy1 > proxy3);
-        boost::ut::expect(proxy2 > proxy3);
-    };
+  private:
+    base_type const* base_;
 };
-#endif
+
+template<typename charT, typename traits, typename Base, std::size_t Start, std::size_t Stop>
+std::basic_ostream<charT, traits>&
+operator<<(std::basic_ostream<charT, traits>& os, const static_bit_proxy<Base, Start, Stop>& bp)
+{
+    os << Base(bp);
+    return os;
+}
+
+template<typename charT, typename traits, typename Base, std::size_t Start, std::size_t Stop>
+std::basic_ostream<charT, traits>&
+operator<<(std::basic_ostream<charT, traits>& os, const const_static_bit_proxy<Base, Start, Stop>& bp)
+{
+    os << Base(bp);
+    return os;
+}
 
 } // flemu
 #endif// FLEMU_PROXY_HPP
@@ -0,0 +1,414 @@
+#ifndef FLEMU_BLOCK_FLOAT_HPP
+#define FLEMU_BLOCK_FLOAT_HPP
+
+#include "utility.hpp"
+#include "float32.hpp"
+#include "adder.hpp"
+#include "flags.hpp"
+#include "rounding.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace flemu
+{
+
+namespace detail
+{
+
+// the value of an element of a block with exponent e, exactly in float32.
+template<std::size_t Mantissa, std::unsigned_integral Element>
+constexpr float32 decode_block_element(const std::uint32_t e, const Element v) noexcept
+{
+    const std::uint32_t sgn = std::uint32_t(v >> Mantissa) & 1;
+    const std::uint32_t man = std::uint32_t(v) & mask<std::uint32_t>(Mantissa - 1, 0);
+    if(e == 0xFF)
+    {
+        return float32(sgn, 0xFF, 1);
+    }
+    if(man == 0)
+    {
+        return float32(sgn, 0, 0);
+    }
+
+    // the leading 1 of man at bit p is the implicit 1 of a float32 with the
+    // biased exponent p + e - (Mantissa - 1). below 1, it is denormalized,
+    // and the mantissa is man in units of 2^-149.
+    const std::uint32_t p   = std::uint32_t(std::bit_width(man)) - 1;
+    const std::int32_t  exp = std::int32_t(p + e) - std::int32_t(Mantissa - 1);
+    return (exp >= 1) ? float32(sgn, std::uint32_t(exp), (man << (23 - p)) & 0x007F'FFFFu)
+                      : float32(sgn, 0, man << (e + 23 - Mantissa));
+}
+
+// rounds each of the `count` elements of x to the scale of the exponent of
+// the largest, and pads the block with zeros. if a mantissa carries out to
+// 2^Mantissa by rounding, the block is rounded again with the next exponent;
+// it fits then. returns the flags if Flags is true.
+template<std::size_t Mantissa, std::size_t BlockSize, bool Flags,
+         std::unsigned_integral Element, rounding_policy Rounding>
+std::uint32_t encode_block(const float32* x, const std::size_t count, std::uint8_t& exponent,
+                           Element* z, const Rounding& rnd, const std::uint64_t first) noexcept
+{
+    constexpr std::size_t extra_bits = Rounding::extra_bits;
+    using work_type = std::conditional_t<(24 + extra_bits + 1 <= 32), std::uint32_t, std::uint64_t>;
+    constexpr work_type   max_man    = mask<work_type>(Mantissa - 1, 0);
+
+    std::uint32_t emax = 1;
+    for(std::size_t i=0; i<count; ++i)
+    {
+        emax = std::max(emax, std::uint32_t(x[i].exponent()));
+    }
+    std::fill(z + count, z + BlockSize, Element(0));
+    if(emax == 0xFF)
+    {
+        exponent = 0xFF;
+        std::fill(z, z + count, Element(0));
+        return 0;
+    }
+
+    for(std::uint32_t e=emax; ; ++e)
+    {
+        // at e == 254, a carry saturates instead.
+        const bool    saturate = (e == 0xFE);
+        work_type     top      = 0;
+        std::uint32_t f        = 0;
+        for(std::size_t i=0; i<count; ++i)
+        {
+            const work_type     sgn = std::uint32_t(x[i].sign());
+            const std::uint32_t exp = std::uint32_t(x[i].exponent());
+            const work_type     sig = (exp == 0 ? 0 : work_type(1) << 23) | std::uint32_t(x[i].mantissa());
+
+            // from units of 2^(max(exp, 1) - 150) to units of 2^(e - 127 - (Mantissa - 1)).
+            const work_type shift   = e - std::max<std::uint32_t>(exp, 1) + 24 - Mantissa;
+            const work_type w       = shift_right_sticky(work_type(sig << extra_bits), shift);
+            const work_type man     = (w >> extra_bits) + rnd.for_element(first + i).round_up(sgn, w);
+            const work_type clamped = saturate ? std::min(man, max_man) : man;
+            top |= clamped;
+            z[i] = Element((sgn << Mantissa) | clamped);
+            if constexpr(Flags)
+            {
+                const bool overflow = clamped != man;
+                const bool inexact  = (w & mask<work_type>(extra_bits - 1, 0)) != 0 || overflow;
+                f |= (overflow ? flag_overflow : 0u) | (inexact ? flag_inexact : 0u);
+            }
+        }
+        if((top >> Mantissa) == 0)
+        {
+            exponent = std::uint8_t(e);
+            return f;
+        }
+    }
+}
+
+// one block of x + y. the rounding mode and the first index are as in
+// encode_block. z may be the same as x or y.
+//
+// if the exponents are the same, the mantissas are added as signed integers,
+// with no alignment and no rounding, and the result keeps the exponent unless
+// a sum carries out. otherwise the block with the smaller exponent is aligned
+// to the other, with one more extra bit than the rounding mode needs, so that
+// a carry-out of the block (all of it moves to the next exponent) shifts
+// right once more with the sticky bit still correct.
+//
+// the exponent never goes down; a block that cancels keeps it, with small
+// mantissas, as the hardware does. converting it back to float32 and again
+// renormalizes it.
+template<std::size_t Mantissa, std::size_t BlockSize, bool Flags,
+         std::unsigned_integral Element, rounding_policy Rounding>
+std::uint32_t add_block(const std::uint32_t ex, const Element* x, const std::uint32_t ey, const Element* y,
+                        std::uint8_t& ez, Element* z, const Rounding& rnd, const std::uint64_t first) noexcept
+{
+    constexpr std::size_t extra_bits = Rounding::extra_bits + 1;
+    using work_type = std::conditional_t<(Mantissa + extra_bits + 2 <= 32), std::uint32_t, std::uint64_t>;
+    constexpr work_type   max_man    = mask<work_type>(Mantissa - 1, 0);
+
+    if(ex == 0xFF || ey == 0xFF)
+    {
+        ez = 0xFF;
+        std::fill(z, z + BlockSize, Element(0));
+        return 0;
+    }
+
+    const auto sign_of = [](const Element v) {return std::uint32_t(v >> Mantissa) & 1;};
+    const auto man_of  = [](const Element v) {return std::uint32_t(v) & mask<std::uint32_t>(Mantissa - 1, 0);};
+
+    if(ex == ey)
+    {
+        // sign and magnitude to two's complement and back, without branches,
+        // so that the loops are vectorized.
+        const auto to_signed = [&](const Element v) {
+            const std::int32_t s = std::int32_t(sign_of(v));
+            return (std::int32_t(man_of(v)) ^ -s) + s;
+        };
+        std::array<std::int32_t, BlockSize> sum;
+        std::uint32_t top = 0;
+        for(std::size_t i=0; i<BlockSize; ++i)
+        {
+            sum[i] = to_signed(x[i]) + to_signed(y[i]);
+            top |= std::uint32_t(std::abs(sum[i]));
+        }
+        if((top >> Mantissa) == 0)
+        {
+            for(std::size_t i=0; i<BlockSize; ++i)
+            {
+                const std::uint32_t neg  = std::uint32_t(sum[i]) >> 31;
+                const std::uint32_t zero = Rounding::exact_zero_sign(sign_of(x[i]), sign_of(y[i])) &
+                                           std::uint32_t(sum[i] == 0);
+                z[i] = Element(((neg | zero) << Mantissa) | std::uint32_t(std::abs(sum[i])));
+            }
+            ez = std::uint8_t(ex);
+            return 0;
+        }
+    }
+
+    // |x| of the block with the larger exponent, the other aligned to it.
+    const bool          swap  = ex < ey;
+    const Element*      big   = swap ? y : x;
+    const Element*      small = swap ? x : y;
+    const std::uint32_t ebig  = std::max(ex, ey);
+    const work_type     diff  = ebig - std::min(ex, ey);
+
+    std::array<work_type, BlockSize> mag;
+    std::array<work_type, BlockSize> sgn;
+    for(std::size_t i=0; i<BlockSize; ++i)
+    {
+        const work_type sa = sign_of(big[i]);
+        const work_type sb = sign_of(small[i]);
+        const work_type a  = work_type(man_of(big[i])) << extra_bits;
+        const work_type b  = shift_right_sticky(work_type(man_of(small[i])) << extra_bits, diff);
+        mag[i] = (sa == sb) ? a + b : (a >= b) ? a - b : b - a;
+        sgn[i] = (mag[i] == 0) ? Rounding::exact_zero_sign(std::uint32_t(sa), std::uint32_t(sb)) :
+                 (sa == sb || a >= b) ? sa : sb;
+    }
+
+    // round with the larger exponent, then with the next one if a mantissa
+    // carried out. it fits then, since |x + y| < 2^(Mantissa + 1).
+    work_type top = 0;
+    for(std::size_t i=0; i<BlockSize; ++i)
+    {
+        const work_type w = shift_right_sticky(mag[i], work_type(1));
+        top |= (w >> (extra_bits - 1)) + rnd.for_element(first + i).round_up(sgn[i], w);
+    }
+    const work_type carry    = top >> Mantissa;
+    const bool      saturate = carry != 0 && ebig == 0xFE;
+    const work_type shift    = saturate ? 1 : 1 + carry;
+
+    std::uint32_t f = 0;
+    for(std::size_t i=0; i<BlockSize; ++i)
+    {
+        const work_type w       = shift_right_sticky(mag[i], shift);
+        const work_type man     = (w >> (extra_bits - 1)) + rnd.for_element(first + i).round_up(sgn[i], w);
+        const work_type clamped = std::min(man, max_man);
+        z[i] = Element((sgn[i] << Mantissa) | clamped);
+        if constexpr(Flags)
+        {
+            const bool overflow = clamped != man;
+            const bool inexact  = (w & mask<work_type>(extra_bits - 2, 0)) != 0 || overflow;
+            f |= (overflow ? flag_overflow : 0u) | (inexact ? flag_inexact : 0u);
+        }
+    }
+    ez = std::uint8_t(saturate ? ebig : ebig + carry);
+    return f;
+}
+
+} // detail
+
+// Block floating point: an array of numbers split into blocks of `BlockSize`
+// elements that share one exponent, as two planes.
+//
+//   exponents : | e0 | e1 | ...                      std::uint8_t per block, biased as float32
+//   elements  : | s|m | s|m | ... (BlockSize) | ...  sign at bit Mantissa, Mantissa bits below
+//
+//   element i of block b: (-1)^s * m * 2^(e_b - 127 - (Mantissa - 1))
+//
+// The mantissas have no implicit 1. the conversion picks the exponent of the
+// largest element of a block, so that its leading 1 is at bit Mantissa - 1,
+// and rounds the others to the same scale; they lose the bits below it. Each
+// element is a value of float32 (Mantissa <= 24), so the conversion back is
+// exact.
+//
+// A block cannot hold an inf beside finite numbers, so a block that has an inf
+// or a nan becomes a nan block (e == 255), as the shared scale of the MX
+// formats does. A finite block whose exponent would go above 254 saturates at
+// the largest magnitude and raises overflow.
+//
+// The last block is padded with zeros.
+template<std::size_t Mantissa, std::size_t BlockSize>
+class block_float
+{
+  public:
+
+    static_assert(1 <= Mantissa && Mantissa <= 24);
+    static_assert(1 <= BlockSize);
+
+    using value_type   = float32;
+    using element_type = detail::least_uint_t<1 + Mantissa>;
+
+    static constexpr std::size_t   mantissa_bits = Mantissa;
+    static constexpr std::size_t   block_size    = BlockSize;
+    static constexpr std::size_t   sign_bit      = Mantissa;
+    static constexpr std::uint8_t  nan_exponent  = 0xFF;
+    static constexpr element_type  mantissa_mask = mask<element_type>(Mantissa - 1, 0);
+    static constexpr std::size_t   alignment     = 64;
+
+    template<typename T>
+    using plane_type = std::vector<T, aligned_allocator<T, alignment>>;
+
+  public:
+
+    block_float() = default;
+
+    // n zeros
+    explicit block_float(const std::size_t n)
+    {
+        this->resize(n);
+    }
+    explicit block_float(std::span<const float32> xs)
+    {
+        this->assign(xs);
+    }
+
+    std::size_t size()       const noexcept {return size_;}
+    bool        empty()      const noexcept {return size_ == 0;}
+    std::size_t num_blocks() const noexcept {return exponent_.size();}
+
+    // the new elements are zeros.
+    void resize(const std::size_t n)
+    {
+        const std::size_t blocks = (n + BlockSize - 1) / BlockSize;
+        exponent_.resize(blocks, 1);
+        element_.resize(blocks * BlockSize, 0);
+        std::fill(element_.begin() + n, element_.end(), element_type(0));
+        size_ = n;
+    }
+
+    float32 operator[](const std::size_t i) const noexcept
+    {
+        return detail::decode_block_element<Mantissa>(exponent_[i / BlockSize], element_[i]);
+    }
+
+    // converts xs, element by element with rnd.for_element(i).
+    template<rounding_policy Rounding, flag_policy Flags>
+    void assign(std::span<const float32> xs, const Rounding& rnd, const Flags& flg)
+    {
+        this->resize(xs.size());
+        std::uint32_t f = 0;
+        for(std::size_t b=0; b<this->num_blocks(); ++b)
+        {
+            const std::size_t first = b * BlockSize;
+            f |= detail::encode_block<Mantissa, BlockSize, Flags::enabled>(
+                xs.data() + first, std::min(BlockSize, xs.size() - first),
+                exponent_[b], element_.data() + first, rnd, first);
+        }
+        flg.raise(f);
+    }
+    template<rounding_policy Rounding>
+    void assign(std::span<const float32> xs, const Rounding& rnd)
+    {
+        this->assign(xs, rnd, flags::ignore{});
+    }
+    void assign(std::span<const float32> xs)
+    {
+        this->assign(xs, rounding::nearest_even{});
+    }
+
+    void store(std::span<float32> xs) const noexcept
+    {
+        assert(xs.size() == this->size());
+        for(std::size_t i=0; i<xs.size(); ++i)
+        {
+            xs[i] = (*this)[i];
+        }
+    }
+    std::vector<float32> to_float32() const
+    {
+        std::vector<float32> xs(this->size());
+        this->store(std::span<float32>(xs));
+        return xs;
+    }
+
+    std::span<const std::uint8_t> exponents() const noexcept {return exponent_;}
+    std::span<const element_type> elements()  const noexcept {return element_;}
+
+    std::span<std::uint8_t> exponents() noexcept {return exponent_;}
+    std::span<element_type> elements()  noexcept {return element_;}
+
+  private:
+
+    std::size_t              size_ = 0;
+    plane_type<std::uint8_t> exponent_;
+    plane_type<element_type> element_;
+};
+
+// the formats of Microsoft floating point: an 8-bit shared exponent per 16
+// elements, and 1 sign and 3 or 7 mantissa bits per element.
+using msfp12 = block_float<3, 16>;
+using msfp16 = block_float<7, 16>;
+
+// z = x + y, block by block, with the rounding mode for each element
+// rnd.for_element(i). z is resized to the size of x. z may be the same as x
+// or y. the blocks with the same exponent take the integer path; see
+// detail::add_block.
+template<std::size_t M, std::size_t B, rounding_policy Rounding, flag_policy Flags>
+void add(const block_float<M, B>& x, const block_float<M, B>& y, block_float<M, B>& z,
+         const Rounding& rnd, const Flags& flg)
+{
+    assert(x.size() == y.size());
+    z.resize(x.size());
+
+    const auto xe = x.exponents();
+    const auto ye = y.exponents();
+    const auto ze = z.exponents();
+    std::uint32_t f = 0;
+    for(std::size_t b=0; b<z.num_blocks(); ++b)
+    {
+        const std::size_t first = b * B;
+        f |= detail::add_block<M, B, Flags::enabled>(xe[b], x.elements().data() + first,
+                                                     ye[b], y.elements().data() + first,
+                                                     ze[b], z.elements().data() + first, rnd, first);
+    }
+    flg.raise(f);
+}
+
+template<std::size_t M, std::size_t B, rounding_policy Rounding>
+void add(const block_float<M, B>& x, const block_float<M, B>& y, block_float<M, B>& z, const Rounding& rnd)
+{
+    add(x, y, z, rnd, flags::ignore{});
+}
+
+template<std::size_t M, std::size_t B>
+void add(const block_float<M, B>& x, const block_float<M, B>& y, block_float<M, B>& z)
+{
+    add(x, y, z, rounding::nearest_even{});
+}
+
+// acc += x. a sum of many blocks of about the same scale stays on the integer
+// path until a block carries out.
+template<std::size_t M, std::size_t B, rounding_policy Rounding, flag_policy Flags>
+void accumulate(block_float<M, B>& acc, const block_float<M, B>& x, const Rounding& rnd, const Flags& flg)
+{
+    add(acc, x, acc, rnd, flg);
+}
+
+template<std::size_t M, std::size_t B, rounding_policy Rounding>
+void accumulate(block_float<M, B>& acc, const block_float<M, B>& x, const Rounding& rnd)
+{
+    accumulate(acc, x, rnd, flags::ignore{});
+}
+
+template<std::size_t M, std::size_t B>
+void accumulate(block_float<M, B>& acc, const block_float<M, B>& x)
+{
+    accumulate(acc, x, rounding::nearest_even{});
+}
+
+} // flemu
+#endif // FLEMU_BLOCK_FLOAT_HPP
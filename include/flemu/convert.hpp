@@ -0,0 +1,110 @@
+#ifndef FLEMU_CONVERT_HPP
+#define FLEMU_CONVERT_HPP
+
+#include "float32.hpp"
+#include "adder.hpp"
+#include "fma.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <span>
+
+namespace flemu
+{
+
+// x converted to the format To, rounded by the rounding mode.
+//
+// x == sig * 2^exp exactly, where sig has the implicit 1 (if any), so it is
+// rounded in the same way as the result of fma. a conversion to a wider format
+// is exact. inf and the sign of zero are kept, and nan becomes the nan of To.
+//
+// the exception flags are reported to `flg`; see flags.hpp. nan does not
+// raise invalid, since there is no signaling nan.
+template<typename To, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags>
+constexpr To convert(const basic_float<E, M, B, S>& x, const Rounding& rnd, const Flags& flg) noexcept
+{
+    using from_type = basic_float<E, M, B, S>;
+    using base_type = typename from_type::base_type;
+    using to_base   = typename To::base_type;
+
+    static_assert(M + 1 <= 62, "the significand should fit in the wide register");
+    static_assert(To::mantissa_bits + Rounding::extra_bits <= 61, "the result should fit in the wide register");
+
+    const std::uint32_t sgn = base_type(x.sign());
+    const std::uint32_t exp = base_type(x.exponent());
+    const std::uint64_t man = base_type(x.mantissa());
+
+    if(exp == from_type::exponent_max)
+    {
+        return (man != 0) ? To(to_base(0), To::exponent_max, to_base(1)) :
+                            To(to_base(sgn), To::exponent_max, to_base(0));
+    }
+    if(exp == 0 && man == 0)
+    {
+        return To(to_base(sgn), to_base(0), to_base(0));
+    }
+    const std::uint64_t sig = (exp == 0 ? 0u : std::uint64_t(1) << M) + man;
+    return detail::round_pack_wide<To>(rnd, flg, sgn, sig,
+                                       std::int32_t(std::max(exp, 1u)) - std::int32_t(B + M));
+}
+
+template<typename To, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding>
+constexpr To convert(const basic_float<E, M, B, S>& x, const Rounding& rnd) noexcept
+{
+    return convert<To>(x, rnd, flags::ignore{});
+}
+
+// x converted to To with nearest-(even)-rounding.
+template<typename To, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr To convert(const basic_float<E, M, B, S>& x) noexcept
+{
+    return convert<To>(x, rounding::nearest_even{});
+}
+
+// z[i] = convert<To>(x[i], rnd.for_element(i)). the conversions between
+// float32 and the narrower formats have vectorized overloads in
+// batch_convert.hpp.
+template<typename To, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags>
+constexpr void convert(std::span<const basic_float<E, M, B, S>> x, std::span<To> z,
+                       const Rounding& rnd, const Flags& flg) noexcept
+{
+    assert(x.size() == z.size());
+    if constexpr(Flags::enabled)
+    {
+        std::uint32_t f = 0;
+        for(std::size_t i=0; i<z.size(); ++i)
+        {
+            z[i] = convert<To>(x[i], rnd.for_element(i), flags::accumulate{f});
+        }
+        flg.raise(f);
+    }
+    else
+    {
+        for(std::size_t i=0; i<z.size(); ++i)
+        {
+            z[i] = convert<To>(x[i], rnd.for_element(i));
+        }
+    }
+}
+
+template<typename To, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding>
+constexpr void convert(std::span<const basic_float<E, M, B, S>> x, std::span<To> z,
+                       const Rounding& rnd) noexcept
+{
+    convert(x, z, rnd, flags::ignore{});
+}
+
+template<typename To, std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr void convert(std::span<const basic_float<E, M, B, S>> x, std::span<To> z) noexcept
+{
+    convert(x, z, rounding::nearest_even{});
+}
+
+} // flemu
+#endif // FLEMU_CONVERT_HPP
@@ -0,0 +1,324 @@
+#ifndef FLEMU_COUNTERS_HPP
+#define FLEMU_COUNTERS_HPP
+
+#include "add_probe.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace flemu
+{
+
+// Counts the paths that add takes, to see which of them a workload exercises
+// and how often (e.g. how many additions cancel, or have denormal operands).
+//
+// The hook in add is compiled only with -DFLEMU_ENABLE_COUNTERS; without it,
+// add is the same code as before and nothing of this file is called. With it,
+// every add counts, per thread,
+//
+//   - calls               : the number of additions
+//   - taken[p]            : the additions that took add_point p
+//   - exponent_gap[g]     : the additions aligned by g bits (g >= 31 in 31)
+//   - normalization_shift : the same, of the normalization after a cancellation
+//
+// the counters of a thread are relaxed atomics that only the thread writes, so
+// an increment is a plain load, add and store; no lock, no shared cache line.
+// the points of an add are counted as one mask; see detail::thread_counts.
+// snapshot() sums up the running threads and the ones that have exited.
+//
+//   ... // add on any thread
+//   const auto counts = flemu::counters::snapshot();
+//   flemu::counters::write_json(stdout, counts);
+//
+// a probe can also be passed to detail::add_unrecorded without the macro; the
+// tests do that.
+namespace counters
+{
+
+struct add_counts
+{
+    std::uint64_t calls = 0;
+    std::array<std::uint64_t, num_add_points>   taken{};
+    std::array<std::uint64_t, add_measure_bins> exponent_gap{};
+    std::array<std::uint64_t, add_measure_bins> normalization_shift{};
+
+    std::uint64_t not_taken(const add_point p) const noexcept
+    {
+        return calls - taken[static_cast<std::uint32_t>(p)];
+    }
+
+    void merge(const add_counts& other) noexcept
+    {
+        calls += other.calls;
+        for(std::size_t i=0; i<num_add_points; ++i)
+        {
+            taken[i] += other.taken[i];
+        }
+        for(std::size_t i=0; i<add_measure_bins; ++i)
+        {
+            exponent_gap[i]        += other.exponent_gap[i];
+            normalization_shift[i] += other.normalization_shift[i];
+        }
+    }
+};
+
+namespace detail
+{
+
+// byte_spread[b] has byte i == bit i of b, to add 8 points at once.
+inline constexpr std::array<std::uint64_t, 256> byte_spread = [] {
+    std::array<std::uint64_t, 256> table{};
+    for(std::size_t b=0; b<256; ++b)
+    {
+        for(std::size_t i=0; i<8; ++i)
+        {
+            table[b] |= std::uint64_t((b >> i) & 1u) << (i * 8);
+        }
+    }
+    return table;
+}();
+
+// the counters of a thread. only the owner increments them; snapshot() reads
+// them from another thread, so they are atomics, but relaxed load and store
+// of the owner compile to the same instructions as a plain increment.
+//
+// an increment per point would be 23 stores per add. instead, the points of
+// an add are a mask, and the mask is added to 8-bit counters packed in 3
+// words (`pending`, byte i of word w is point 8w+i), which are moved to
+// `taken` every 128 calls, before a byte can overflow.
+struct thread_counts
+{
+    using counter = std::atomic<std::uint64_t>;
+
+    static constexpr std::size_t    pending_words = (num_add_points + 7) / 8;
+    static constexpr std::uint64_t  flush_period  = 128;
+
+    counter calls{0};
+    std::array<counter, pending_words>    pending{};
+    std::array<counter, num_add_points>   taken{};
+    std::array<counter, add_measure_bins> exponent_gap{};
+    std::array<counter, add_measure_bins> normalization_shift{};
+
+    static void increment(counter& c, const std::uint64_t n = 1) noexcept
+    {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void count(const std::uint32_t points) noexcept
+    {
+        for(std::size_t w=0; w<pending_words; ++w)
+        {
+            increment(pending[w], byte_spread[(points >> (w * 8)) & 0xFFu]);
+        }
+        const std::uint64_t n = calls.load(std::memory_order_relaxed) + 1;
+        calls.store(n, std::memory_order_relaxed);
+        if(n % flush_period == 0)
+        {
+            flush();
+        }
+    }
+
+    void flush() noexcept
+    {
+        for(std::size_t i=0; i<num_add_points; ++i)
+        {
+            increment(taken[i], pending_count(i));
+        }
+        for(auto& c : pending) {c.store(0, std::memory_order_relaxed);}
+    }
+
+    std::uint64_t pending_count(const std::size_t i) const noexcept
+    {
+        return (pending[i / 8].load(std::memory_order_relaxed) >> (i % 8 * 8)) & 0xFFu;
+    }
+
+    add_counts load() const noexcept
+    {
+        add_counts c;
+        c.calls = calls.load(std::memory_order_relaxed);
+        for(std::size_t i=0; i<num_add_points; ++i)
+        {
+            c.taken[i] = taken[i].load(std::memory_order_relaxed) + pending_count(i);
+        }
+        for(std::size_t i=0; i<add_measure_bins; ++i)
+        {
+            c.exponent_gap[i]        = exponent_gap[i].load(std::memory_order_relaxed);
+            c.normalization_shift[i] = normalization_shift[i].load(std::memory_order_relaxed);
+        }
+        return c;
+    }
+
+    void clear() noexcept
+    {
+        calls.store(0, std::memory_order_relaxed);
+        for(auto& c : pending)             {c.store(0, std::memory_order_relaxed);}
+        for(auto& c : taken)               {c.store(0, std::memory_order_relaxed);}
+        for(auto& c : exponent_gap)        {c.store(0, std::memory_order_relaxed);}
+        for(auto& c : normalization_shift) {c.store(0, std::memory_order_relaxed);}
+    }
+};
+static_assert(num_add_points <= 32);
+
+// the counters of the running threads, and the sum of the exited ones.
+struct counter_registry
+{
+    std::mutex                  mutex;
+    std::vector<thread_counts*> live;
+    add_counts                  retired;
+};
+inline counter_registry registry;
+
+// registers the counters of a thread while it runs, and moves them to
+// `retired` when it exits.
+class thread_registration
+{
+  public:
+
+    thread_registration()
+    {
+        const std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.live.push_back(&counts_);
+    }
+    thread_registration(const thread_registration&) = delete;
+    thread_registration& operator=(const thread_registration&) = delete;
+    ~thread_registration()
+    {
+        const std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.retired.merge(counts_.load());
+        registry.live.erase(std::find(registry.live.begin(), registry.live.end(), &counts_));
+    }
+
+    thread_counts& counts() noexcept {return counts_;}
+
+  private:
+
+    thread_counts counts_;
+};
+
+// the registration has a destructor, so every access to it goes through the
+// initialization check of the thread_local; the pointer to its counters is
+// trivial and costs a load.
+inline thread_local thread_counts* current_counts = nullptr;
+
+[[gnu::noinline]] inline thread_counts& register_thread() noexcept
+{
+    thread_local thread_registration registration;
+    current_counts = &registration.counts();
+    return *current_counts;
+}
+
+inline thread_counts& local_counts() noexcept
+{
+    return current_counts != nullptr ? *current_counts : register_thread();
+}
+
+inline const char* measure_name(const add_measure m) noexcept
+{
+    return m == add_measure::exponent_gap ? "exponent_gap" : "normalization_shift";
+}
+
+} // detail
+
+// the probe that add passes to detail::add_unrecorded with
+// -DFLEMU_ENABLE_COUNTERS. one probe counts one addition: it collects the
+// points in a register, and counts them when it is destroyed, at the end of
+// the add.
+class add_probe
+{
+  public:
+
+    static constexpr bool enabled = true;
+
+    add_probe() noexcept: counts_(detail::local_counts()) {}
+    add_probe(const add_probe&) = delete;
+    add_probe& operator=(const add_probe&) = delete;
+    ~add_probe() {counts_.count(points_);}
+
+    void operator()(const add_point p, const bool taken) const noexcept
+    {
+        points_ |= std::uint32_t(taken) << static_cast<std::uint32_t>(p);
+    }
+
+    void operator()(const add_measure m, const std::uint32_t value) const noexcept
+    {
+        auto& histogram = (m == add_measure::exponent_gap) ? counts_.exponent_gap
+                                                           : counts_.normalization_shift;
+        detail::thread_counts::increment(histogram[std::min<std::size_t>(value, add_measure_bins - 1)]);
+    }
+
+  private:
+
+    detail::thread_counts& counts_;
+    mutable std::uint32_t  points_ = 0;
+};
+
+// the counts of all the threads, the exited ones included. the counts of a
+// thread that is adding at the same time are read as of some moment, so the
+// fields may be off by the additions in flight.
+inline add_counts snapshot()
+{
+    const std::lock_guard<std::mutex> lock(detail::registry.mutex);
+    add_counts total = detail::registry.retired;
+    for(const auto* counts : detail::registry.live)
+    {
+        total.merge(counts->load());
+    }
+    return total;
+}
+
+// zeroes the counts. a thread that is adding at the same time may write back
+// a count from before the reset; call this while the others are quiet.
+inline void reset()
+{
+    const std::lock_guard<std::mutex> lock(detail::registry.mutex);
+    detail::registry.retired = add_counts{};
+    for(auto* counts : detail::registry.live)
+    {
+        counts->clear();
+    }
+}
+
+// {"calls": N,
+//  "points": {"swap": {"taken": T, "not_taken": N - T}, ...},
+//  "exponent_gap": [...], "normalization_shift": [...]}
+inline std::string to_json(const add_counts& c)
+{
+    std::string json = "{\"calls\": " + std::to_string(c.calls) + ",\n \"points\": {";
+    for(std::size_t i=0; i<num_add_points; ++i)
+    {
+        const auto p = static_cast<add_point>(i);
+        json += (i == 0 ? "" : ",");
+        json += "\n  \"" + std::string(add_point_name(p)) + "\": {\"taken\": " +
+                std::to_string(c.taken[i]) + ", \"not_taken\": " + std::to_string(c.not_taken(p)) + "}";
+    }
+    json += "},\n";
+
+    for(const auto m : {add_measure::exponent_gap, add_measure::normalization_shift})
+    {
+        const auto& histogram = (m == add_measure::exponent_gap) ? c.exponent_gap : c.normalization_shift;
+        json += " \"" + std::string(detail::measure_name(m)) + "\": [";
+        for(std::size_t i=0; i<add_measure_bins; ++i)
+        {
+            json += (i == 0 ? "" : ", ") + std::to_string(histogram[i]);
+        }
+        json += (m == add_measure::exponent_gap) ? "],\n" : "]}\n";
+    }
+    return json;
+}
+
+inline bool write_json(std::FILE* fp, const add_counts& c)
+{
+    const std::string json = to_json(c);
+    return std::fwrite(json.data(), 1, json.size(), fp) == json.size();
+}
+
+} // counters
+} // flemu
+#endif // FLEMU_COUNTERS_HPP
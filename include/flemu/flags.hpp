@@ -0,0 +1,84 @@
+#ifndef FLEMU_FLAGS_HPP
+#define FLEMU_FLAGS_HPP
+
+#include <cstdint>
+
+#include <concepts>
+
+namespace flemu
+{
+
+// IEEE 754 exception flags. The bits are OR-ed into a status word and stay
+// there until cleared, like the floating-point status flags of the hardware.
+//
+// flemu does not distinguish signaling and quiet NaNs. invalid is raised
+// when a NaN is made from non-NaN operands (inf - inf, inf * 0), not when a
+// NaN is passed through. Tininess is detected before rounding; underflow is
+// raised if the result is tiny and inexact.
+inline constexpr std::uint32_t flag_invalid        = 0x01;
+inline constexpr std::uint32_t flag_divide_by_zero = 0x02;
+inline constexpr std::uint32_t flag_overflow       = 0x04;
+inline constexpr std::uint32_t flag_underflow      = 0x08;
+inline constexpr std::uint32_t flag_inexact        = 0x10;
+inline constexpr std::uint32_t flag_all            = 0x1F;
+
+// the status word of the calling thread.
+inline std::uint32_t& status_word() noexcept
+{
+    thread_local std::uint32_t word = 0;
+    return word;
+}
+
+inline std::uint32_t test_flags(const std::uint32_t mask = flag_all) noexcept
+{
+    return status_word() & mask;
+}
+
+inline void clear_flags(const std::uint32_t mask = flag_all) noexcept
+{
+    status_word() &= ~mask;
+}
+
+// Where the operations report the flags. It is passed to the operations as a
+// policy object, in the same way as the rounding mode, and selected at compile
+// time. If `enabled` is false, the flags are not computed at all.
+//
+// The flags are computed from the intermediate values beside the result, and
+// only OR-ed into the destination; the result never depends on them. Batch
+// operations OR-reduce the flags of all the elements and report them once.
+namespace flags
+{
+
+// does not compute the flags. this is the default.
+struct ignore
+{
+    static constexpr bool enabled = false;
+    constexpr void raise(const std::uint32_t) const noexcept {}
+};
+
+// ORs the flags into the status word of the calling thread.
+struct thread_status
+{
+    static constexpr bool enabled = true;
+    void raise(const std::uint32_t f) const noexcept {status_word() |= f;}
+};
+
+// ORs the flags into a word owned by the caller.
+struct accumulate
+{
+    static constexpr bool enabled = true;
+    std::uint32_t& word;
+    constexpr void raise(const std::uint32_t f) const noexcept {word |= f;}
+};
+
+} // flags
+
+template<typename Flags>
+concept flag_policy = requires(const Flags& flg, const std::uint32_t f)
+{
+    {Flags::enabled} -> std::convertible_to<bool>;
+    flg.raise(f);
+};
+
+} // flemu
+#endif // FLEMU_FLAGS_HPP
@@ -4,114 +4,128 @@
 #include "utility.hpp"
 #include "bit_proxy.hpp"
 
-#include <boost/ut.hpp>
-
 #include <cstdint>
-#include <cstring>
-#include <bit>
+
+#include <concepts>
+#include <type_traits>
 
 namespace flemu
 {
 
-template<std::size_t Exponent, std::size_t Mantissa, std::uint32_t Bias>
-struct basic_float32
+namespace detail
+{
+
+// the smallest unsigned integer type that has at least `Bits` bits.
+template<std::size_t Bits>
+using least_uint_t = std::conditional_t<(Bits <=  8), std::uint8_t,
+                     std::conditional_t<(Bits <= 16), std::uint16_t,
+                     std::conditional_t<(Bits <= 32), std::uint32_t, std::uint64_t>>>;
+
+} // detail
+
+// IEEE-754-like binary floating point number with 1 sign bit, `Exponent` bits
+// of biased exponent and `Mantissa` bits of mantissa, stored in the lowest
+// bits of `Storage`.
+//
+//   | unused | sign | exponent | mantissa |
+//              ^ sign_bit == Exponent + Mantissa
+//
+// The all-1 exponent is reserved for inf and nan, as IEEE-754 does.
+template<std::size_t Exponent, std::size_t Mantissa, std::uint32_t Bias,
+         std::unsigned_integral Storage = detail::least_uint_t<1 + Exponent + Mantissa>>
+struct basic_float
 {
   public:
 
-    static_assert(1 + Exponent + Mantissa == 32);
+    static_assert(1 + Exponent + Mantissa <= 8 * sizeof(Storage));
+    static_assert(2 <= Exponent && 1 <= Mantissa);
+
+    using base_type = Storage;
+
+    static constexpr std::size_t   exponent_bits  = Exponent;
+    static constexpr std::size_t   mantissa_bits  = Mantissa;
+    static constexpr std::size_t   sign_bit       = Exponent + Mantissa;
 
-    using base_type        = std::uint32_t;
-    using proxy_type       = bit_proxy<base_type>;
-    using const_proxy_type = const_bit_proxy<base_type>;
+    using sign_proxy_type           = static_bit_proxy<base_type, sign_bit, sign_bit>;
+    using exponent_proxy_type       = static_bit_proxy<base_type, Mantissa, sign_bit-1>;
+    using mantissa_proxy_type       = static_bit_proxy<base_type, 0, Mantissa-1>;
+    using const_sign_proxy_type     = const_static_bit_proxy<base_type, sign_bit, sign_bit>;
+    using const_exponent_proxy_type = const_static_bit_proxy<base_type, Mantissa, sign_bit-1>;
+    using const_mantissa_proxy_type = const_static_bit_proxy<base_type, 0, Mantissa-1>;
+    static constexpr std::uint32_t exponent_bias  = Bias;
+    static constexpr base_type     exponent_max   = mask<base_type>(Exponent - 1, 0);
+    static constexpr base_type     magnitude_mask = mask<base_type>(sign_bit - 1, 0);
 
   public:
 
-    constexpr basic_float32(const base_type b) noexcept
+    constexpr basic_float() noexcept
+        : value_(0)
+    {}
+    constexpr basic_float(const base_type b) noexcept
         : value_(b)
     {}
-    constexpr basic_float32(const base_type sgn, const base_type exp, const base_type man) noexcept
-        : value_( ((sgn << 31)       & mask<base_type>(31, 31)) +
-                  ((exp << Mantissa) & mask<base_type>(30, Mantissa)) +
-                  ( man              & mask<base_type>(Mantissa-1, 0)))
+    constexpr basic_float(const base_type sgn, const base_type exp, const base_type man) noexcept
+        : value_(base_type(((base_type(sgn) << sign_bit) & mask<base_type>(sign_bit, sign_bit)) +
+                           ((base_type(exp) << Mantissa) & mask<base_type>(sign_bit-1, Mantissa)) +
+                           ( man                         & mask<base_type>(Mantissa-1, 0))))
     {}
 
-    constexpr const_proxy_type sign()     const noexcept {return const_bit_proxy(value_, 31, 31);}
-    constexpr const_proxy_type exponent() const noexcept {return const_bit_proxy(value_, 30, Mantissa);}
-    constexpr const_proxy_type mantissa() const noexcept {return const_bit_proxy(value_, Mantissa-1, 0);}
+    FLEMU_FORCE_INLINE constexpr const_sign_proxy_type     sign()     const noexcept {return const_sign_proxy_type(value_);}
+    FLEMU_FORCE_INLINE constexpr const_exponent_proxy_type exponent() const noexcept {return const_exponent_proxy_type(value_);}
+    FLEMU_FORCE_INLINE constexpr const_mantissa_proxy_type mantissa() const noexcept {return const_mantissa_proxy_type(value_);}
 
-    constexpr proxy_type sign()     noexcept {return bit_proxy(value_, 31, 31);}
-    constexpr proxy_type exponent() noexcept {return bit_proxy(value_, 30, Mantissa);}
-    constexpr proxy_type mantissa() noexcept {return bit_proxy(value_, Mantissa-1, 0);}
+    FLEMU_FORCE_INLINE constexpr sign_proxy_type     sign()     noexcept {return sign_proxy_type(value_);}
+    FLEMU_FORCE_INLINE constexpr exponent_proxy_type exponent() noexcept {return exponent_proxy_type(value_);}
+    FLEMU_FORCE_INLINE constexpr mantissa_proxy_type mantissa() noexcept {return mantissa_proxy_type(value_);}
 
     constexpr bool is_nan() const noexcept
     {
-        return this->exponent() == 0b1111'1111 && this->mantissa() != 0;
+        return this->exponent() == exponent_max && this->mantissa() != 0;
     }
     constexpr bool is_inf() const noexcept
     {
-        return this->exponent() == 0b1111'1111 && this->mantissa() == 0;
+        return this->exponent() == exponent_max && this->mantissa() == 0;
     }
 
-    constexpr std::uint32_t bias()  const noexcept {return Bias;}
-    constexpr std::uint32_t base() const noexcept {return value_;}
+    constexpr std::uint32_t bias() const noexcept {return Bias;}
+    constexpr base_type     base() const noexcept {return value_;}
 
   private:
 
-    std::uint32_t value_;
+    base_type value_;
 };
-using float32 = basic_float32<8, 23, 127>;
 
-inline float to_float(const float32 x) noexcept
+template<std::size_t Exponent, std::size_t Mantissa, std::uint32_t Bias>
+using basic_float32 = basic_float<Exponent, Mantissa, Bias, std::uint32_t>;
+
+using float32     = basic_float32<8, 23, 127>;
+using tfloat32    = basic_float<8, 10, 127>; // 19 bits in std::uint32_t
+using float16     = basic_float<5, 10,  15>;
+using bfloat16    = basic_float<8,  7, 127>;
+using float8_e5m2 = basic_float<5,  2,  15>;
+using float8_e4m3 = basic_float<4,  3,   7>; // with inf and nan, as IEEE-754
+using float64     = basic_float<11, 52, 1023>; // in std::uint64_t
+
+constexpr float to_float(const float32 x) noexcept
 {
     return bit_cast<float>(x.base());
 }
 
-inline float32 to_flemu(const float x) noexcept
+constexpr float32 to_flemu(const float x) noexcept
 {
     return float32(bit_cast<std::uint32_t>(x));
 }
 
-#ifdef FLEMU_ACTIVATE_UNIT_TESTS
-inline boost::ut::suite tests_basic_float32 = []
+constexpr double to_double(const float64 x) noexcept
 {
-    using namespace boost::ut::literals;
-
-    "float32"_test = []
-    {
-        float32 x1(0b0'10000000'1101'1011'0110'1101'1011'011);
-
-        boost::ut::expect(x1.base() == 0b0'10000000'1101'1011'0110'1101'1011'011);
-
-        boost::ut::expect(x1.sign() == 0);
-        boost::ut::expect(x1.exponent() == 0b1000'0000);
-        boost::ut::expect(x1.mantissa() == 0b1101'1011'0110'1101'1011'011);
-
-        float32 x2(0b1'01111111'1101'1011'0110'1101'1011'011);
-
-        boost::ut::expect(x2.base() == 0b1'01111111'1101'1011'0110'1101'1011'011);
-
-        boost::ut::expect(x2.sign() == 1);
-        boost::ut::expect(x2.exponent() == 0b0111'1111);
-        boost::ut::expect(x2.mantissa() == 0b1101'1011'0110'1101'1011'011);
-
-        const float32 x3(0b0'10000000'1101'1011'0110'1101'1011'011);
-
-        boost::ut::expect(x3.base() == 0b0'10000000'1101'1011'0110'1101'1011'011);
-
-        boost::ut::expect(x3.sign() == 0);
-        boost::ut::expect(x3.exponent() == 0b1000'0000);
-        boost::ut::expect(x3.mantissa() == 0b1101'1011'0110'1101'1011'011);
-
-        const float32 x4(0b1'01111111'1101'1011'0110'1101'1011'011);
-
-        boost::ut::expect(x4.base() == 0b1'01111111'1101'1011'0110'1101'1011'011);
+    return bit_cast<double>(x.base());
+}
 
-        boost::ut::expect(x4.sign() == 1);
-        boost::ut::expect(x4.exponent() == 0b0111'1111);
-        boost::ut::expect(x4.mantissa() == 0b1101'1011'0110'1101'1011'011);
-    };
-};
-#endif
+// not an overload of to_flemu, so that to_flemu(0.1) stays float32.
+constexpr float64 to_flemu64(const double x) noexcept
+{
+    return float64(bit_cast<std::uint64_t>(x));
+}
 
 } // flemu
 #endif// FLEMU_FLOAT32_HPP
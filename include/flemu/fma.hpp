@@ -0,0 +1,235 @@
+#ifndef FLEMU_FMA_HPP
+#define FLEMU_FMA_HPP
+
+#include "float32.hpp"
+#include "adder.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <span>
+
+namespace flemu
+{
+namespace detail
+{
+
+// value == man * 2^exp. the msb of man is at bit 61; bit 62 is left for the
+// carry-up by addition.
+struct wide_significand
+{
+    std::uint64_t man;
+    std::int32_t  exp;
+};
+
+constexpr wide_significand normalize_wide(const std::uint64_t man, const std::int32_t exp) noexcept
+{
+    assert(man != 0);
+    const std::int32_t shift = std::countl_zero(man) - 2;
+    return wide_significand{man << shift, exp - shift};
+}
+
+// rounds man * 2^exp (man != 0) with the rounding mode, and reports the
+// exception flags to flg.
+template<typename Float, rounding_policy Rounding, flag_policy Flags>
+constexpr Float round_pack_wide(const Rounding& rnd, const Flags& flg, const std::uint32_t sgn,
+                      const std::uint64_t man, const std::int32_t exp) noexcept
+{
+    using base_type = typename Float::base_type;
+    using traits    = add_traits<Float, Rounding>;
+    using work_type = typename traits::work_type;
+
+    assert(man != 0);
+    const std::int32_t msb = 63 - std::countl_zero(man);
+
+    // biased exponent of the result if it is normalized. if it goes below the
+    // denormal boundary, the mantissa is shifted more and the exponent stays 1.
+    const std::int32_t zexp  = msb + exp + std::int32_t(Float::exponent_bias);
+    const std::int32_t shift = (msb - std::int32_t(traits::implicit_bit)) + std::max(0, 1 - zexp);
+
+    const work_type zman = (shift >= 0) ?
+        static_cast<work_type>(shift_right_sticky(man, static_cast<std::uint64_t>(shift))) :
+        static_cast<work_type>(man << -shift);
+
+    if constexpr(Flags::enabled)
+    {
+        flg.raise(rounding_flags<Float>(rnd, work_type(sgn), static_cast<work_type>(std::max(zexp, 1)), zman));
+    }
+    return Float(base_type(pack_rounded<Float>(rnd, work_type(sgn),
+                           static_cast<work_type>(std::max(zexp, 1)), zman)));
+}
+
+// fma without the recorder hook.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags>
+constexpr basic_float<E, M, B, S> fma_unrecorded(const basic_float<E, M, B, S>& a,
+                            const basic_float<E, M, B, S>& b,
+                            const basic_float<E, M, B, S>& c, const Rounding& rnd,
+                            const Flags& flg) noexcept
+{
+    using float_type = basic_float<E, M, B, S>;
+    using base_type  = typename float_type::base_type;
+
+    static_assert(2 * (M + 1) + 3 <= 61, "the product should fit in the wide register");
+    static_assert(M + Rounding::extra_bits <= 61, "the result should fit in the wide register");
+
+    constexpr std::uint32_t exponent_max = float_type::exponent_max;
+    constexpr std::int32_t  scale        = std::int32_t(B + M);
+
+    const std::uint32_t asgn = base_type(a.sign());
+    const std::uint32_t aexp = base_type(a.exponent());
+    const std::uint32_t aman = base_type(a.mantissa());
+
+    const std::uint32_t bsgn = base_type(b.sign());
+    const std::uint32_t bexp = base_type(b.exponent());
+    const std::uint32_t bman = base_type(b.mantissa());
+
+    const std::uint32_t csgn = base_type(c.sign());
+    const std::uint32_t cexp = base_type(c.exponent());
+    const std::uint32_t cman = base_type(c.mantissa());
+
+    const std::uint32_t psgn = asgn ^ bsgn;
+
+    // ------------------------------------------------------------------------
+    // check special values
+
+    const auto ainf  = (aexp == exponent_max) && (aman == 0);
+    const auto binf  = (bexp == exponent_max) && (bman == 0);
+    const auto cinf  = (cexp == exponent_max) && (cman == 0);
+    const auto anan  = (aexp == exponent_max) && (aman != 0);
+    const auto bnan  = (bexp == exponent_max) && (bman != 0);
+    const auto cnan  = (cexp == exponent_max) && (cman != 0);
+    const auto azero = (aexp == 0) && (aman == 0);
+    const auto bzero = (bexp == 0) && (bman == 0);
+    const auto czero = (cexp == 0) && (cman == 0);
+
+    if(anan || bnan || cnan || (ainf && bzero) || (azero && binf))
+    {
+        if(!(anan || bnan || cnan)) // inf * 0 == nan
+        {
+            flg.raise(flag_invalid);
+        }
+        return float_type(0b0, exponent_max, 0b1);
+    }
+    else if(ainf || binf)
+    {
+        if(cinf && csgn != psgn) // inf - inf == nan
+        {
+            flg.raise(flag_invalid);
+            return float_type(0b0, exponent_max, 0b1);
+        }
+        return float_type(psgn, exponent_max, 0b0);
+    }
+    else if(cinf)
+    {
+        return c;
+    }
+    else if(azero || bzero)
+    {
+        // the product is exactly (+-0). add knows how to handle the sign of 0.
+        return add_unrecorded(float_type(psgn, 0u, 0u), c, rnd, flg);
+    }
+
+    // ------------------------------------------------------------------------
+    // exact product. 24bit x 24bit -> 48bit in float32.
+    //
+    // a == (implicit|aman) * 2^(aexp - bias - mantissa_bits), same for b, c.
+    // denormalized numbers do not have the implicit 1 but have aexp == 1.
+
+    constexpr std::uint64_t implicit = std::uint64_t(1) << M;
+    const std::uint64_t asig = (aexp == 0 ? 0u : implicit) + aman;
+    const std::uint64_t bsig = (bexp == 0 ? 0u : implicit) + bman;
+    const std::uint64_t csig = (cexp == 0 ? 0u : implicit) + cman;
+
+    const auto p = normalize_wide(asig * bsig,
+        std::int32_t(std::max(aexp, 1u)) + std::int32_t(std::max(bexp, 1u)) - 2 * scale);
+
+    if(czero)
+    {
+        return round_pack_wide<float_type>(rnd, flg, psgn, p.man, p.exp);
+    }
+    const auto q = normalize_wide(csig, std::int32_t(std::max(cexp, 1u)) - scale);
+
+    // ------------------------------------------------------------------------
+    // align the smaller one to the larger one and add/sub
+
+    const bool p_is_larger = (p.exp > q.exp) || (p.exp == q.exp && p.man >= q.man);
+    const auto& x = p_is_larger ? q : p;  // smaller
+    const auto& y = p_is_larger ? p : q;  // larger
+    const std::uint32_t xsgn = p_is_larger ? csgn : psgn;
+    const std::uint32_t ysgn = p_is_larger ? psgn : csgn;
+
+    const std::uint64_t xman_aligned = shift_right_sticky(x.man,
+            static_cast<std::uint64_t>(y.exp - x.exp));
+
+    const std::uint64_t zman = (xsgn == ysgn) ? y.man + xman_aligned : y.man - xman_aligned;
+    if(zman == 0)
+    {
+        // x - x is (-0) in negative-inf-rounding and (+0) otherwise.
+        return float_type(Rounding::exact_zero_sign(xsgn, ysgn), 0u, 0u);
+    }
+    return round_pack_wide<float_type>(rnd, flg, ysgn, zman, y.exp);
+}
+
+} // detail
+
+// a * b + c with a single rounding by the rounding mode.
+//
+// The product of (1 + Mantissa)-bit significands is kept exactly in a 64-bit
+// register, and c is aligned to it (or it to c) by the same sticky shift as
+// add. Since the product and c are normalized to bit 61, there are
+// 61 - Mantissa bits (38 in float32) below the last bit of the result, so
+// only one sticky bit is needed to round correctly.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S,
+         rounding_policy Rounding, flag_policy Flags>
+constexpr basic_float<E, M, B, S> fma(const basic_float<E, M, B, S>& a, const basic_float<E, M, B, S>& b,
+                            const basic_float<E, M, B, S>& c, const Rounding& rnd,
+                            const Flags& flg) noexcept
+{
+    const auto z = detail::fma_unrecorded(a, b, c, rnd, flg);
+#ifdef FLEMU_ENABLE_RECORDER
+    if(!std::is_constant_evaluated())
+    {
+        recorder::record_op<basic_float<E, M, B, S>, Rounding>(recorder::opcode::fma, a, b, c, z);
+    }
+#endif
+    return z;
+}
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S, rounding_policy Rounding>
+constexpr basic_float<E, M, B, S> fma(const basic_float<E, M, B, S>& a, const basic_float<E, M, B, S>& b,
+                            const basic_float<E, M, B, S>& c, const Rounding& rnd) noexcept
+{
+    return fma(a, b, c, rnd, flags::ignore{});
+}
+
+// a * b + c with nearest-(even)-rounding.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr basic_float<E, M, B, S> fma(const basic_float<E, M, B, S>& a, const basic_float<E, M, B, S>& b,
+                            const basic_float<E, M, B, S>& c) noexcept
+{
+    return fma(a, b, c, rounding::nearest_even{});
+}
+
+// z[i] = fma(a[i], b[i], c[i])
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr void fma(std::span<const basic_float<E, M, B, S>> a, std::span<const basic_float<E, M, B, S>> b,
+         std::span<const basic_float<E, M, B, S>> c, std::span<basic_float<E, M, B, S>> z) noexcept
+{
+    assert(a.size() == z.size() && b.size() == z.size() && c.size() == z.size());
+    for(std::size_t i=0; i<z.size(); ++i)
+    {
+        z[i] = fma(a[i], b[i], c[i]);
+    }
+}
+
+inline void fma(std::span<const float32> a, std::span<const float32> b,
+                std::span<const float32> c, std::span<float32> z) noexcept
+{
+    fma<8, 23, 127, std::uint32_t>(a, b, c, z);
+}
+
+} // flemu
+#endif // FLEMU_FMA_HPP
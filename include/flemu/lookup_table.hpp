@@ -0,0 +1,224 @@
+#ifndef FLEMU_LOOKUP_TABLE_HPP
+#define FLEMU_LOOKUP_TABLE_HPP
+
+#include "float32.hpp"
+#include "adder.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include <array>
+#include <span>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define FLEMU_LOOKUP_TABLE_X86 1
+#  include <immintrin.h>
+#endif
+
+namespace flemu
+{
+
+// Precomputed results of a binary operation for all 65536 pairs of an 8-bit
+// format. The result of op(x, y) is stored at (x.base() << 8) | y.base().
+//
+// The table is 64 KiB + 4 bytes; the last 4 bytes are padding so that the
+// vector kernels can gather 32-bit words at any byte offset.
+template<typename Float>
+struct binary_lookup_table
+{
+  public:
+
+    static_assert(sizeof(typename Float::base_type) == 1, "only for 8-bit formats");
+
+    using value_type = Float;
+    using base_type  = typename Float::base_type;
+
+    static constexpr std::size_t table_size = 256 * 256;
+
+  public:
+
+    template<typename Op>
+    constexpr explicit binary_lookup_table(Op&& op) noexcept
+      : table_{}
+    {
+        for(std::size_t x=0; x<256; ++x)
+        {
+            for(std::size_t y=0; y<256; ++y)
+            {
+                table_[(x << 8) | y] = op(Float(base_type(x)), Float(base_type(y))).base();
+            }
+        }
+        for(std::size_t i=table_size; i<table_.size(); ++i)
+        {
+            table_[i] = 0;
+        }
+    }
+
+    // returns true if all the entries are the same as op(x, y).
+    template<typename Op>
+    constexpr bool verify(Op&& op) const noexcept
+    {
+        for(std::size_t x=0; x<256; ++x)
+        {
+            for(std::size_t y=0; y<256; ++y)
+            {
+                if(table_[(x << 8) | y] != op(Float(base_type(x)), Float(base_type(y))).base())
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    constexpr Float operator()(const Float x, const Float y) const noexcept
+    {
+        return Float(table_[(std::size_t(x.base()) << 8) | y.base()]);
+    }
+
+    // z[i] = op(x[i], y[i])
+    void operator()(std::span<const Float> x, std::span<const Float> y, std::span<Float> z) const noexcept;
+
+    constexpr const std::uint8_t* data() const noexcept {return table_.data();}
+
+  private:
+
+    alignas(64) std::array<std::uint8_t, table_size + 4> table_;
+};
+
+namespace detail
+{
+
+using lookup_kernel_type = void (*)(const std::uint8_t*, const std::uint8_t*, const std::uint8_t*,
+                                    std::uint8_t*, std::size_t) noexcept;
+
+inline void lookup_kernel_scalar(const std::uint8_t* table, const std::uint8_t* x,
+        const std::uint8_t* y, std::uint8_t* z, const std::size_t n) noexcept
+{
+    for(std::size_t i=0; i<n; ++i)
+    {
+        z[i] = table[(std::size_t(x[i]) << 8) | y[i]];
+    }
+}
+
+#ifdef FLEMU_LOOKUP_TABLE_X86
+
+// gathers 32-bit words at byte offsets (x << 8 | y) and keeps the lowest byte.
+__attribute__((target("avx2")))
+inline void lookup_kernel_avx2(const std::uint8_t* table, const std::uint8_t* x,
+        const std::uint8_t* y, std::uint8_t* z, const std::size_t n) noexcept
+{
+    // collect the lowest bytes of each 32-bit lane into the lowest 4 bytes of
+    // each 128-bit lane, then bring the two 128-bit lanes together.
+    const __m256i lowest_bytes = _mm256_setr_epi8(
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i combine = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m256i xi = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(x + i)));
+        const __m256i yi = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i)));
+        const __m256i idx = _mm256_or_si256(_mm256_slli_epi32(xi, 8), yi);
+        const __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), idx, 1);
+        const __m256i r = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, lowest_bytes), combine);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(z + i), _mm256_castsi256_si128(r));
+    }
+    lookup_kernel_scalar(table, x + i, y + i, z + i, n - i);
+}
+
+// gcc warns that _mm512_undefined_epi32() in the intrinsics is uninitialized.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+inline void lookup_kernel_avx512(const std::uint8_t* table, const std::uint8_t* x,
+        const std::uint8_t* y, std::uint8_t* z, const std::size_t n) noexcept
+{
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+        const __m512i xi = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+        const __m512i yi = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+        const __m512i idx = _mm512_or_si512(_mm512_slli_epi32(xi, 8), yi);
+        const __m512i v = _mm512_i32gather_epi32(idx, table, 1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(z + i), _mm512_cvtepi32_epi8(v));
+    }
+    lookup_kernel_scalar(table, x + i, y + i, z + i, n - i);
+}
+
+#pragma GCC diagnostic pop
+
+#endif // FLEMU_LOOKUP_TABLE_X86
+
+inline lookup_kernel_type select_lookup_kernel() noexcept
+{
+#ifdef FLEMU_LOOKUP_TABLE_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+    {
+        return &lookup_kernel_avx512;
+    }
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return &lookup_kernel_avx2;
+    }
+#endif
+    return &lookup_kernel_scalar;
+}
+
+} // detail
+
+template<typename Float>
+void binary_lookup_table<Float>::operator()(std::span<const Float> x, std::span<const Float> y,
+                                            std::span<Float> z) const noexcept
+{
+    static_assert(sizeof(Float) == sizeof(std::uint8_t));
+    assert(x.size() == z.size() && y.size() == z.size());
+
+    static const detail::lookup_kernel_type kernel = detail::select_lookup_kernel();
+    kernel(table_.data(), reinterpret_cast<const std::uint8_t*>(x.data()),
+           reinterpret_cast<const std::uint8_t*>(y.data()),
+           reinterpret_cast<std::uint8_t*>(z.data()), z.size());
+}
+
+// table-driven versions of the operations, with the same interface as the
+// computed ones. the tables are generated from the generic implementation at
+// the first call.
+//
+// with FLEMU_CONSTEXPR_LOOKUP_TABLES, the compiler generates them instead and
+// they cost nothing at startup. it takes several seconds per format, and g++
+// needs e.g. -fconstexpr-ops-limit=4294967296 to evaluate 65536 additions.
+namespace lut
+{
+
+template<typename Float>
+const binary_lookup_table<Float>& add_table()
+{
+#ifdef FLEMU_CONSTEXPR_LOOKUP_TABLES
+    static constexpr binary_lookup_table<Float> table(
+        [](const Float x, const Float y) {return flemu::add(x, y);});
+#else
+    static const binary_lookup_table<Float> table(
+        [](const Float x, const Float y) {return flemu::add(x, y);});
+#endif
+    return table;
+}
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+basic_float<E, M, B, S> add(const basic_float<E, M, B, S>& x, const basic_float<E, M, B, S>& y) noexcept
+{
+    return add_table<basic_float<E, M, B, S>>()(x, y);
+}
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+void add(std::span<const basic_float<E, M, B, S>> x, std::span<const basic_float<E, M, B, S>> y,
+         std::span<basic_float<E, M, B, S>> z) noexcept
+{
+    add_table<basic_float<E, M, B, S>>()(x, y, z);
+}
+
+} // lut
+} // flemu
+#endif // FLEMU_LOOKUP_TABLE_HPP
@@ -0,0 +1,108 @@
+#ifndef FLEMU_OPERATION_TRACE_HPP
+#define FLEMU_OPERATION_TRACE_HPP
+
+#include "utility.hpp"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <ostream>
+
+namespace flemu
+{
+
+// The last `Capacity` operations of a test loop, kept as raw bits in a ring
+// buffer. Recording one is a few stores; nothing is formatted until the trace
+// is written to a stream, which an expectation only does when it fails.
+//
+//   operation_trace<std::uint32_t, 2> trace("add");
+//   for(...)
+//   {
+//       trace.record({x, y}, z, zr);
+//       boost::ut::expect(z == zr) << trace;
+//   }
+//
+// prints, on a failure,
+//
+//   last 2 of 1234 add:
+//     add(0011'..., 0100'...) = 0100'..., expected 0100'...
+//     add(1011'..., 0100'...) = 0100'..., expected 0011'... <-
+//
+// where the entries whose result differs from the expected one are marked.
+template<std::unsigned_integral UInt, std::size_t Arity, std::size_t Capacity = 8>
+class operation_trace
+{
+  public:
+
+    static_assert(Capacity != 0);
+
+    using base_type = UInt;
+
+    struct entry
+    {
+        std::array<base_type, Arity> operands;
+        base_type result;
+        base_type expected;
+    };
+
+  public:
+
+    explicit constexpr operation_trace(const char* name) noexcept
+      : name_(name), count_(0), entries_{}
+    {}
+
+    constexpr void record(const std::array<base_type, Arity>& operands,
+                          const base_type result, const base_type expected) noexcept
+    {
+        entries_[count_ % Capacity] = entry{operands, result, expected};
+        ++count_;
+    }
+
+    constexpr void clear() noexcept {count_ = 0;}
+
+    // the number of the entries kept, and the number of the recorded ones.
+    constexpr std::size_t   size()  const noexcept {return std::min<std::uint64_t>(count_, Capacity);}
+    constexpr std::uint64_t count() const noexcept {return count_;}
+
+    // the i-th oldest entry that is kept.
+    constexpr const entry& operator[](const std::size_t i) const noexcept
+    {
+        return entries_[(count_ - size() + i) % Capacity];
+    }
+
+    constexpr const char* name() const noexcept {return name_;}
+
+  private:
+
+    const char*                    name_;
+    std::uint64_t                  count_;
+    std::array<entry, Capacity>    entries_;
+};
+
+template<typename charT, typename traits, std::unsigned_integral UInt, std::size_t A, std::size_t C>
+std::basic_ostream<charT, traits>&
+operator<<(std::basic_ostream<charT, traits>& os, const operation_trace<UInt, A, C>& trace)
+{
+    os << "last " << trace.size() << " of " << trace.count() << ' ' << trace.name() << ":\n";
+    for(std::size_t i=0; i<trace.size(); ++i)
+    {
+        const auto& e = trace[i];
+        os << "  " << trace.name() << '(';
+        for(std::size_t j=0; j<A; ++j)
+        {
+            os << (j == 0 ? "" : ", ") << format_bits(e.operands[j]);
+        }
+        os << ") = " << format_bits(e.result) << ", expected " << format_bits(e.expected);
+        if(e.result != e.expected)
+        {
+            os << " <-";
+        }
+        os << '\n';
+    }
+    return os;
+}
+
+} // flemu
+#endif // FLEMU_OPERATION_TRACE_HPP
@@ -0,0 +1,168 @@
+#ifndef FLEMU_QUANTIZE_HPP
+#define FLEMU_QUANTIZE_HPP
+
+#include "float32.hpp"
+#include "batch_convert.hpp"
+#include "convert.hpp"
+#include "work_stealing.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace flemu
+{
+
+// the error of quantizing float32 values to a narrower format.
+//
+//   - count     : finite inputs that stayed finite; the errors are of them
+//   - nonfinite : inf and nan inputs
+//   - overflows : finite inputs that became inf
+//   - max_ulp   : max |q - x| in the ulps of the format at x
+//   - rms()     : sqrt(mean((q - x)^2))
+struct quantization_stats
+{
+    std::uint64_t count     = 0;
+    std::uint64_t nonfinite = 0;
+    std::uint64_t overflows = 0;
+    double        max_ulp   = 0.0;
+    double        sum_squared_error = 0.0;
+
+    double rms() const noexcept
+    {
+        return count == 0 ? 0.0 : std::sqrt(sum_squared_error / static_cast<double>(count));
+    }
+
+    void merge(const quantization_stats& other) noexcept
+    {
+        count     += other.count;
+        nonfinite += other.nonfinite;
+        overflows += other.overflows;
+        max_ulp    = std::max(max_ulp, other.max_ulp);
+        sum_squared_error += other.sum_squared_error;
+    }
+};
+
+namespace detail
+{
+
+// the number of elements that a worker converts at once.
+inline constexpr std::size_t quantize_chunk_size = std::size_t(1) << 16;
+
+// one chunk of quantize. `first` is the index of x[0] in the whole input, so
+// that rnd.for_element sees the same index on any thread.
+template<typename To, typename Out, rounding_policy Rounding>
+quantization_stats quantize_chunk(std::span<const float32> x, std::span<Out> out,
+                                  const Rounding& rnd, const std::uint64_t first) noexcept
+{
+    // the exponent of the smallest normal number of To. float32 has the same
+    // or a wider range than all the formats, so the ulp of To at x is
+    // 2^(max(exponent of x, min_exponent) - mantissa_bits of To).
+    constexpr int min_exponent = 1 - int(To::exponent_bias);
+    static_assert(min_exponent >= -126);
+
+    // the chunk is converted in blocks by the span convert, which is
+    // vectorized for most of the formats and modes (see batch_convert.hpp),
+    // and the statistics are taken from the block.
+    constexpr std::size_t block = 1024;
+    std::array<To, block>      qs;
+    std::array<float32, block> ys;
+
+    quantization_stats stats;
+    for(std::size_t b=0; b<x.size(); b+=block)
+    {
+        const std::size_t n = std::min(block, x.size() - b);
+        const auto xb = x.subspan(b, n);
+        const std::span<To>      qb(qs.data(), n);
+        const std::span<float32> yb(ys.data(), n);
+        convert(xb, qb, rnd.for_element(first + b));
+        convert(std::span<const To>(qb), yb);
+        if constexpr(std::is_same_v<Out, float32>)
+        {
+            std::copy(yb.begin(), yb.end(), out.begin() + b);
+        }
+        else
+        {
+            std::copy(qb.begin(), qb.end(), out.begin() + b);
+        }
+
+        for(std::size_t i=0; i<n; ++i)
+        {
+            // the statistics use the exponent bits; std::ilogb and std::ldexp
+            // cost more than the conversions.
+            const int xexp = int(std::uint32_t(xb[i].exponent()));
+            const int yexp = int(std::uint32_t(yb[i].exponent()));
+            if(xexp == 255)
+            {
+                stats.nonfinite += 1;
+            }
+            else if(yexp == 255)
+            {
+                stats.overflows += 1;
+            }
+            else
+            {
+                const double err = static_cast<double>(to_float(yb[i])) - static_cast<double>(to_float(xb[i]));
+                const int    exp = std::max(xexp - 127, min_exponent);
+                const double inv_ulp = bit_cast<double>(std::uint64_t(1023 + int(To::mantissa_bits) - exp) << 52);
+                stats.count += 1;
+                stats.max_ulp = std::max(stats.max_ulp, std::abs(err) * inv_ulp);
+                stats.sum_squared_error += err * err;
+            }
+        }
+    }
+    return stats;
+}
+
+} // detail
+
+// Quantizes float32 values to the format To on `num_threads` threads and
+// returns the error statistics.
+//
+// out[i] is the quantized value, either as To, or converted back to float32
+// (Out == float32) to be read by code that does not know To. out may be the
+// memory mapping of the output file; nothing else is allocated per element.
+// element i is rounded by rnd.for_element(i), so the result, the stats
+// included, does not depend on the number of threads.
+template<typename To, typename Out, rounding_policy Rounding>
+quantization_stats quantize(std::span<const float32> x, std::span<Out> out, const Rounding& rnd,
+                            const std::size_t num_threads = default_concurrency())
+{
+    static_assert(std::is_same_v<Out, To> || std::is_same_v<Out, float32>);
+    assert(x.size() == out.size());
+
+    constexpr std::size_t chunk = detail::quantize_chunk_size;
+    const std::size_t num_chunks = (x.size() + chunk - 1) / chunk;
+
+    std::vector<quantization_stats> partial(num_chunks);
+    parallel_for(num_chunks, std::min(num_threads, std::max<std::size_t>(num_chunks, 1)),
+        [&](const std::size_t c, const std::size_t) {
+            const std::size_t first = c * chunk;
+            const std::size_t n     = std::min(chunk, x.size() - first);
+            partial[c] = detail::quantize_chunk<To>(x.subspan(first, n), out.subspan(first, n), rnd, first);
+        });
+
+    // merged in order, so the sum of the squares is the same for any threads
+    quantization_stats stats;
+    for(const auto& p : partial)
+    {
+        stats.merge(p);
+    }
+    return stats;
+}
+
+template<typename To, typename Out>
+quantization_stats quantize(std::span<const float32> x, std::span<Out> out,
+                            const std::size_t num_threads = default_concurrency())
+{
+    return quantize<To>(x, out, rounding::nearest_even{}, num_threads);
+}
+
+} // flemu
+#endif // FLEMU_QUANTIZE_HPP
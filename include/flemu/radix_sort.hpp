@@ -0,0 +1,257 @@
+#ifndef FLEMU_RADIX_SORT_HPP
+#define FLEMU_RADIX_SORT_HPP
+
+#include "float32.hpp"
+#include "total_order.hpp"
+#include "work_stealing.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace flemu
+{
+
+// Sorting, top-k and histograms of basic_float in totalOrder (see
+// total_order.hpp), in O(n) on the keys. The input is split into chunks that
+// the threads count and move in parallel; the result does not depend on the
+// number of threads.
+
+namespace detail
+{
+
+// a digit of the key, 8 bits.
+inline constexpr std::size_t radix_bits = 8;
+inline constexpr std::size_t radix_size = std::size_t(1) << radix_bits;
+
+using radix_histogram = std::array<std::size_t, radix_size>;
+
+// the number of elements that a task counts or moves at once.
+inline constexpr std::size_t radix_chunk_size = std::size_t(1) << 16;
+
+// the inputs that are smaller than this are sorted on the calling thread.
+inline constexpr std::size_t parallel_sort_threshold = std::size_t(1) << 17;
+
+template<typename Float>
+inline constexpr std::size_t key_bits = Float::sign_bit + 1;
+
+template<typename Float>
+inline constexpr std::size_t radix_passes = (key_bits<Float> + radix_bits - 1) / radix_bits;
+
+// the digit of x at `shift`. the key is widened first, so that the shift of
+// the top digit of a 32-bit key is well-defined.
+template<typename Float>
+constexpr std::size_t radix_digit(const Float& x, const std::size_t shift) noexcept
+{
+    return static_cast<std::size_t>((std::uint64_t(total_order_key(x)) >> shift) & (radix_size - 1));
+}
+
+inline std::size_t radix_workers(const std::size_t n, const std::size_t num_chunks,
+                                 const std::size_t num_threads) noexcept
+{
+    return (n < parallel_sort_threshold) ? 1 : std::max<std::size_t>(1, std::min(num_threads, num_chunks));
+}
+
+} // detail
+
+// sorts x in totalOrder, ascending.
+//
+// LSD radix sort on total_order_key, 8 bits per pass. each pass counts the
+// digits of each chunk in parallel, takes the prefix sums in the order of
+// (digit, chunk), and moves each chunk to its positions in parallel, so it is
+// stable. a pass is skipped if all the keys have the same digit there. it
+// allocates a buffer of x.size() elements.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+void radix_sort(std::span<basic_float<E, M, B, S>> x, const std::size_t num_threads = default_concurrency())
+{
+    using float_type = basic_float<E, M, B, S>;
+    constexpr std::size_t chunk = detail::radix_chunk_size;
+
+    const std::size_t n = x.size();
+    if(n < 2)
+    {
+        return;
+    }
+    const std::size_t num_chunks = (n + chunk - 1) / chunk;
+    const std::size_t workers    = detail::radix_workers(n, num_chunks, num_threads);
+
+    std::vector<float_type> buf(n);
+    std::vector<detail::radix_histogram> counts(num_chunks);
+    std::span<float_type> src = x;
+    std::span<float_type> dst(buf);
+
+    for(std::size_t pass=0; pass<detail::radix_passes<float_type>; ++pass)
+    {
+        const std::size_t shift = pass * detail::radix_bits;
+        parallel_for(num_chunks, workers, [&](const std::size_t c, const std::size_t) {
+            auto& h = counts[c];
+            h.fill(0);
+            for(const auto& v : src.subspan(c * chunk, std::min(chunk, n - c * chunk)))
+            {
+                h[detail::radix_digit(v, shift)] += 1;
+            }
+        });
+
+        // counts[c][d] becomes the position of the first element of chunk c
+        // that has digit d.
+        std::size_t offset = 0;
+        bool same_digit = false;
+        for(std::size_t d=0; d<detail::radix_size; ++d)
+        {
+            const std::size_t first = offset;
+            for(auto& h : counts)
+            {
+                const std::size_t count = h[d];
+                h[d] = offset;
+                offset += count;
+            }
+            same_digit = same_digit || (offset - first == n);
+        }
+        if(same_digit)
+        {
+            continue;
+        }
+
+        parallel_for(num_chunks, workers, [&](const std::size_t c, const std::size_t) {
+            auto& position = counts[c];
+            for(const auto& v : src.subspan(c * chunk, std::min(chunk, n - c * chunk)))
+            {
+                dst[position[detail::radix_digit(v, shift)]++] = v;
+            }
+        });
+        std::swap(src, dst);
+    }
+    if(src.data() != x.data())
+    {
+        std::copy(src.begin(), src.end(), x.begin());
+    }
+}
+
+// the k largest elements of x in totalOrder, the largest first. if k >
+// x.size(), all of them.
+//
+// it finds the key of the k-th largest element digit by digit, from the top
+// (radix select): each pass counts the digits of the keys that have the
+// digits found so far, which is one parallel scan of x. then it collects the
+// larger ones and sorts them. elements with the same key are the same
+// encoding, so the result does not depend on which of them are taken.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+std::vector<basic_float<E, M, B, S>> top_k(std::span<const basic_float<E, M, B, S>> x, std::size_t k,
+                                           const std::size_t num_threads = default_concurrency())
+{
+    using float_type = basic_float<E, M, B, S>;
+    constexpr std::size_t chunk  = detail::radix_chunk_size;
+    constexpr std::size_t passes = detail::radix_passes<float_type>;
+
+    const std::size_t n = x.size();
+    k = std::min(k, n);
+    if(k == 0)
+    {
+        return {};
+    }
+    const std::size_t num_chunks = (n + chunk - 1) / chunk;
+    const std::size_t workers    = detail::radix_workers(n, num_chunks, num_threads);
+
+    // `remaining` of the k are the keys that start with `prefix`.
+    std::uint64_t prefix    = 0;
+    std::size_t   remaining = k;
+    std::vector<detail::radix_histogram> counts(workers);
+    for(std::size_t pass=0; pass<passes; ++pass)
+    {
+        const std::size_t shift = (passes - 1 - pass) * detail::radix_bits;
+        for(auto& h : counts) {h.fill(0);}
+        parallel_for(num_chunks, workers, [&](const std::size_t c, const std::size_t w) {
+            auto& h = counts[w];
+            for(const auto& v : x.subspan(c * chunk, std::min(chunk, n - c * chunk)))
+            {
+                const std::uint64_t key = total_order_key(v);
+                if((key >> shift >> detail::radix_bits) == prefix)
+                {
+                    h[(key >> shift) & (detail::radix_size - 1)] += 1;
+                }
+            }
+        });
+
+        for(std::size_t d=detail::radix_size; d-- > 0; )
+        {
+            std::size_t count = 0;
+            for(const auto& h : counts) {count += h[d];}
+            if(count >= remaining)
+            {
+                prefix = (prefix << detail::radix_bits) | d;
+                break;
+            }
+            remaining -= count;
+        }
+    }
+
+    // the k - remaining keys above the k-th one, and `remaining` copies of it
+    std::vector<std::vector<float_type>> larger(num_chunks);
+    parallel_for(num_chunks, workers, [&](const std::size_t c, const std::size_t) {
+        for(const auto& v : x.subspan(c * chunk, std::min(chunk, n - c * chunk)))
+        {
+            if(total_order_key(v) > prefix)
+            {
+                larger[c].push_back(v);
+            }
+        }
+    });
+    std::vector<float_type> result;
+    result.reserve(k);
+    for(const auto& l : larger)
+    {
+        result.insert(result.end(), l.begin(), l.end());
+    }
+    assert(result.size() == k - remaining);
+
+    radix_sort(std::span<float_type>(result), workers);
+    std::reverse(result.begin(), result.end());
+    result.insert(result.end(), remaining,
+                  from_total_order_key<float_type>(static_cast<typename float_type::base_type>(prefix)));
+    return result;
+}
+
+// the number of the elements of x in each of the 2^bits ranges of totalOrder
+// that share the leading `bits` bits of the key, from -nan to +nan. e.g. with
+// bits == 1 + exponent_bits, the bins are the binades of each sign, the
+// denormals and zero of each sign, and inf and nan of each sign.
+//
+// each thread counts into its own bins, and the bins are summed up.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+std::vector<std::uint64_t> key_histogram(std::span<const basic_float<E, M, B, S>> x, const std::size_t bits,
+                                         const std::size_t num_threads = default_concurrency())
+{
+    using float_type = basic_float<E, M, B, S>;
+    constexpr std::size_t chunk = detail::radix_chunk_size;
+    assert(1 <= bits && bits <= std::min<std::size_t>(detail::key_bits<float_type>, 20));
+
+    const std::size_t n          = x.size();
+    const std::size_t shift      = detail::key_bits<float_type> - bits;
+    const std::size_t num_chunks = (n + chunk - 1) / chunk;
+    const std::size_t workers    = detail::radix_workers(n, num_chunks, num_threads);
+
+    std::vector<std::vector<std::uint64_t>> local(workers, std::vector<std::uint64_t>(std::size_t(1) << bits));
+    parallel_for(num_chunks, workers, [&](const std::size_t c, const std::size_t w) {
+        auto& h = local[w];
+        for(const auto& v : x.subspan(c * chunk, std::min(chunk, n - c * chunk)))
+        {
+            h[std::uint64_t(total_order_key(v)) >> shift] += 1;
+        }
+    });
+    for(std::size_t w=1; w<workers; ++w)
+    {
+        for(std::size_t i=0; i<local[0].size(); ++i)
+        {
+            local[0][i] += local[w][i];
+        }
+    }
+    return std::move(local[0]);
+}
+
+} // flemu
+#endif // FLEMU_RADIX_SORT_HPP
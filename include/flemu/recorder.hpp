@@ -0,0 +1,275 @@
+#ifndef FLEMU_RECORDER_HPP
+#define FLEMU_RECORDER_HPP
+
+#include "float32.hpp"
+#include "rounding.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+namespace flemu
+{
+
+// Records the operations to a binary file, to replay them later (see
+// src/replay.cpp). Each operation is written as a fixed-size record of raw
+// bits:
+//
+//   file:    | header (16 bytes) | record | record | ...
+//   header:  | "flemurec" | version (u32) | sizeof(record) (u32) |
+//   record:  | op (u8) | rounding (u8) | format (u16) | a | b | c | result |
+//
+// where a, b, c and result are the bits of the operands and the result,
+// zero-extended to u32. unused operands (c of add) are 0. the records are in
+// the byte order of the machine.
+//
+// The hooks in add and fma are compiled only with -DFLEMU_ENABLE_RECORDER;
+// without it, nothing of this file is called. With it, an operation costs a
+// relaxed load while the recorder is stopped, and a store to the buffer of the
+// thread while it is running. a buffer is written to the file in one fwrite
+// when it is full, when the thread exits, and by flush().
+//
+//   flemu::recorder::start("ops.bin");
+//   ... // add, fma, on any thread
+//   flemu::recorder::stop();
+//
+// a thread that is still running should call flush() before stop(); the
+// records left in its buffer are dropped otherwise. each start() and stop()
+// begins a new session, and a buffer that holds the records of an older
+// session discards them instead of writing them to the file of a new one.
+namespace recorder
+{
+
+enum class opcode : std::uint8_t
+{
+    add = 1,
+    fma = 2,
+};
+
+// the rounding modes that can be replayed. stochastic rounding depends on the
+// state of the generator and is recorded as `other`.
+enum class rounding_id : std::uint8_t
+{
+    nearest_even    = 0,
+    toward_zero     = 1,
+    toward_positive = 2,
+    toward_negative = 3,
+    other           = 255,
+};
+
+struct record
+{
+    opcode        op;
+    rounding_id   rounding;
+    std::uint16_t format;
+    std::uint32_t a;
+    std::uint32_t b;
+    std::uint32_t c;
+    std::uint32_t result;
+};
+static_assert(sizeof(record) == 20);
+
+struct file_header
+{
+    std::array<char, 8> magic   = {'f', 'l', 'e', 'm', 'u', 'r', 'e', 'c'};
+    std::uint32_t       version = 1;
+    std::uint32_t       record_size = sizeof(record);
+};
+static_assert(sizeof(file_header) == 16);
+
+// (Exponent << 8) | Mantissa. the bias is the IEEE one, 2^(Exponent-1) - 1,
+// for all the formats that can be recorded; the others have format 0.
+template<typename Float>
+inline constexpr std::uint16_t format_code = 0;
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+inline constexpr std::uint16_t format_code<basic_float<E, M, B, S>> =
+    (sizeof(S) <= 4 && E < 256 && M < 256 && B == (std::uint32_t(1) << (E - 1)) - 1) ?
+    std::uint16_t((E << 8) | M) : std::uint16_t(0);
+
+template<typename Rounding>
+inline constexpr rounding_id rounding_code = rounding_id::other;
+template<> inline constexpr rounding_id rounding_code<rounding::nearest_even>    = rounding_id::nearest_even;
+template<> inline constexpr rounding_id rounding_code<rounding::toward_zero>     = rounding_id::toward_zero;
+template<> inline constexpr rounding_id rounding_code<rounding::toward_positive> = rounding_id::toward_positive;
+template<> inline constexpr rounding_id rounding_code<rounding::toward_negative> = rounding_id::toward_negative;
+
+namespace detail
+{
+
+// the file shared by all the threads. it is constant-initialized, so the
+// hooks do not check a guard of a static local.
+struct sink
+{
+    std::mutex                 mutex;
+    std::FILE*                 file = nullptr;
+    std::atomic<bool>          running{false};
+    std::atomic<std::uint32_t> generation{0}; // incremented by start() and stop()
+};
+inline sink global_sink;
+
+// 4096 records (80 KiB) are written at once.
+inline constexpr std::size_t buffer_records = 4096;
+
+class thread_buffer
+{
+  public:
+
+    thread_buffer() = default;
+    thread_buffer(const thread_buffer&) = delete;
+    thread_buffer& operator=(const thread_buffer&) = delete;
+    ~thread_buffer() {flush();}
+
+    void push(const record& r) noexcept
+    {
+        // the records of an older session are dropped when a new one begins.
+        const std::uint32_t g = global_sink.generation.load(std::memory_order_relaxed);
+        if(size_ == 0 || generation_ != g)
+        {
+            size_       = 0;
+            generation_ = g;
+        }
+        records_[size_++] = r;
+        if(size_ == records_.size())
+        {
+            flush();
+        }
+    }
+
+    void flush() noexcept
+    {
+        if(size_ == 0)
+        {
+            return;
+        }
+        const std::lock_guard<std::mutex> lock(global_sink.mutex);
+        if(global_sink.file != nullptr &&
+           generation_ == global_sink.generation.load(std::memory_order_relaxed))
+        {
+            std::fwrite(records_.data(), sizeof(record), size_, global_sink.file);
+        }
+        size_ = 0;
+    }
+
+  private:
+
+    std::size_t                              size_ = 0;
+    std::uint32_t                            generation_ = 0; // of the records in the buffer
+    std::array<record, buffer_records>       records_;
+};
+
+inline thread_buffer& local_buffer() noexcept
+{
+    thread_local thread_buffer buffer;
+    return buffer;
+}
+
+} // detail
+
+inline bool running() noexcept
+{
+    return detail::global_sink.running.load(std::memory_order_relaxed);
+}
+
+// starts recording to `path`, overwriting it. false if it cannot be opened or
+// the recorder is already running.
+inline bool start(const std::filesystem::path& path)
+{
+    const std::lock_guard<std::mutex> lock(detail::global_sink.mutex);
+    if(detail::global_sink.file != nullptr)
+    {
+        return false;
+    }
+    std::FILE* fp = std::fopen(path.c_str(), "wb");
+    if(fp == nullptr)
+    {
+        return false;
+    }
+    // the buffers are already large; stdio would only copy them again.
+    std::setvbuf(fp, nullptr, _IONBF, 0);
+
+    const file_header header;
+    if(std::fwrite(&header, sizeof(header), 1, fp) != 1)
+    {
+        std::fclose(fp);
+        return false;
+    }
+    detail::global_sink.file = fp;
+    detail::global_sink.generation.fetch_add(1, std::memory_order_relaxed);
+    detail::global_sink.running.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+// writes the records of the calling thread to the file.
+inline void flush() noexcept
+{
+    detail::local_buffer().flush();
+}
+
+// flushes the calling thread and closes the file. the records that other
+// threads have not flushed yet are discarded.
+inline void stop() noexcept
+{
+    detail::global_sink.running.store(false, std::memory_order_relaxed);
+    flush();
+
+    const std::lock_guard<std::mutex> lock(detail::global_sink.mutex);
+    detail::global_sink.generation.fetch_add(1, std::memory_order_relaxed);
+    if(detail::global_sink.file != nullptr)
+    {
+        std::fclose(detail::global_sink.file);
+        detail::global_sink.file = nullptr;
+    }
+}
+
+// records an operation if the recorder is running. the hooks call this.
+template<typename Float, typename Rounding>
+inline void record_op(const opcode op, const Float& a, const Float& b, const Float& c,
+                      const Float& result) noexcept
+{
+    constexpr std::uint16_t format = format_code<Float>;
+    if constexpr(format != 0)
+    {
+        if(running())
+        {
+            detail::local_buffer().push(record{op, rounding_code<Rounding>, format,
+                std::uint32_t(a.base()), std::uint32_t(b.base()),
+                std::uint32_t(c.base()), std::uint32_t(result.base())});
+        }
+    }
+}
+
+// the records of a file read into memory. the replay tool maps the file
+// instead; this is for tests and small files. empty if the header is wrong.
+inline std::vector<record> read_records(const std::filesystem::path& path)
+{
+    std::vector<record> records;
+    std::FILE* fp = std::fopen(path.c_str(), "rb");
+    if(fp == nullptr)
+    {
+        return records;
+    }
+    file_header header;
+    const file_header expected;
+    if(std::fread(&header, sizeof(header), 1, fp) == 1 &&
+       std::memcmp(&header, &expected, sizeof(header)) == 0)
+    {
+        record r;
+        while(std::fread(&r, sizeof(r), 1, fp) == 1)
+        {
+            records.push_back(r);
+        }
+    }
+    std::fclose(fp);
+    return records;
+}
+
+} // recorder
+} // flemu
+#endif // FLEMU_RECORDER_HPP
@@ -0,0 +1,210 @@
+#ifndef FLEMU_REDUCE_HPP
+#define FLEMU_REDUCE_HPP
+
+#include "float32.hpp"
+#include "adder.hpp"
+#include "batch_adder.hpp"
+#include "unpacked_float.hpp"
+#include "work_stealing.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <vector>
+
+namespace flemu
+{
+
+// The order of the additions in reduce. Floating-point addition is not
+// associative, so the order is a part of the result. Each order is defined
+// only by the number of elements (and its parameters), never by the number of
+// threads or by which thread runs which part, so the result is bit-identical
+// for any number of threads.
+namespace reduction
+{
+
+// (((x0 + x1) + x2) + x3) + ...
+//
+// each addition depends on the previous one, so it runs on one thread
+// whatever the number of threads is.
+struct sequential
+{
+};
+
+// adds adjacent pairs, then adjacent pairs of the sums, and so on. an odd one
+// at the end of a level is carried up as it is.
+//
+//   x0  x1  x2  x3  x4  x5  x6
+//    \  /    \  /    \  /   |
+//    s01     s23     s45    x6
+//       \   /           \  /
+//       s0123          s456
+//            \        /
+//              result
+//
+// it is the same as splitting [0, n) at the largest power of 2 less than n
+// and adding the two sums recursively. the error grows as O(log n).
+struct pairwise
+{
+};
+
+// splits the input into blocks of `block_size` elements (the last one may be
+// shorter). in a block, `lanes` accumulators sum every `lanes`-th element
+//
+//   acc[j] = ((x[j] + x[j + lanes]) + x[j + 2 lanes]) + ...
+//
+// in the same way as SIMD lanes, and the accumulators are added pairwise.
+// the sums of the blocks are added pairwise, too.
+struct blocked_tree
+{
+    static constexpr std::size_t lanes = 64;
+
+    std::size_t block_size = std::size_t(1) << 14;
+};
+
+} // reduction
+
+namespace detail
+{
+
+// pairwise sum of v. v and tmp are overwritten. tmp.size() >= v.size().
+//
+// each level gathers the left and the right elements of the pairs into the
+// two halves of tmp and adds them with the batch add.
+template<typename Float>
+Float pairwise_sum_in_place(std::span<Float> v, std::span<Float> tmp) noexcept
+{
+    assert(tmp.size() >= v.size());
+    if(v.empty())
+    {
+        return Float(0u);
+    }
+    std::size_t n = v.size();
+    while(n > 1)
+    {
+        const std::size_t pairs = n / 2;
+        for(std::size_t i=0; i<pairs; ++i)
+        {
+            tmp[i]         = v[2*i];
+            tmp[pairs + i] = v[2*i + 1];
+        }
+        add(std::span<const Float>(tmp.data(), pairs),
+            std::span<const Float>(tmp.data() + pairs, pairs), v.first(pairs));
+        if(n % 2 == 1)
+        {
+            v[pairs] = v[n - 1];
+        }
+        n = pairs + n % 2;
+    }
+    return v[0];
+}
+
+template<typename Float>
+Float pairwise_sum_in_place(std::span<Float> v)
+{
+    std::vector<Float> tmp(v.size());
+    return pairwise_sum_in_place(v, std::span<Float>(tmp));
+}
+
+// lane accumulators of a block of blocked_tree. buf.size() >= 2 * lanes.
+template<typename Float>
+Float blocked_sum(std::span<const Float> x, std::span<Float> buf) noexcept
+{
+    constexpr std::size_t lanes = reduction::blocked_tree::lanes;
+    assert(buf.size() >= 2 * lanes);
+
+    const std::size_t width = std::min(lanes, x.size());
+    const std::span<Float> acc = buf.first(width);
+    std::copy(x.begin(), x.begin() + width, acc.begin());
+    for(std::size_t i=width; i<x.size(); i+=lanes)
+    {
+        const std::size_t k = std::min(lanes, x.size() - i);
+        add(std::span<const Float>(acc.data(), k), x.subspan(i, k), acc.first(k));
+    }
+    return pairwise_sum_in_place(acc, buf.subspan(lanes));
+}
+
+// the pairwise sum of aligned 2^k elements is a subtree of the pairwise sum
+// of the whole, and so is the sum of the rest at the end (see reduction::pairwise).
+// so the chunks are summed in parallel and the sums are added pairwise again.
+inline constexpr std::size_t pairwise_chunk_size = 4096;
+
+// chunks that are smaller than this are summed on the calling thread.
+inline constexpr std::size_t parallel_reduce_threshold = std::size_t(1) << 16;
+
+} // detail
+
+// the sum of x in the order. the threads only change the speed, not the
+// result; see reduction. the sum of no element is (+0).
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+basic_float<E, M, B, S> reduce(std::span<const basic_float<E, M, B, S>> x,
+                               const reduction::sequential&,
+                               const std::size_t = default_concurrency()) noexcept
+{
+    using float_type = basic_float<E, M, B, S>;
+    if(x.empty())
+    {
+        return float_type(0u);
+    }
+    // the accumulator is not packed between the additions.
+    auto acc = unpack(x[0]);
+    for(std::size_t i=1; i<x.size(); ++i)
+    {
+        acc = add(acc, unpack(x[i]));
+    }
+    return pack(acc);
+}
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+basic_float<E, M, B, S> reduce(std::span<const basic_float<E, M, B, S>> x,
+                               const reduction::pairwise&,
+                               const std::size_t num_threads = default_concurrency())
+{
+    using float_type = basic_float<E, M, B, S>;
+    constexpr std::size_t chunk = detail::pairwise_chunk_size;
+    static_assert(std::has_single_bit(chunk));
+
+    const std::size_t num_chunks = (x.size() + chunk - 1) / chunk;
+    const std::size_t workers = (x.size() < detail::parallel_reduce_threshold) ? 1 :
+                                std::min(num_threads, num_chunks);
+
+    std::vector<float_type> partial(num_chunks);
+    std::vector<float_type> buf(std::max<std::size_t>(workers, 1) * 2 * chunk);
+    parallel_for(num_chunks, workers, [&](const std::size_t c, const std::size_t w) {
+        const auto src = x.subspan(c * chunk, std::min(chunk, x.size() - c * chunk));
+        const std::span<float_type> v(buf.data() + w * 2 * chunk, src.size());
+        const std::span<float_type> tmp(buf.data() + w * 2 * chunk + chunk, chunk);
+        std::copy(src.begin(), src.end(), v.begin());
+        partial[c] = detail::pairwise_sum_in_place(v, tmp);
+    });
+    return detail::pairwise_sum_in_place(std::span<float_type>(partial));
+}
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+basic_float<E, M, B, S> reduce(std::span<const basic_float<E, M, B, S>> x,
+                               const reduction::blocked_tree& order,
+                               const std::size_t num_threads = default_concurrency())
+{
+    using float_type = basic_float<E, M, B, S>;
+    constexpr std::size_t lanes = reduction::blocked_tree::lanes;
+    assert(order.block_size != 0);
+
+    const std::size_t block = order.block_size;
+    const std::size_t num_blocks = (x.size() + block - 1) / block;
+    const std::size_t workers = (x.size() < detail::parallel_reduce_threshold) ? 1 :
+                                std::min(num_threads, num_blocks);
+
+    std::vector<float_type> partial(num_blocks);
+    std::vector<float_type> buf(std::max<std::size_t>(workers, 1) * 2 * lanes);
+    parallel_for(num_blocks, workers, [&](const std::size_t b, const std::size_t w) {
+        const auto src = x.subspan(b * block, std::min(block, x.size() - b * block));
+        partial[b] = detail::blocked_sum(src, std::span<float_type>(buf.data() + w * 2 * lanes, 2 * lanes));
+    });
+    return detail::pairwise_sum_in_place(std::span<float_type>(partial));
+}
+
+} // flemu
+#endif // FLEMU_REDUCE_HPP
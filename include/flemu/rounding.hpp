@@ -0,0 +1,220 @@
+#ifndef FLEMU_ROUNDING_HPP
+#define FLEMU_ROUNDING_HPP
+
+#include <cstdint>
+
+#include <concepts>
+
+namespace flemu
+{
+
+// Rounding modes are passed to the operations as a policy object. The type of
+// the policy selects the code at compile time; there is no runtime switch.
+//
+// A policy decides whether the magnitude should be rounded up, given a
+// mantissa that has `extra_bits` additional bits below its last bit.
+//
+//   ...| lsb| extra bits ... |
+//
+// The lowest extra bit is sticky; it is 1 if any of the bits shifted out of
+// the register was 1.
+//
+// A policy has
+//   - extra_bits                  : number of bits kept below the last bit
+//   - round_up(sgn, man)          : 1 if the magnitude should be rounded up
+//   - overflow_to_max(sgn)        : 1 if an overflow becomes the max finite
+//   - exact_zero_sign(xsgn, ysgn) : sign of x + y when it is exactly zero
+//   - for_element(i)              : the policy for the i-th element of a batch
+namespace rounding
+{
+
+// nearest-(even)-rounding. it should be rounded up if G == 1 and
+// (R | S | lsb) == 1. this is the same as (GRS + lsb + 3) >> 3 because
+// GRS + lsb + 3 >= 8 iff GRS > 4 || (GRS == 4 && lsb == 1).
+struct nearest_even
+{
+    static constexpr std::size_t extra_bits = 3;
+
+    template<std::unsigned_integral UInt>
+    constexpr UInt round_up(const UInt, const UInt man) const noexcept
+    {
+        const UInt grs = man & 0b111;
+        const UInt lsb = (man >> 3) & 0b1;
+        return (grs + lsb + 3) >> 3;
+    }
+    template<std::unsigned_integral UInt>
+    static constexpr UInt overflow_to_max(const UInt) noexcept {return 0;}
+
+    // x + (-x) == (+0), (+0) + (-0) == (+0), (-0) + (-0) == (-0).
+    template<std::unsigned_integral UInt>
+    static constexpr UInt exact_zero_sign(const UInt xsgn, const UInt ysgn) noexcept
+    {
+        return xsgn & ysgn;
+    }
+    constexpr nearest_even for_element(const std::uint64_t) const noexcept {return *this;}
+};
+
+// truncation. it never rounds up, and an overflow stops at the max finite.
+struct toward_zero
+{
+    static constexpr std::size_t extra_bits = 3;
+
+    template<std::unsigned_integral UInt>
+    constexpr UInt round_up(const UInt, const UInt) const noexcept {return 0;}
+
+    template<std::unsigned_integral UInt>
+    static constexpr UInt overflow_to_max(const UInt) noexcept {return 1;}
+
+    template<std::unsigned_integral UInt>
+    static constexpr UInt exact_zero_sign(const UInt xsgn, const UInt ysgn) noexcept
+    {
+        return xsgn & ysgn;
+    }
+    constexpr toward_zero for_element(const std::uint64_t) const noexcept {return *this;}
+};
+
+// rounds up the magnitude of positive numbers if any of GRS is 1.
+// a negative overflow stops at -max.
+struct toward_positive
+{
+    static constexpr std::size_t extra_bits = 3;
+
+    template<std::unsigned_integral UInt>
+    constexpr UInt round_up(const UInt sgn, const UInt man) const noexcept
+    {
+        return (((man & 0b111) + 0b111) >> 3) & (sgn ^ 1);
+    }
+    template<std::unsigned_integral UInt>
+    static constexpr UInt overflow_to_max(const UInt sgn) noexcept {return sgn;}
+
+    template<std::unsigned_integral UInt>
+    static constexpr UInt exact_zero_sign(const UInt xsgn, const UInt ysgn) noexcept
+    {
+        return xsgn & ysgn;
+    }
+    constexpr toward_positive for_element(const std::uint64_t) const noexcept {return *this;}
+};
+
+// rounds up the magnitude of negative numbers if any of GRS is 1.
+// a positive overflow stops at +max, and x + (-x) == (-0).
+struct toward_negative
+{
+    static constexpr std::size_t extra_bits = 3;
+
+    template<std::unsigned_integral UInt>
+    constexpr UInt round_up(const UInt sgn, const UInt man) const noexcept
+    {
+        return (((man & 0b111) + 0b111) >> 3) & sgn;
+    }
+    template<std::unsigned_integral UInt>
+    static constexpr UInt overflow_to_max(const UInt sgn) noexcept {return sgn ^ 1;}
+
+    template<std::unsigned_integral UInt>
+    static constexpr UInt exact_zero_sign(const UInt xsgn, const UInt ysgn) noexcept
+    {
+        return xsgn | ysgn;
+    }
+    constexpr toward_negative for_element(const std::uint64_t) const noexcept {return *this;}
+};
+
+// counter-based random bits. rng(counter) is a hash of (key, counter), so any
+// element of a batch can draw its bits without a shared state, and the
+// results do not depend on the order of evaluation. it uses only 32-bit
+// multiplications, xors and shifts, which map directly onto SIMD lanes.
+// it is not cryptographic.
+struct hash_rng
+{
+    std::uint32_t key = 0;
+
+    static constexpr std::uint32_t mix(std::uint32_t x) noexcept
+    {
+        x ^= x >> 16;
+        x *= 0x7FEB'352Du;
+        x ^= x >> 15;
+        x *= 0x846C'A68Bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    constexpr std::uint32_t operator()(const std::uint64_t counter) const noexcept
+    {
+        const std::uint32_t lo = static_cast<std::uint32_t>(counter);
+        const std::uint32_t hi = static_cast<std::uint32_t>(counter >> 32);
+        return mix(mix(lo ^ key) + hi + 0x9E37'79B9u);
+    }
+};
+
+template<typename RNG>
+concept counter_based_rng = requires(const RNG& rng, const std::uint64_t counter)
+{
+    {rng(counter)} -> std::convertible_to<std::uint32_t>;
+};
+
+// stochastic rounding. it rounds the magnitude up with the probability equal
+// to the fraction below the last bit, r / 2^RandomBits, by adding uniform
+// random bits to the extra bits and taking the carry.
+//
+// the random bits of the i-th element of a batch are rng(counter + i); the
+// caller advances the counter between calls.
+//
+// the fraction below the lowest extra bit is only kept as a sticky bit, so
+// the probability is off by at most 2^-RandomBits. an overflow becomes inf.
+template<counter_based_rng RNG, std::size_t RandomBits = 16>
+struct stochastic
+{
+    static_assert(3 <= RandomBits && RandomBits <= 32);
+    static constexpr std::size_t extra_bits = RandomBits;
+
+    RNG           rng;
+    std::uint64_t counter = 0;
+
+    template<std::unsigned_integral UInt>
+    constexpr UInt round_up(const UInt, const UInt man) const noexcept
+    {
+        const UInt rest = man & ((UInt(1) << RandomBits) - 1);
+        const UInt bits = static_cast<UInt>(std::uint32_t(rng(counter)) >> (32 - RandomBits));
+        return (rest + bits) >> RandomBits;
+    }
+    template<std::unsigned_integral UInt>
+    static constexpr UInt overflow_to_max(const UInt) noexcept {return 0;}
+
+    template<std::unsigned_integral UInt>
+    static constexpr UInt exact_zero_sign(const UInt xsgn, const UInt ysgn) noexcept
+    {
+        return xsgn & ysgn;
+    }
+    constexpr stochastic for_element(const std::uint64_t i) const noexcept
+    {
+        return stochastic{rng, counter + i};
+    }
+};
+
+// the rounding of `Rounding`, but a finite overflow becomes the max finite of
+// its sign in all the modes, as the saturating conversions to fp8 do. inf and
+// nan inputs are kept; e.g. saturating<nearest_even>{}.
+template<typename Rounding>
+struct saturating : Rounding
+{
+    template<std::unsigned_integral UInt>
+    static constexpr UInt overflow_to_max(const UInt) noexcept {return 1;}
+
+    constexpr saturating for_element(const std::uint64_t i) const noexcept
+    {
+        return saturating{Rounding::for_element(i)};
+    }
+};
+
+} // rounding
+
+template<typename Rounding>
+concept rounding_policy = requires(const Rounding& rnd, const std::uint32_t u)
+{
+    {Rounding::extra_bits} -> std::convertible_to<std::size_t>;
+    {rnd.round_up(u, u)} -> std::same_as<std::uint32_t>;
+    {Rounding::overflow_to_max(u)} -> std::same_as<std::uint32_t>;
+    {Rounding::exact_zero_sign(u, u)} -> std::same_as<std::uint32_t>;
+    {rnd.for_element(std::uint64_t(0))} -> std::same_as<Rounding>;
+};
+
+} // flemu
+#endif // FLEMU_ROUNDING_HPP
@@ -0,0 +1,78 @@
+#ifndef FLEMU_TOTAL_ORDER_HPP
+#define FLEMU_TOTAL_ORDER_HPP
+
+#include "float32.hpp"
+#include "utility.hpp"
+
+#include <cstdint>
+
+#include <compare>
+#include <concepts>
+
+namespace flemu
+{
+
+// IEEE 754 totalOrder of basic_float, on the bits, without converting them to
+// a native type. it orders all the encodings,
+//
+//   -nan < -inf < -max < ... < -denorm < -0 < +0 < +denorm < ... < +max < +inf < +nan
+//
+// and the nans of a sign by their payload (the negative ones reversed). flemu
+// does not have signaling nans, so the payload is all the mantissa bits.
+//
+// basic_float has no comparison operators, since the IEEE ones (where nan is
+// unordered and -0 == +0) are not this order.
+
+// the bits of x as an unsigned integer that is ordered as x in totalOrder. a
+// non-negative x gets the sign bit set; a negative one has all the bits
+// flipped, so that a larger magnitude becomes a smaller key. the key has the
+// sign_bit + 1 bits of the format, and it is a bijection on them.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr S total_order_key(const basic_float<E, M, B, S>& x) noexcept
+{
+    constexpr std::size_t sign_bit = basic_float<E, M, B, S>::sign_bit;
+    constexpr S sign = mask<S>(sign_bit, sign_bit);
+    constexpr S bits = mask<S>(sign_bit, 0);
+
+    const S b = x.base() & bits;
+    return (b & sign) != 0 ? S(~b & bits) : S(b | sign);
+}
+
+// the inverse of total_order_key.
+template<typename Float>
+constexpr Float from_total_order_key(const typename Float::base_type key) noexcept
+{
+    using base_type = typename Float::base_type;
+    constexpr base_type sign = mask<base_type>(Float::sign_bit, Float::sign_bit);
+    constexpr base_type bits = mask<base_type>(Float::sign_bit, 0);
+
+    return (key & sign) != 0 ? Float(base_type(key & ~sign & bits)) : Float(base_type(~key & bits));
+}
+
+// totalOrder(x, y): true if x precedes y or they are the same encoding.
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr bool total_order(const basic_float<E, M, B, S>& x, const basic_float<E, M, B, S>& y) noexcept
+{
+    return total_order_key(x) <= total_order_key(y);
+}
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr std::strong_ordering total_order_compare(const basic_float<E, M, B, S>& x,
+                                                   const basic_float<E, M, B, S>& y) noexcept
+{
+    return total_order_key(x) <=> total_order_key(y);
+}
+
+// totalOrder as a strict weak ordering, for std::sort and the ordered
+// containers; e.g. std::sort(v.begin(), v.end(), flemu::total_order_less{}).
+struct total_order_less
+{
+    template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+    constexpr bool operator()(const basic_float<E, M, B, S>& x, const basic_float<E, M, B, S>& y) const noexcept
+    {
+        return total_order_key(x) < total_order_key(y);
+    }
+};
+
+} // flemu
+#endif // FLEMU_TOTAL_ORDER_HPP
@@ -0,0 +1,212 @@
+#ifndef FLEMU_UNPACKED_FLOAT_HPP
+#define FLEMU_UNPACKED_FLOAT_HPP
+
+#include "float32.hpp"
+#include "adder.hpp"
+#include "flags.hpp"
+#include "rounding.hpp"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+
+namespace flemu
+{
+
+enum class float_class : std::uint8_t
+{
+    zero,
+    finite, // non-zero, including denormalized numbers
+    inf,
+    nan,
+};
+
+// A value of `Float` with the fields taken apart, to pass between operations
+// without packing and unpacking the bits each time.
+//
+//   finite: (-1)^sign * significand * 2^(exponent - mantissa_bits)
+//
+// The implicit 1 is explicit at bit mantissa_bits of the significand, and the
+// exponent is not biased. Denormalized numbers have the smallest exponent,
+// 1 - bias, and a significand less than 2^mantissa_bits, as in the bits.
+//
+// The operations round the result to `Float` as the packed ones do, so an
+// unpacked_float always holds a value of `Float` and pack() only moves the
+// fields into place. A chain of operations on unpacked_float gives the same
+// bits as the same chain on `Float`.
+//
+// A nan keeps its sign and its mantissa in `significand`, so that pack(unpack(x))
+// gives the same bits. The operations return the same nan as the packed ones.
+template<typename Float>
+struct unpacked_float
+{
+    using float_type       = Float;
+    using significand_type = typename float_type::base_type;
+
+    static constexpr std::int32_t min_exponent = 1 - std::int32_t(float_type::exponent_bias);
+    static constexpr std::int32_t max_exponent = std::int32_t(float_type::exponent_max) - 1 -
+                                                 std::int32_t(float_type::exponent_bias);
+
+    float_class      cls;
+    std::uint32_t    sign;
+    std::int32_t     exponent;
+    significand_type significand;
+
+    constexpr bool is_nan()  const noexcept {return cls == float_class::nan;}
+    constexpr bool is_inf()  const noexcept {return cls == float_class::inf;}
+    constexpr bool is_zero() const noexcept {return cls == float_class::zero;}
+};
+
+template<std::size_t E, std::size_t M, std::uint32_t B, std::unsigned_integral S>
+constexpr unpacked_float<basic_float<E, M, B, S>> unpack(const basic_float<E, M, B, S>& x) noexcept
+{
+    using float_type = basic_float<E, M, B, S>;
+    using base_type  = typename float_type::base_type;
+
+    const base_type sgn = base_type(x.sign());
+    const base_type exp = base_type(x.exponent());
+    const base_type man = base_type(x.mantissa());
+
+    const float_class cls = (exp == float_type::exponent_max) ? (man == 0 ? float_class::inf : float_class::nan) :
+                            (exp == 0 && man == 0) ? float_class::zero : float_class::finite;
+    const base_type implicit = (exp == 0) ? 0 : base_type(base_type(1) << M);
+    return unpacked_float<float_type>{cls, sgn,
+        std::int32_t(std::max<base_type>(exp, 1)) - std::int32_t(B),
+        (cls == float_class::nan) ? man : base_type(implicit | man)};
+}
+
+// the implicit 1 adds 1 to (exponent - 1), so a denormalized number goes to
+// the exponent 0 in the same way as pack_rounded.
+template<typename Float>
+constexpr Float pack(const unpacked_float<Float>& x) noexcept
+{
+    using base_type = typename Float::base_type;
+    const base_type sgn = base_type(base_type(x.sign) << Float::sign_bit);
+    switch(x.cls)
+    {
+        case float_class::zero: return Float(sgn);
+        case float_class::inf:  return Float(base_type(sgn | (Float::exponent_max << Float::mantissa_bits)));
+        case float_class::nan:  return Float(base_type(sgn | (Float::exponent_max << Float::mantissa_bits) | x.significand));
+        default: break;
+    }
+    const base_type exp = base_type(x.exponent + std::int32_t(Float::exponent_bias) - 1);
+    return Float(base_type(sgn | base_type(base_type(exp << Float::mantissa_bits) + x.significand)));
+}
+
+// x + y rounded by the rounding mode, the same as add on the packed values.
+// the flags are the same, too.
+template<typename Float, rounding_policy Rounding, flag_policy Flags>
+constexpr unpacked_float<Float> add(const unpacked_float<Float>& x_, const unpacked_float<Float>& y_,
+                                    const Rounding& rnd, const Flags& flg) noexcept
+{
+    using result_type = unpacked_float<Float>;
+    using sig_type    = typename result_type::significand_type;
+    using traits      = detail::add_traits<Float, Rounding>;
+    using work_type   = typename traits::work_type;
+    constexpr std::size_t   M    = Float::mantissa_bits;
+    constexpr std::int32_t  bias = std::int32_t(Float::exponent_bias);
+
+    // ------------------------------------------------------------------------
+    // special values. the finite path below does not need to care about them.
+
+    if(x_.cls != float_class::finite || y_.cls != float_class::finite) [[unlikely]]
+    {
+        const result_type nan{float_class::nan, 0, 0, sig_type(1)};
+        if(x_.is_nan() || y_.is_nan())
+        {
+            return nan;
+        }
+        if(x_.is_inf() && y_.is_inf() && x_.sign != y_.sign)
+        {
+            flg.raise(flag_invalid);
+            return nan;
+        }
+        if(x_.is_inf() || y_.is_inf())
+        {
+            return y_.is_inf() ? y_ : x_;
+        }
+        if(x_.is_zero() && y_.is_zero())
+        {
+            return result_type{float_class::zero, Rounding::exact_zero_sign(x_.sign, y_.sign), 0, 0};
+        }
+        return x_.is_zero() ? y_ : x_; // exact
+    }
+
+    // ------------------------------------------------------------------------
+    // the same as the packed add from the alignment, with the exponents
+    // biased again (>= 1) so that the shifts are unsigned.
+
+    const bool swap = (x_.exponent > y_.exponent) ||
+                      (x_.exponent == y_.exponent && x_.significand > y_.significand);
+    const result_type& x = swap ? y_ : x_;
+    const result_type& y = swap ? x_ : y_;
+
+    const work_type xexp = work_type(x.exponent + bias);
+    const work_type yexp = work_type(y.exponent + bias);
+    const work_type xman_ext = work_type(x.significand) << traits::extra_bits;
+    const work_type yman_ext = work_type(y.significand) << traits::extra_bits;
+
+    const work_type xman_aligned = detail::shift_right_sticky(xman_ext, yexp - xexp);
+
+    work_type zman = (x.sign == y.sign) ? yman_ext + xman_aligned : yman_ext - xman_aligned;
+    work_type zexp = yexp;
+
+    const work_type carry = zman >> traits::carry_bit;
+    zman  = detail::shift_right_sticky(zman, carry);
+    zexp += carry;
+
+    const work_type leading_zeros = work_type(std::countl_zero(zman)) -
+                                    work_type(traits::work_bits - 1 - traits::implicit_bit);
+    const work_type shift = std::min<work_type>(leading_zeros, zexp - 1);
+    zman <<= shift;
+    zexp  -= shift;
+
+    if(zman == 0)
+    {
+        return result_type{float_class::zero, Rounding::exact_zero_sign(x.sign, y.sign), 0, 0};
+    }
+
+    if constexpr(Flags::enabled)
+    {
+        flg.raise(detail::rounding_flags<Float>(rnd, work_type(y.sign), zexp, zman));
+    }
+
+    // ------------------------------------------------------------------------
+    // round. a carry-up makes it exactly 2^(M+1), and a denormalized number
+    // that is rounded up to 2^M is normalized with the same exponent.
+
+    const work_type ysgn = y.sign;
+    work_type sig = (zman >> traits::extra_bits) + rnd.round_up(ysgn, zman);
+    const work_type round_carry = sig >> (M + 1);
+    sig  >>= round_carry;
+    zexp  += round_carry;
+
+    if(zexp >= traits::exponent_max)
+    {
+        if(Rounding::overflow_to_max(ysgn) != 0)
+        {
+            return result_type{float_class::finite, y.sign, result_type::max_exponent,
+                               sig_type((work_type(1) << (M + 1)) - 1)};
+        }
+        return result_type{float_class::inf, y.sign, 0, 0};
+    }
+    return result_type{float_class::finite, y.sign, std::int32_t(zexp) - bias, sig_type(sig)};
+}
+
+template<typename Float, rounding_policy Rounding>
+constexpr unpacked_float<Float> add(const unpacked_float<Float>& x, const unpacked_float<Float>& y,
+                                    const Rounding& rnd) noexcept
+{
+    return add(x, y, rnd, flags::ignore{});
+}
+
+template<typename Float>
+constexpr unpacked_float<Float> add(const unpacked_float<Float>& x, const unpacked_float<Float>& y) noexcept
+{
+    return add(x, y, rounding::nearest_even{});
+}
+
+} // flemu
+#endif // FLEMU_UNPACKED_FLOAT_HPP
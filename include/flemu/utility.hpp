@@ -1,12 +1,24 @@
 #ifndef FLEMU_UTILITY_HPP
 #define FLEMU_UTILITY_HPP
-#include <boost/ut.hpp>
 
-#include <cmath>
 #include <cstdint>
 #include <cstring>
 
+#include <array>
+#include <bit>
 #include <concepts>
+#include <limits>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// forces inlining of tiny accessors even in unoptimized (debug) builds.
+#if defined(__GNUC__)
+#  define FLEMU_FORCE_INLINE [[gnu::always_inline]] inline
+#else
+#  define FLEMU_FORCE_INLINE inline
+#endif
 
 namespace flemu
 {
@@ -46,53 +58,129 @@ constexpr int bit_at(const UInt x, const std::size_t i) noexcept
     }
 }
 
+// The bits of x, from the highest to the lowest, with a separator every 4
+// bits, in a fixed-size buffer. It does not allocate, so it can be formatted
+// in a hot loop or a signal handler. `chars` is null-terminated.
+//
+// format_bits(std::uint8_t(0x5A)).view() == "0101'1010"
+//
 template<std::unsigned_integral UInt>
-std::string as_bit(const UInt x) noexcept
+struct bit_string
 {
-    std::string str;
-    const auto width = sizeof(UInt)*8;
-    for(std::size_t i=0; i<width; ++i)
+    static constexpr std::size_t digits = sizeof(UInt) * 8;
+    static constexpr std::size_t length = digits + digits / 4 - 1;
+
+    std::array<char, length + 1> chars;
+
+    constexpr const char*      data() const noexcept {return chars.data();}
+    constexpr std::string_view view() const noexcept {return std::string_view(chars.data(), length);}
+};
+
+template<std::unsigned_integral UInt>
+constexpr bit_string<UInt> format_bits(const UInt x) noexcept
+{
+    bit_string<UInt> str{};
+    std::size_t pos = 0;
+    for(std::size_t i=0; i<bit_string<UInt>::digits; ++i)
     {
         if(i % 4 == 0 && i != 0)
         {
-            str += '\'';
+            str.chars[pos++] = '\'';
         }
-        str += bit_at(x, width-i-1) + '0';
+        str.chars[pos++] = static_cast<char>('0' + bit_at(x, bit_string<UInt>::digits-i-1));
     }
+    str.chars[pos] = '\0';
     return str;
 }
 
-// only g++11 supports std::bit_cast ...
+template<typename charT, typename traits, std::unsigned_integral UInt>
+std::basic_ostream<charT, traits>&
+operator<<(std::basic_ostream<charT, traits>& os, const bit_string<UInt>& str)
+{
+    os << str.data();
+    return os;
+}
+
+// Holds only the value, and formats it when it is written to a stream. The
+// message of an expectation is only written if it fails, so
+// `expect(ok) << bits_of(x)` costs nothing while the test passes.
+template<std::unsigned_integral UInt>
+struct bit_view
+{
+    UInt value;
+};
+
+template<std::unsigned_integral UInt>
+constexpr bit_view<UInt> bits_of(const UInt x) noexcept
+{
+    return bit_view<UInt>{x};
+}
+
+template<typename charT, typename traits, std::unsigned_integral UInt>
+std::basic_ostream<charT, traits>&
+operator<<(std::basic_ostream<charT, traits>& os, const bit_view<UInt>& bv)
+{
+    os << format_bits(bv.value);
+    return os;
+}
+
+template<std::unsigned_integral UInt>
+std::string as_bit(const UInt x)
+{
+    return std::string(format_bits(x).view());
+}
+
+// std::bit_cast if the library has it (g++11 or later), so that the
+// conversions between float and the emulated types are constant expressions.
+// otherwise it falls back to memcpy, which can only run at runtime.
 template<typename T, typename U>
-T bit_cast(const U& u)
+constexpr T bit_cast(const U& u) noexcept
 {
     static_assert(sizeof(T) == sizeof(U));
+#if defined(__cpp_lib_bit_cast)
+    return std::bit_cast<T>(u);
+#else
     T t;
     std::memcpy(reinterpret_cast<char*>(std::addressof(t)),
                 reinterpret_cast<const char*>(std::addressof(u)),
                 sizeof(T));
     return t;
+#endif
 }
 
-#ifdef FLEMU_ACTIVATE_UNIT_TESTS
-inline boost::ut::suite tests_utility = [] {
-    using namespace boost::ut::literals;
-
-    "mask"_test = [] {
-        boost::ut::expect(mask<std::uint32_t>( 1,  3) == 0b00001110);
-        boost::ut::expect(mask<std::uint32_t>( 3,  1) == 0b00001110);
-        boost::ut::expect(mask<std::uint32_t>( 3,  3) == 0b00001000);
-        boost::ut::expect(mask<std::uint32_t>(31,  0) == 0xFFFFFFFF);
-        boost::ut::expect(mask<std::uint32_t>( 0, 31) == 0xFFFFFFFF);
-        boost::ut::expect(mask<std::uint32_t>(31, 31) == 0x80000000);
-
-        boost::ut::expect(mask<std::uint64_t>(31,  0) == 0xFFFF'FFFF);
-        boost::ut::expect(mask<std::uint64_t>(47, 32) == 0x0000'FFFF'0000'0000);
-        boost::ut::expect(mask<std::uint64_t>(63,  0) == 0xFFFF'FFFF'FFFF'FFFFull);
-        boost::ut::expect(mask<std::uint64_t>(63, 63) == 0x8000'0000'0000'0000ull);
+// allocates the elements at an address aligned to `Alignment` bytes, e.g. for
+// std::vector<T, aligned_allocator<T, 64>> that is loaded with aligned vector
+// loads or that should not share a cache line with another array.
+template<typename T, std::size_t Alignment>
+struct aligned_allocator
+{
+    static_assert(std::has_single_bit(Alignment) && Alignment >= alignof(T));
+
+    using value_type = T;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = aligned_allocator<U, Alignment>;
     };
+
+    constexpr aligned_allocator() noexcept = default;
+
+    template<typename U>
+    constexpr aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+    T* allocate(const std::size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* p, const std::size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    constexpr bool operator==(const aligned_allocator<U, Alignment>&) const noexcept {return true;}
 };
-#endif
 
 } // flemu
 #endif// FLEMU_UTILITY_HPP
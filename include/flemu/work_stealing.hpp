@@ -0,0 +1,135 @@
+#ifndef FLEMU_WORK_STEALING_HPP
+#define FLEMU_WORK_STEALING_HPP
+
+#include <cstddef>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flemu
+{
+
+inline std::size_t default_concurrency() noexcept
+{
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+namespace detail
+{
+
+// a range of task indices [begin, end) owned by a worker.
+// the owner takes tasks from the front, thieves take the back half.
+struct alignas(64) task_range
+{
+    std::mutex  mtx;
+    std::size_t begin = 0;
+    std::size_t end   = 0;
+
+    bool pop_front(std::size_t& task)
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        if(begin == end)
+        {
+            return false;
+        }
+        task = begin++;
+        return true;
+    }
+
+    bool steal_back(std::size_t& first, std::size_t& last)
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        const std::size_t remaining = end - begin;
+        if(remaining == 0)
+        {
+            return false;
+        }
+        const std::size_t stolen = (remaining + 1) / 2;
+        first = end - stolen;
+        last  = end;
+        end   = first;
+        return true;
+    }
+
+    void assign(const std::size_t first, const std::size_t last)
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        begin = first;
+        end   = last;
+    }
+};
+
+} // detail
+
+// Calls f(task, worker) for every task in [0, num_tasks) on num_workers threads
+// (including the calling thread). Each worker starts with a contiguous block of
+// tasks; when it runs out, it steals half of the remaining tasks of another
+// worker, so slow tasks do not leave the other cores idle.
+// f is called exactly once per task and must not throw.
+template<typename F>
+void parallel_for(const std::size_t num_tasks, std::size_t num_workers, F&& f)
+{
+    num_workers = std::max<std::size_t>(1, std::min(num_workers, num_tasks));
+    if(num_workers == 1)
+    {
+        for(std::size_t task=0; task<num_tasks; ++task)
+        {
+            f(task, std::size_t(0));
+        }
+        return;
+    }
+
+    std::unique_ptr<detail::task_range[]> ranges(new detail::task_range[num_workers]);
+    for(std::size_t w=0; w<num_workers; ++w)
+    {
+        ranges[w].assign(num_tasks * w / num_workers, num_tasks * (w+1) / num_workers);
+    }
+
+    std::atomic<std::size_t> unfinished(num_tasks);
+
+    const auto work = [&](const std::size_t self) {
+        std::size_t task = 0;
+        while(unfinished.load(std::memory_order_acquire) != 0)
+        {
+            if(ranges[self].pop_front(task))
+            {
+                f(task, self);
+                unfinished.fetch_sub(1, std::memory_order_acq_rel);
+                continue;
+            }
+            bool stolen = false;
+            for(std::size_t i=1; i<num_workers && !stolen; ++i)
+            {
+                std::size_t first = 0, last = 0;
+                if(ranges[(self + i) % num_workers].steal_back(first, last))
+                {
+                    ranges[self].assign(first, last);
+                    stolen = true;
+                }
+            }
+            if(!stolen)
+            {
+                std::this_thread::yield(); // the rest are running elsewhere
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_workers - 1);
+    for(std::size_t w=1; w<num_workers; ++w)
+    {
+        threads.emplace_back(work, w);
+    }
+    work(0);
+    for(auto& th : threads)
+    {
+        th.join();
+    }
+}
+
+} // flemu
+#endif // FLEMU_WORK_STEALING_HPP
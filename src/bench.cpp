@@ -0,0 +1,371 @@
+#include <flemu/adder.hpp>
+#include <flemu/batch_adder.hpp>
+#include <flemu/float32_soa.hpp>
+#include <flemu/unpacked_float.hpp>
+#include <flemu/work_stealing.hpp>
+#include "bench_inputs.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Throughput and latency benchmark of the emulated operations.
+//
+// Each result is identified by (op, class, mode, threads):
+//   - op     : "add" (scalar), "add_unpacked" (scalar on unpacked_float),
+//              "add_batch" (span API), "add_batch_flags" (span API with
+//              exception flags) or "add_soa" (float32_soa planes)
+//   - class  : input class, see bench_inputs.hpp
+//   - mode   : "latency" (every op depends on the previous result) or
+//              "throughput" (independent ops)
+//   - threads: number of threads running the same loop on their own data
+//
+// The results are written as JSON, one result per line. With --compare, the
+// results are compared to a baseline written by a previous run and the ones
+// that became slower than the tolerance are reported as regressions.
+//
+// Built with -DFLEMU_ENABLE_COUNTERS (`make bench_counters`), it also writes
+// the paths that the inputs took in the scalar add, of all the classes and
+// threads, as JSON to stderr; see flemu/counters.hpp. the timings of that
+// build include the counters.
+//
+// usage: bench [--out FILE] [--compare FILE] [--tolerance 0.10]
+//              [--threads 1,2,4] [--size N] [--min-time SEC]
+
+namespace
+{
+
+struct options
+{
+    std::string out;
+    std::string compare;
+    double      tolerance = 0.10;
+    double      min_time  = 0.2;
+    std::size_t size      = 1 << 14;
+    std::vector<std::size_t> threads;
+};
+
+struct result
+{
+    std::string op;
+    std::string cls;
+    std::string mode;
+    std::size_t threads;
+    double      ns_per_op;
+    double      ops_per_sec;
+
+    std::string key() const
+    {
+        return op + "/" + cls + "/" + mode + "/" + std::to_string(threads);
+    }
+};
+
+// the compiler does not know that it is zero.
+volatile std::uint32_t opaque_zero = 0;
+
+// results are accumulated here so that the compiler cannot remove the loops.
+volatile std::uint32_t sink = 0;
+
+struct workload
+{
+    std::vector<flemu::float32> xs, ys, zs;
+    flemu::float32_soa sxs, sys, szs;
+    std::uint32_t sink  = 0;
+    std::uint32_t flags = 0;
+};
+
+// runs `repeat` sweeps over the inputs. returns nothing, the result goes to sink.
+void run(const std::string& op, const std::string& mode, workload& w, const std::size_t repeat)
+{
+    const std::size_t n = w.xs.size();
+    if(op == "add_unpacked")
+    {
+        // the accumulator stays unpacked through the chain
+        const std::uint32_t zero = opaque_zero;
+        auto z = flemu::unpack(flemu::float32(0u));
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            for(std::size_t i=0; i<n; ++i)
+            {
+                z = flemu::add(z, flemu::unpack(flemu::float32(w.xs[i].base() ^ (z.significand & zero))));
+            }
+        }
+        w.sink ^= flemu::pack(z).base();
+    }
+    else if(mode == "latency")
+    {
+        const std::uint32_t zero = opaque_zero;
+        flemu::float32 z(0u);
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            for(std::size_t i=0; i<n; ++i)
+            {
+                z = flemu::add(flemu::float32(w.xs[i].base() ^ (z.base() & zero)), w.ys[i]);
+            }
+        }
+        w.sink ^= z.base();
+    }
+    else if(op == "add_batch_flags")
+    {
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            flemu::add(w.xs, w.ys, w.zs, flemu::rounding::nearest_even{}, flemu::flags::accumulate{w.flags});
+            w.sink ^= w.zs[r % n].base() ^ w.flags;
+        }
+    }
+    else if(op == "add_soa")
+    {
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            flemu::add(w.sxs, w.sys, w.szs);
+            w.sink ^= w.szs.mantissas()[r % n];
+        }
+    }
+    else if(op == "add_batch")
+    {
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            flemu::add(w.xs, w.ys, w.zs);
+            w.sink ^= w.zs[r % n].base();
+        }
+    }
+    else
+    {
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            for(std::size_t i=0; i<n; ++i)
+            {
+                w.zs[i] = flemu::add(w.xs[i], w.ys[i]);
+            }
+            w.sink ^= w.zs[r % n].base();
+        }
+    }
+}
+
+result measure(const std::string& op, const flemu::bench::input_class& cls,
+               const std::string& mode, const std::size_t threads, const options& opt)
+{
+    std::vector<workload> works(threads);
+    for(std::size_t t=0; t<threads; ++t)
+    {
+        std::mt19937 rng(123456789 + t);
+        flemu::bench::generate(cls, rng, opt.size, works[t].xs, works[t].ys);
+        works[t].zs.resize(opt.size);
+        works[t].sxs.assign(works[t].xs);
+        works[t].sys.assign(works[t].ys);
+        works[t].szs.resize(opt.size);
+    }
+
+    // all the threads start at the same time and run the same number of sweeps
+    const auto timed = [&](const std::size_t repeat) {
+        std::atomic<bool> go(false);
+        std::vector<std::thread> pool;
+        for(std::size_t t=1; t<threads; ++t)
+        {
+            pool.emplace_back([&, t] {
+                while(!go.load(std::memory_order_acquire)) {std::this_thread::yield();}
+                run(op, mode, works[t], repeat);
+            });
+        }
+        const auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        run(op, mode, works[0], repeat);
+        for(auto& th : pool) {th.join();}
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // grow the number of sweeps until it takes at least min_time, then take
+    // the best of 3 runs.
+    std::size_t repeat = 1;
+    double elapsed = timed(repeat);
+    while(elapsed < opt.min_time)
+    {
+        repeat *= 2;
+        elapsed = timed(repeat);
+    }
+    elapsed = std::min({elapsed, timed(repeat), timed(repeat)});
+    for(const auto& w : works)
+    {
+        sink = sink ^ w.sink;
+    }
+
+    const double ops_per_thread = static_cast<double>(repeat) * opt.size;
+    result res;
+    res.op          = op;
+    res.cls         = cls.name;
+    res.mode        = mode;
+    res.threads     = threads;
+    res.ns_per_op   = elapsed * 1.0e9 / ops_per_thread;
+    res.ops_per_sec = ops_per_thread * threads / elapsed;
+    return res;
+}
+
+std::string to_json(const result& r)
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"op\": \"%s\", \"class\": \"%s\", \"mode\": \"%s\", \"threads\": %zu, "
+        "\"ns_per_op\": %.4f, \"ops_per_sec\": %.6g}",
+        r.op.c_str(), r.cls.c_str(), r.mode.c_str(), r.threads, r.ns_per_op, r.ops_per_sec);
+    return buf;
+}
+
+// reads a value of `"key": value` in a line written by to_json.
+std::string json_field(const std::string& line, const std::string& key)
+{
+    const auto pos = line.find("\"" + key + "\":");
+    if(pos == std::string::npos)
+    {
+        return "";
+    }
+    auto first = line.find_first_not_of(" \"", pos + key.size() + 3);
+    auto last  = line.find_first_of(",}\"", first);
+    return line.substr(first, last - first);
+}
+
+std::map<std::string, result> read_baseline(const std::string& fname)
+{
+    std::map<std::string, result> baseline;
+    std::ifstream ifs(fname);
+    if(!ifs.good())
+    {
+        std::cerr << "error: cannot open baseline " << fname << std::endl;
+        std::exit(2);
+    }
+    std::string line;
+    while(std::getline(ifs, line))
+    {
+        if(line.find("\"ns_per_op\"") == std::string::npos)
+        {
+            continue;
+        }
+        result r;
+        r.op          = json_field(line, "op");
+        r.cls         = json_field(line, "class");
+        r.mode        = json_field(line, "mode");
+        r.threads     = std::stoull(json_field(line, "threads"));
+        r.ns_per_op   = std::stod(json_field(line, "ns_per_op"));
+        r.ops_per_sec = std::stod(json_field(line, "ops_per_sec"));
+        baseline[r.key()] = r;
+    }
+    return baseline;
+}
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--out"       && has_value) {opt.out       = argv[++i];}
+        else if(arg == "--compare"   && has_value) {opt.compare   = argv[++i];}
+        else if(arg == "--tolerance" && has_value) {opt.tolerance = std::stod(argv[++i]);}
+        else if(arg == "--min-time"  && has_value) {opt.min_time  = std::stod(argv[++i]);}
+        else if(arg == "--size"      && has_value) {opt.size      = std::stoull(argv[++i]);}
+        else if(arg == "--threads"   && has_value)
+        {
+            std::istringstream iss(argv[++i]);
+            std::string token;
+            while(std::getline(iss, token, ','))
+            {
+                opt.threads.push_back(std::max<std::size_t>(1, std::stoull(token)));
+            }
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--out FILE] [--compare FILE]"
+                " [--tolerance 0.10] [--threads 1,2,4] [--size N] [--min-time SEC]\n";
+            std::exit(2);
+        }
+    }
+    if(opt.threads.empty())
+    {
+        // 1, 2, 4, ... up to the number of cores
+        const std::size_t max_threads = flemu::default_concurrency();
+        for(std::size_t t=1; t<max_threads; t*=2) {opt.threads.push_back(t);}
+        opt.threads.push_back(max_threads);
+    }
+    return opt;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+
+    std::vector<result> results;
+    for(const auto& cls : flemu::bench::input_classes())
+    {
+        for(const std::size_t threads : opt.threads)
+        {
+            for(const auto& [op, mode] : {std::make_pair("add",             "latency"),
+                                          std::make_pair("add_unpacked",    "latency"),
+                                          std::make_pair("add",             "throughput"),
+                                          std::make_pair("add_batch",       "throughput"),
+                                          std::make_pair("add_soa",         "throughput"),
+                                          std::make_pair("add_batch_flags", "throughput")})
+            {
+                results.push_back(measure(op, cls, mode, threads, opt));
+                std::cerr << to_json(results.back()) << std::endl;
+            }
+        }
+    }
+
+#ifdef FLEMU_ENABLE_COUNTERS
+    flemu::counters::write_json(stderr, flemu::counters::snapshot());
+#endif
+
+    std::ostringstream json;
+    json << "{\"benchmark\": \"flemu\", \"size\": " << opt.size << ", \"results\": [\n";
+    for(std::size_t i=0; i<results.size(); ++i)
+    {
+        json << "  " << to_json(results[i]) << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    json << "]}\n";
+
+    if(opt.out.empty())
+    {
+        std::cout << json.str();
+    }
+    else
+    {
+        std::ofstream(opt.out) << json.str();
+    }
+
+    if(opt.compare.empty())
+    {
+        return 0;
+    }
+
+    const auto baseline = read_baseline(opt.compare);
+    std::size_t regressions = 0;
+    for(const auto& r : results)
+    {
+        const auto found = baseline.find(r.key());
+        if(found == baseline.end())
+        {
+            continue;
+        }
+        const double ratio = r.ns_per_op / found->second.ns_per_op;
+        const bool regressed = ratio > 1.0 + opt.tolerance;
+        regressions += regressed ? 1 : 0;
+        std::fprintf(stderr, "%-44s %10.3f -> %10.3f ns/op (%+6.1f%%)%s\n", r.key().c_str(),
+                     found->second.ns_per_op, r.ns_per_op, (ratio - 1.0) * 100.0,
+                     regressed ? "  REGRESSION" : "");
+    }
+    std::fprintf(stderr, "%zu regression(s) beyond %.1f%%\n", regressions, opt.tolerance * 100.0);
+    return regressions == 0 ? 0 : 1;
+}
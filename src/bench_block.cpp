@@ -0,0 +1,200 @@
+#include <flemu/block_float.hpp>
+#include <flemu/batch_adder.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Throughput of block floating point (flemu/block_float.hpp) against the
+// element-wise add, on one thread.
+//
+// Each result is identified by its op:
+//   - "float32_add"          : the span add of float32 (the vectorized kernel)
+//   - "bfloat16_add"         : the span add of bfloat16 (the scalar add for each element)
+//   - "msfp16_add_same"      : add of msfp16 whose blocks have the same exponents
+//   - "msfp16_add_realign"   : add of msfp16 whose blocks have different exponents
+//   - "msfp16_from_float32"  : the conversion of float32 to msfp16
+// The inputs are normally distributed with a scale per block of 16.
+//
+// usage: bench_block [--out FILE] [--size N] [--min-time SEC]
+
+namespace
+{
+
+struct options
+{
+    std::string out;
+    double      min_time = 0.2;
+    std::size_t size     = 1 << 16;
+};
+
+struct result
+{
+    std::string op;
+    double      ns_per_element;
+};
+
+// results are accumulated here so that the compiler cannot remove the loops.
+volatile std::uint32_t sink = 0;
+
+// grows the number of sweeps until it takes at least min_time, then takes
+// the best of 3 runs. returns ns/element.
+template<typename F>
+double measure(F&& sweep, const options& opt)
+{
+    const auto timed = [&](const std::size_t repeat) {
+        const auto start = std::chrono::steady_clock::now();
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            sweep(r);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::size_t repeat = 1;
+    double elapsed = timed(repeat);
+    while(elapsed < opt.min_time)
+    {
+        repeat *= 2;
+        elapsed = timed(repeat);
+    }
+    elapsed = std::min({elapsed, timed(repeat), timed(repeat)});
+    return elapsed * 1.0e9 / (static_cast<double>(repeat) * opt.size);
+}
+
+// normally distributed values with a scale per block, 2^(0..scale_range).
+std::vector<flemu::float32> inputs(std::mt19937& rng, const std::size_t n, const int scale_range)
+{
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::uniform_int_distribution<int> scale(0, scale_range);
+    std::vector<flemu::float32> xs(n);
+    int s = 0;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        s = (i % flemu::msfp16::block_size == 0) ? scale(rng) : s;
+        xs[i] = flemu::to_flemu(std::ldexp(normal(rng), s));
+    }
+    return xs;
+}
+
+std::string to_json(const result& r)
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "{\"op\": \"%s\", \"ns_per_element\": %.4f}", r.op.c_str(), r.ns_per_element);
+    return buf;
+}
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--out"      && has_value) {opt.out      = argv[++i];}
+        else if(arg == "--min-time" && has_value) {opt.min_time = std::stod(argv[++i]);}
+        else if(arg == "--size"     && has_value) {opt.size     = std::max<std::size_t>(1, std::stoull(argv[++i]));}
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--out FILE] [--size N] [--min-time SEC]\n";
+            std::exit(2);
+        }
+    }
+    return opt;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+    const std::size_t n = opt.size;
+
+    std::mt19937 rng(123456789);
+    const auto xs = inputs(rng, n, 8);
+    const auto ys = inputs(rng, n, 8);
+
+    std::vector<result> results;
+    {
+        std::vector<flemu::float32> zs(n);
+        results.push_back({"float32_add", measure([&](const std::size_t r) {
+            flemu::add(std::span<const flemu::float32>(xs), std::span<const flemu::float32>(ys),
+                       std::span<flemu::float32>(zs));
+            sink = sink ^ zs[r % n].base();
+        }, opt)});
+    }
+    {
+        std::vector<flemu::bfloat16> xb(n), yb(n), zb(n);
+        for(std::size_t i=0; i<n; ++i)
+        {
+            xb[i] = flemu::bfloat16(std::uint16_t(xs[i].base() >> 16));
+            yb[i] = flemu::bfloat16(std::uint16_t(ys[i].base() >> 16));
+        }
+        results.push_back({"bfloat16_add", measure([&](const std::size_t r) {
+            flemu::add(std::span<const flemu::bfloat16>(xb), std::span<const flemu::bfloat16>(yb),
+                       std::span<flemu::bfloat16>(zb));
+            sink = sink ^ zb[r % n].base();
+        }, opt)});
+    }
+    {
+        // y == -x / 2 with the exponents of x, so that no sum carries out.
+        const flemu::msfp16 x(xs);
+        flemu::msfp16 y = x;
+        for(auto& e : y.elements())
+        {
+            e = std::uint8_t(((e ^ 0x80u) & 0x80u) | ((e & 0x7Fu) >> 1));
+        }
+        flemu::msfp16 z;
+        results.push_back({"msfp16_add_same", measure([&](const std::size_t r) {
+            flemu::add(x, y, z);
+            sink = sink ^ z.elements()[r % n];
+        }, opt)});
+    }
+    {
+        const flemu::msfp16 x(xs);
+        const flemu::msfp16 y(ys);
+        flemu::msfp16 z;
+        results.push_back({"msfp16_add_realign", measure([&](const std::size_t r) {
+            flemu::add(x, y, z);
+            sink = sink ^ z.elements()[r % n];
+        }, opt)});
+    }
+    {
+        flemu::msfp16 x;
+        results.push_back({"msfp16_from_float32", measure([&](const std::size_t r) {
+            x.assign(std::span<const flemu::float32>(xs));
+            sink = sink ^ x.elements()[r % n];
+        }, opt)});
+    }
+    for(const auto& r : results)
+    {
+        std::cerr << to_json(r) << std::endl;
+    }
+
+    std::ostringstream json;
+    json << "{\"benchmark\": \"flemu_block\", \"size\": " << n << ", \"results\": [\n";
+    for(std::size_t i=0; i<results.size(); ++i)
+    {
+        json << "  " << to_json(results[i]) << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    json << "]}\n";
+
+    if(opt.out.empty())
+    {
+        std::cout << json.str();
+    }
+    else
+    {
+        std::ofstream(opt.out) << json.str();
+    }
+    return 0;
+}
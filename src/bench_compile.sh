@@ -0,0 +1,89 @@
+#!/usr/bin/env bash
+# Front-end cost of the translation units that use flemu.
+#
+# Each TU is compiled with -fsyntax-only (parse and instantiate, no code
+# generation) `--runs` times, and the fastest time is reported with the
+# number of lines after preprocessing. The TUs are
+#   - header : a file with just `#include <flemu/NAME.hpp>`, for each header
+#   - empty  : an empty file, the fixed cost of the compiler
+#   - ut     : just `#include <boost/ut.hpp>`, if extlib/ut is checked out
+#   - test   : each file in tests/, with the test framework
+#   - tool   : each tool in this directory
+#
+# The results are written as JSON, one result per line, like bench.
+#
+# usage: ./bench_compile.sh [--runs N] [--out FILE] [--cxx COMPILER]
+
+set -euo pipefail
+cd "$(dirname "$0")"
+
+runs=5
+out=""
+cxx="${CXX:-g++-10}"
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --runs) runs="$2"; shift 2;;
+        --out)  out="$2";  shift 2;;
+        --cxx)  cxx="$2";  shift 2;;
+        *) echo "usage: $0 [--runs N] [--out FILE] [--cxx COMPILER]" >&2; exit 2;;
+    esac
+done
+
+flags=(-std=c++20 -I../extlib/ut/include -I../include)
+tmp="$(mktemp -d)"
+trap 'rm -rf "$tmp"' EXIT
+
+# measure KIND NAME FILE [EXTRA FLAGS...]
+results=()
+measure() {
+    local kind="$1" name="$2" file="$3"
+    shift 3
+    local best="" t0 t1 ms
+    for _ in $(seq "$runs"); do
+        t0=$(date +%s%N)
+        "$cxx" "${flags[@]}" "$@" -fsyntax-only "$file"
+        t1=$(date +%s%N)
+        ms=$(( (t1 - t0) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then best="$ms"; fi
+    done
+    local lines
+    lines=$("$cxx" "${flags[@]}" "$@" -E -P "$file" | wc -l)
+    printf '%-8s %-32s %6d ms %8d lines\n' "$kind" "$name" "$best" "$lines" >&2
+    results+=("{\"kind\": \"$kind\", \"name\": \"$name\", \"ms\": $best, \"lines\": $lines}")
+}
+
+: > "$tmp/empty.cpp"
+measure empty empty "$tmp/empty.cpp"
+
+if [ -f ../extlib/ut/include/boost/ut.hpp ]; then
+    echo '#include <boost/ut.hpp>' > "$tmp/ut.cpp"
+    measure ut boost/ut.hpp "$tmp/ut.cpp"
+fi
+
+for header in ../include/flemu/*.hpp; do
+    name="$(basename "$header")"
+    echo "#include <flemu/$name>" > "$tmp/${name%.hpp}.cpp"
+    measure header "$name" "$tmp/${name%.hpp}.cpp"
+done
+
+if [ -f ../extlib/ut/include/boost/ut.hpp ]; then
+    for tu in tests/*.cpp; do
+        measure test "$tu" "$tu"
+    done
+fi
+
+for tu in bench.cpp bench_reduce.cpp bench_float64.cpp bench_convert.cpp bench_sort.cpp bench_block.cpp fuzz.cpp microbench.cpp quantize.cpp replay.cpp verify.cpp; do
+    measure tool "$tu" "$tu"
+done
+
+{
+    echo "{\"benchmark\": \"flemu_compile\", \"compiler\": \"$cxx\", \"runs\": $runs, \"results\": ["
+    for i in "${!results[@]}"; do
+        if [ "$i" -lt $(( ${#results[@]} - 1 )) ]; then
+            echo "  ${results[$i]},"
+        else
+            echo "  ${results[$i]}"
+        fi
+    done
+    echo "]}"
+} > "${out:-/dev/stdout}"
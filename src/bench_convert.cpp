@@ -0,0 +1,175 @@
+#include <flemu/batch_convert.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Throughput of the conversions between float32 and the narrower formats, on
+// one thread.
+//
+// For each format and direction ("narrow": float32 -> format with
+// nearest-even rounding, "widen": format -> float32), it measures the scalar
+// convert for each element ("scalar") and the span convert ("batch", see
+// flemu/batch_convert.hpp). The inputs are normally distributed, like
+// weights, with some denormals, infs and nans of the format.
+//
+// usage: bench_convert [--out FILE] [--size N] [--min-time SEC]
+
+namespace
+{
+
+struct options
+{
+    std::string out;
+    double      min_time = 0.2;
+    std::size_t size     = 1 << 16;
+};
+
+struct result
+{
+    std::string format;
+    std::string direction;
+    double      ns_scalar;
+    double      ns_batch;
+};
+
+// results are accumulated here so that the compiler cannot remove the loops.
+volatile std::uint32_t sink = 0;
+
+// grows the number of sweeps until it takes at least min_time, then takes
+// the best of 3 runs. returns ns/element.
+template<typename F>
+double measure(F&& sweep, const options& opt)
+{
+    const auto timed = [&](const std::size_t repeat) {
+        const auto start = std::chrono::steady_clock::now();
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            sweep(r);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::size_t repeat = 1;
+    double elapsed = timed(repeat);
+    while(elapsed < opt.min_time)
+    {
+        repeat *= 2;
+        elapsed = timed(repeat);
+    }
+    elapsed = std::min({elapsed, timed(repeat), timed(repeat)});
+    return elapsed * 1.0e9 / (static_cast<double>(repeat) * opt.size);
+}
+
+template<typename To>
+void run(const char* name, const options& opt, std::vector<result>& results)
+{
+    std::mt19937 rng(123456789);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::vector<flemu::float32> xs(opt.size);
+    for(std::size_t i=0; i<opt.size; ++i)
+    {
+        const float scale = (i % 64 == 0) ? 1.0e-30f : (i % 64 == 1) ? 1.0e30f : 1.0f;
+        xs[i] = flemu::to_flemu(normal(rng) * scale);
+    }
+    std::vector<To> qs(opt.size);
+    std::vector<flemu::float32> ys(opt.size);
+    flemu::convert(std::span<const flemu::float32>(xs), std::span<To>(qs));
+
+    result narrow{name, "narrow", 0.0, 0.0};
+    narrow.ns_scalar = measure([&](const std::size_t r) {
+        flemu::detail::convert_kernel_scalar<To, flemu::rounding::nearest_even, false>(
+            xs.data(), qs.data(), opt.size);
+        sink = sink ^ qs[r % opt.size].base();
+    }, opt);
+    narrow.ns_batch = measure([&](const std::size_t r) {
+        flemu::convert(std::span<const flemu::float32>(xs), std::span<To>(qs));
+        sink = sink ^ qs[r % opt.size].base();
+    }, opt);
+    results.push_back(narrow);
+
+    result widen{name, "widen", 0.0, 0.0};
+    widen.ns_scalar = measure([&](const std::size_t r) {
+        flemu::detail::convert_kernel_scalar<flemu::float32, flemu::rounding::nearest_even, false>(
+            qs.data(), ys.data(), opt.size);
+        sink = sink ^ ys[r % opt.size].base();
+    }, opt);
+    widen.ns_batch = measure([&](const std::size_t r) {
+        flemu::convert(std::span<const To>(qs), std::span<flemu::float32>(ys));
+        sink = sink ^ ys[r % opt.size].base();
+    }, opt);
+    results.push_back(widen);
+}
+
+std::string to_json(const result& r)
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"format\": \"%s\", \"direction\": \"%s\", \"scalar_ns_per_element\": %.4f, "
+        "\"batch_ns_per_element\": %.4f, \"speedup\": %.2f}",
+        r.format.c_str(), r.direction.c_str(), r.ns_scalar, r.ns_batch, r.ns_scalar / r.ns_batch);
+    return buf;
+}
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--out"      && has_value) {opt.out      = argv[++i];}
+        else if(arg == "--min-time" && has_value) {opt.min_time = std::stod(argv[++i]);}
+        else if(arg == "--size"     && has_value) {opt.size     = std::max<std::size_t>(1, std::stoull(argv[++i]));}
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--out FILE] [--size N] [--min-time SEC]\n";
+            std::exit(2);
+        }
+    }
+    return opt;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+
+    std::vector<result> results;
+    run<flemu::bfloat16   >("bfloat16",    opt, results);
+    run<flemu::float16    >("float16",     opt, results);
+    run<flemu::float8_e5m2>("float8_e5m2", opt, results);
+    run<flemu::float8_e4m3>("float8_e4m3", opt, results);
+    for(const auto& r : results)
+    {
+        std::cerr << to_json(r) << std::endl;
+    }
+
+    std::ostringstream json;
+    json << "{\"benchmark\": \"flemu_convert\", \"size\": " << opt.size << ", \"results\": [\n";
+    for(std::size_t i=0; i<results.size(); ++i)
+    {
+        json << "  " << to_json(results[i]) << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    json << "]}\n";
+
+    if(opt.out.empty())
+    {
+        std::cout << json.str();
+    }
+    else
+    {
+        std::ofstream(opt.out) << json.str();
+    }
+    return 0;
+}
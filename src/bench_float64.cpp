@@ -0,0 +1,181 @@
+#include <flemu/adder.hpp>
+#include <flemu/batch_adder.hpp>
+#include "bench_inputs.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// float64 add compared with float32 add, on one thread.
+//
+// For each input class (see bench_inputs.hpp; the float64 classes are the
+// same paths at float64 widths), the scalar add and the span add of both
+// formats are measured over the same number of independent additions. Each
+// result has ns/op of both and the ratio float64 / float32.
+//
+// usage: bench_float64 [--out FILE] [--size N] [--min-time SEC]
+
+namespace
+{
+
+struct options
+{
+    std::string out;
+    double      min_time = 0.2;
+    std::size_t size     = 1 << 14;
+};
+
+struct result
+{
+    std::string op;
+    std::string cls;
+    double      ns_float32;
+    double      ns_float64;
+};
+
+// results are accumulated here so that the compiler cannot remove the loops.
+volatile std::uint64_t sink = 0;
+
+template<typename Float>
+struct workload
+{
+    std::vector<Float> xs, ys, zs;
+    std::uint64_t sink = 0;
+};
+
+template<typename Float>
+void run(const std::string& op, workload<Float>& w, const std::size_t repeat)
+{
+    const std::size_t n = w.xs.size();
+    if(op == "add_batch")
+    {
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            flemu::add(w.xs, w.ys, w.zs);
+            w.sink ^= w.zs[r % n].base();
+        }
+    }
+    else
+    {
+        for(std::size_t r=0; r<repeat; ++r)
+        {
+            for(std::size_t i=0; i<n; ++i)
+            {
+                w.zs[i] = flemu::add(w.xs[i], w.ys[i]);
+            }
+            w.sink ^= w.zs[r % n].base();
+        }
+    }
+}
+
+// grows the number of sweeps until it takes at least min_time, then takes
+// the best of 3 runs. returns ns/op.
+template<typename Float>
+double measure(const std::string& op, workload<Float>& w, const options& opt)
+{
+    const auto timed = [&](const std::size_t repeat) {
+        const auto start = std::chrono::steady_clock::now();
+        run(op, w, repeat);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::size_t repeat = 1;
+    double elapsed = timed(repeat);
+    while(elapsed < opt.min_time)
+    {
+        repeat *= 2;
+        elapsed = timed(repeat);
+    }
+    elapsed = std::min({elapsed, timed(repeat), timed(repeat)});
+    sink = sink ^ w.sink;
+    return elapsed * 1.0e9 / (static_cast<double>(repeat) * opt.size);
+}
+
+std::string to_json(const result& r)
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"op\": \"%s\", \"class\": \"%s\", \"float32_ns_per_op\": %.4f, "
+        "\"float64_ns_per_op\": %.4f, \"ratio\": %.3f}",
+        r.op.c_str(), r.cls.c_str(), r.ns_float32, r.ns_float64, r.ns_float64 / r.ns_float32);
+    return buf;
+}
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--out"      && has_value) {opt.out      = argv[++i];}
+        else if(arg == "--min-time" && has_value) {opt.min_time = std::stod(argv[++i]);}
+        else if(arg == "--size"     && has_value) {opt.size     = std::max<std::size_t>(1, std::stoull(argv[++i]));}
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--out FILE] [--size N] [--min-time SEC]\n";
+            std::exit(2);
+        }
+    }
+    return opt;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+
+    const auto classes32 = flemu::bench::input_classes();
+    const auto classes64 = flemu::bench::input_classes64();
+
+    std::vector<result> results;
+    for(std::size_t c=0; c<classes32.size(); ++c)
+    {
+        workload<flemu::float32> w32;
+        workload<flemu::float64> w64;
+        std::mt19937    rng32(123456789);
+        std::mt19937_64 rng64(123456789);
+        flemu::bench::generate(classes32[c], rng32, opt.size, w32.xs, w32.ys);
+        flemu::bench::generate(classes64[c], rng64, opt.size, w64.xs, w64.ys);
+        w32.zs.resize(opt.size);
+        w64.zs.resize(opt.size);
+
+        for(const std::string op : {"add", "add_batch"})
+        {
+            result r;
+            r.op         = op;
+            r.cls        = classes64[c].name;
+            r.ns_float32 = measure(op, w32, opt);
+            r.ns_float64 = measure(op, w64, opt);
+            results.push_back(r);
+            std::cerr << to_json(r) << std::endl;
+        }
+    }
+
+    std::ostringstream json;
+    json << "{\"benchmark\": \"flemu_float64\", \"size\": " << opt.size << ", \"results\": [\n";
+    for(std::size_t i=0; i<results.size(); ++i)
+    {
+        json << "  " << to_json(results[i]) << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    json << "]}\n";
+
+    if(opt.out.empty())
+    {
+        std::cout << json.str();
+    }
+    else
+    {
+        std::ofstream(opt.out) << json.str();
+    }
+    return 0;
+}
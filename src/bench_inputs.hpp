@@ -0,0 +1,127 @@
+#ifndef FLEMU_BENCH_INPUTS_HPP
+#define FLEMU_BENCH_INPUTS_HPP
+
+#include <flemu/float32.hpp>
+
+#include <cstdint>
+
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+// classes of inputs for the benchmarks. each of them exercises a different
+// path in add.
+
+namespace flemu::bench
+{
+
+struct input_class
+{
+    const char* name;
+    std::function<std::pair<std::uint32_t, std::uint32_t>(std::mt19937&)> generate;
+};
+
+inline std::vector<input_class> input_classes()
+{
+    using u32 = std::uint32_t;
+    using dist = std::uniform_int_distribution<u32>;
+    return {
+        {"normal", [](std::mt19937& rng) {
+            const u32 s = dist(0, 1)(rng) << 31;
+            return std::make_pair(s + (dist(100, 150)(rng) << 23) + dist(0, 0x7F'FFFF)(rng),
+                                  s + (dist(100, 150)(rng) << 23) + dist(0, 0x7F'FFFF)(rng));
+        }},
+        {"cancellation", [](std::mt19937& rng) {
+            const u32 x = (dist(0, 1)(rng) << 31) + (dist(100, 150)(rng) << 23) + dist(0, 0x7F'FFFF)(rng);
+            return std::make_pair(x, (x ^ 0x8000'0000u) + dist(0, 16)(rng) - 8);
+        }},
+        {"large_gap", [](std::mt19937& rng) {
+            const u32 e = dist(1, 200)(rng);
+            return std::make_pair((dist(0, 1)(rng) << 31) + (e << 23) + dist(0, 0x7F'FFFF)(rng),
+                                  (dist(0, 1)(rng) << 31) + ((e + dist(27, 54)(rng)) << 23) + dist(0, 0x7F'FFFF)(rng));
+        }},
+        {"denormal", [](std::mt19937& rng) {
+            return std::make_pair((dist(0, 1)(rng) << 31) + dist(1, 0x7F'FFFF)(rng),
+                                  (dist(0, 1)(rng) << 31) + dist(1, 0x7F'FFFF)(rng));
+        }},
+        {"inf_nan", [](std::mt19937& rng) {
+            return std::make_pair((dist(0, 1)(rng) << 31) + (0xFFu << 23) + dist(0, 1)(rng),
+                                  (dist(0, 1)(rng) << 31) + (dist(1, 254)(rng) << 23) + dist(0, 0x7F'FFFF)(rng));
+        }},
+        {"uniform", [](std::mt19937& rng) {
+            return std::make_pair(dist()(rng), dist()(rng));
+        }},
+    };
+}
+
+inline void generate(const input_class& cls, std::mt19937& rng, const std::size_t n,
+                     std::vector<float32>& xs, std::vector<float32>& ys)
+{
+    xs.resize(n);
+    ys.resize(n);
+    for(std::size_t i=0; i<n; ++i)
+    {
+        const auto [x, y] = cls.generate(rng);
+        xs[i] = float32(x);
+        ys[i] = float32(y);
+    }
+}
+
+// the same classes for float64. large_gap is >= 56, the width of the aligned
+// mantissa of float64.
+struct input_class64
+{
+    const char* name;
+    std::function<std::pair<std::uint64_t, std::uint64_t>(std::mt19937_64&)> generate;
+};
+
+inline std::vector<input_class64> input_classes64()
+{
+    using u64 = std::uint64_t;
+    using dist = std::uniform_int_distribution<u64>;
+    constexpr u64 man = 0x000F'FFFF'FFFF'FFFFull;
+    return {
+        {"normal", [](std::mt19937_64& rng) {
+            const u64 s = dist(0, 1)(rng) << 63;
+            return std::make_pair(s + (dist(1000, 1050)(rng) << 52) + dist(0, man)(rng),
+                                  s + (dist(1000, 1050)(rng) << 52) + dist(0, man)(rng));
+        }},
+        {"cancellation", [](std::mt19937_64& rng) {
+            const u64 x = (dist(0, 1)(rng) << 63) + (dist(1000, 1050)(rng) << 52) + dist(0, man)(rng);
+            return std::make_pair(x, (x ^ 0x8000'0000'0000'0000ull) + dist(0, 16)(rng) - 8);
+        }},
+        {"large_gap", [](std::mt19937_64& rng) {
+            const u64 e = dist(1, 1800)(rng);
+            return std::make_pair((dist(0, 1)(rng) << 63) + (e << 52) + dist(0, man)(rng),
+                                  (dist(0, 1)(rng) << 63) + ((e + dist(56, 112)(rng)) << 52) + dist(0, man)(rng));
+        }},
+        {"denormal", [](std::mt19937_64& rng) {
+            return std::make_pair((dist(0, 1)(rng) << 63) + dist(1, man)(rng),
+                                  (dist(0, 1)(rng) << 63) + dist(1, man)(rng));
+        }},
+        {"inf_nan", [](std::mt19937_64& rng) {
+            return std::make_pair((dist(0, 1)(rng) << 63) + (u64(0x7FF) << 52) + dist(0, 1)(rng),
+                                  (dist(0, 1)(rng) << 63) + (dist(1, 2046)(rng) << 52) + dist(0, man)(rng));
+        }},
+        {"uniform", [](std::mt19937_64& rng) {
+            return std::make_pair(dist()(rng), dist()(rng));
+        }},
+    };
+}
+
+inline void generate(const input_class64& cls, std::mt19937_64& rng, const std::size_t n,
+                     std::vector<float64>& xs, std::vector<float64>& ys)
+{
+    xs.resize(n);
+    ys.resize(n);
+    for(std::size_t i=0; i<n; ++i)
+    {
+        const auto [x, y] = cls.generate(rng);
+        xs[i] = float64(x);
+        ys[i] = float64(y);
+    }
+}
+
+} // flemu::bench
+#endif // FLEMU_BENCH_INPUTS_HPP
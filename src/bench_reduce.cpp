@@ -0,0 +1,135 @@
+#include <flemu/reduce.hpp>
+#include "bench_inputs.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Scaling benchmark of flemu::reduce.
+//
+// For each order (sequential, pairwise, blocked_tree) and number of threads,
+// it measures the time to sum `size` float32 values of the "normal" input
+// class and reports ns per element and the speedup over 1 thread, as JSON,
+// one result per line. It also checks that the sum is bit-identical for all
+// the numbers of threads; the exit status is 1 if it is not.
+//
+// usage: bench_reduce [--threads 1,2,4] [--size N] [--min-time SEC]
+
+namespace
+{
+
+struct options
+{
+    double      min_time = 0.5;
+    std::size_t size     = std::size_t(1) << 25;
+    std::vector<std::size_t> threads;
+};
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--min-time" && has_value) {opt.min_time = std::stod(argv[++i]);}
+        else if(arg == "--size"     && has_value) {opt.size     = std::stoull(argv[++i]);}
+        else if(arg == "--threads"  && has_value)
+        {
+            std::istringstream iss(argv[++i]);
+            std::string token;
+            while(std::getline(iss, token, ','))
+            {
+                opt.threads.push_back(std::max<std::size_t>(1, std::stoull(token)));
+            }
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--threads 1,2,4] [--size N] [--min-time SEC]\n";
+            std::exit(2);
+        }
+    }
+    if(opt.threads.empty())
+    {
+        const std::size_t max_threads = flemu::default_concurrency();
+        for(std::size_t t=1; t<max_threads; t*=2) {opt.threads.push_back(t);}
+        opt.threads.push_back(max_threads);
+    }
+    return opt;
+}
+
+// the best time of the runs in min_time (at least 2 runs).
+template<typename F>
+double best_time(const double min_time, F&& f)
+{
+    double best = 1.0e300, total = 0.0;
+    for(std::size_t run=0; run < 2 || total < min_time; ++run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best   = std::min(best, elapsed);
+        total += elapsed;
+    }
+    return best;
+}
+
+template<typename Order>
+bool bench(const char* name, const Order& order, std::span<const flemu::float32> x, const options& opt)
+{
+    bool identical = true;
+    double single = 0.0;
+    std::uint32_t first = 0;
+    for(const std::size_t threads : opt.threads)
+    {
+        std::uint32_t sum = 0;
+        const double elapsed = best_time(opt.min_time, [&] {
+            sum = flemu::reduce(x, order, threads).base();
+        });
+        if(single == 0.0)
+        {
+            single = elapsed;
+            first  = sum;
+        }
+        identical = identical && (sum == first);
+
+        std::printf("{\"op\": \"reduce\", \"order\": \"%s\", \"threads\": %zu, \"size\": %zu, "
+                    "\"ns_per_element\": %.4f, \"speedup\": %.3f, \"sum\": \"%s\"}\n",
+                    name, threads, x.size(), elapsed * 1.0e9 / double(x.size()),
+                    single / elapsed, flemu::format_bits(sum).data());
+        std::fflush(stdout);
+    }
+    if(!identical)
+    {
+        std::fprintf(stderr, "error: the sum of %s depends on the number of threads\n", name);
+    }
+    return identical;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+
+    std::vector<flemu::float32> xs, ys;
+    std::mt19937 rng(123456789);
+    const auto classes = flemu::bench::input_classes();
+    const auto normal = std::find_if(classes.begin(), classes.end(),
+                                     [](const auto& c) {return std::string(c.name) == "normal";});
+    flemu::bench::generate(*normal, rng, opt.size, xs, ys);
+
+    const std::span<const flemu::float32> x(xs);
+    bool ok = true;
+    ok = bench("sequential",   flemu::reduction::sequential{},   x, opt) && ok;
+    ok = bench("pairwise",     flemu::reduction::pairwise{},     x, opt) && ok;
+    ok = bench("blocked_tree", flemu::reduction::blocked_tree{}, x, opt) && ok;
+    return ok ? 0 : 1;
+}
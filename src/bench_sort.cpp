@@ -0,0 +1,167 @@
+#include <flemu/radix_sort.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Sorting, top-k and histograms of float32 in totalOrder.
+//
+// Each result is identified by (op, threads):
+//   - op : "radix_sort", "std_sort" (std::sort with total_order_less, the
+//          comparison sort that it replaces), "top_k" (k = 1000),
+//          "std_partial_sort" (the same k with std::partial_sort) or
+//          "key_histogram" (binades, 9 bits)
+// The inputs are normally distributed. Every run sorts a fresh copy of them;
+// the copy is not timed.
+//
+// usage: bench_sort [--out FILE] [--size N] [--threads 1,2,4] [--runs 3]
+
+namespace
+{
+
+struct options
+{
+    std::string out;
+    std::size_t size = std::size_t(1) << 24;
+    std::size_t runs = 3;
+    std::vector<std::size_t> threads;
+};
+
+struct result
+{
+    std::string op;
+    std::size_t threads;
+    double      ns_per_element;
+};
+
+// results are accumulated here so that the compiler cannot remove the work.
+volatile std::uint64_t sink = 0;
+
+// the best of `runs` calls of f(v), each on a fresh copy of xs.
+template<typename F>
+double measure(const std::vector<flemu::float32>& xs, const options& opt, F&& f)
+{
+    double best = 0.0;
+    std::vector<flemu::float32> v;
+    for(std::size_t r=0; r<opt.runs; ++r)
+    {
+        v = xs;
+        const auto start = std::chrono::steady_clock::now();
+        f(v);
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = (r == 0) ? elapsed : std::min(best, elapsed);
+        sink = sink ^ v[r % v.size()].base();
+    }
+    return best * 1.0e9 / static_cast<double>(xs.size());
+}
+
+std::string to_json(const result& r)
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "{\"op\": \"%s\", \"threads\": %zu, \"ns_per_element\": %.4f}",
+                  r.op.c_str(), r.threads, r.ns_per_element);
+    return buf;
+}
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--out"  && has_value) {opt.out  = argv[++i];}
+        else if(arg == "--size" && has_value) {opt.size = std::max<std::size_t>(1, std::stoull(argv[++i]));}
+        else if(arg == "--runs" && has_value) {opt.runs = std::max<std::size_t>(1, std::stoull(argv[++i]));}
+        else if(arg == "--threads" && has_value)
+        {
+            std::istringstream iss(argv[++i]);
+            std::string token;
+            while(std::getline(iss, token, ','))
+            {
+                opt.threads.push_back(std::max<std::size_t>(1, std::stoull(token)));
+            }
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--out FILE] [--size N] [--threads 1,2,4] [--runs 3]\n";
+            std::exit(2);
+        }
+    }
+    if(opt.threads.empty())
+    {
+        // 1, 2, 4, ... up to the number of cores
+        const std::size_t max_threads = flemu::default_concurrency();
+        for(std::size_t t=1; t<max_threads; t*=2) {opt.threads.push_back(t);}
+        opt.threads.push_back(max_threads);
+    }
+    return opt;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+    constexpr std::size_t k = 1000;
+
+    std::mt19937 rng(123456789);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::vector<flemu::float32> xs(opt.size);
+    for(auto& x : xs) {x = flemu::to_flemu(normal(rng));}
+
+    std::vector<result> results;
+    const auto report = [&](const std::string& op, const std::size_t threads, const double ns) {
+        results.push_back(result{op, threads, ns});
+        std::cerr << to_json(results.back()) << std::endl;
+    };
+
+    report("std_sort", 1, measure(xs, opt, [](std::vector<flemu::float32>& v) {
+        std::sort(v.begin(), v.end(), flemu::total_order_less{});
+    }));
+    report("std_partial_sort", 1, measure(xs, opt, [&](std::vector<flemu::float32>& v) {
+        std::partial_sort(v.begin(), v.begin() + std::min(k, v.size()), v.end(),
+                          [](const auto& x, const auto& y) {return flemu::total_order_less{}(y, x);});
+    }));
+    for(const std::size_t threads : opt.threads)
+    {
+        report("radix_sort", threads, measure(xs, opt, [&](std::vector<flemu::float32>& v) {
+            flemu::radix_sort(std::span<flemu::float32>(v), threads);
+        }));
+        report("top_k", threads, measure(xs, opt, [&](std::vector<flemu::float32>& v) {
+            const auto top = flemu::top_k(std::span<const flemu::float32>(v), k, threads);
+            v[0] = top.front();
+        }));
+        report("key_histogram", threads, measure(xs, opt, [&](std::vector<flemu::float32>& v) {
+            const auto h = flemu::key_histogram(std::span<const flemu::float32>(v), 9, threads);
+            v[0] = flemu::float32(static_cast<std::uint32_t>(h[256 + 127]));
+        }));
+    }
+
+    std::ostringstream json;
+    json << "{\"benchmark\": \"flemu_sort\", \"size\": " << opt.size << ", \"results\": [\n";
+    for(std::size_t i=0; i<results.size(); ++i)
+    {
+        json << "  " << to_json(results[i]) << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    json << "]}\n";
+
+    if(opt.out.empty())
+    {
+        std::cout << json.str();
+    }
+    else
+    {
+        std::ofstream(opt.out) << json.str();
+    }
+    return 0;
+}
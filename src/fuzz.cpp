@@ -0,0 +1,407 @@
+#include <flemu/adder.hpp>
+#include <flemu/work_stealing.hpp>
+
+#include <cfenv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Coverage-directed differential fuzzer of flemu::add (float32) against the
+// native float addition, in all the 4 deterministic rounding modes, results
+// and exception flags.
+//
+// Each input goes through add with a probe (see flemu::add_point) that reports
+// which way each decision in add went. The set of the decisions is the path of
+// the input. An input that takes a new path in any mode is added to the
+// corpus, and the workers mutate the entries of the corpus picked uniformly,
+// so the inputs of a rare path are mutated as often as those of a common one.
+// The mutations are made for floating-point: ulp steps, exponent gaps around
+// the width of the mantissa, near-cancellation, boundary exponents and
+// mantissas.
+//
+// flemu does not have signaling nans, so nans are made quiet before they are
+// compared.
+//
+// usage: fuzz [--threads N] [--time SEC] [--seed S] [--examples K]
+
+namespace
+{
+
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+using flemu::add_point;
+using flemu::add_point_names;
+using flemu::num_add_points;
+
+constexpr std::array<int, 4> modes = {FE_TONEAREST, FE_TOWARDZERO, FE_UPWARD, FE_DOWNWARD};
+constexpr std::array<const char*, 4> mode_names = {"nearest_even", "toward_zero", "toward_positive", "toward_negative"};
+
+struct options
+{
+    std::size_t threads  = flemu::default_concurrency();
+    double      time     = 60.0;
+    u64         seed     = 123456789;
+    std::size_t examples = 8;
+};
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--threads"  && has_value) {opt.threads  = std::max<std::size_t>(1, std::stoull(argv[++i]));}
+        else if(arg == "--time"     && has_value) {opt.time     = std::stod(argv[++i]);}
+        else if(arg == "--seed"     && has_value) {opt.seed     = std::stoull(argv[++i]);}
+        else if(arg == "--examples" && has_value) {opt.examples = std::stoull(argv[++i]);}
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--threads N] [--time SEC] [--seed S] [--examples K]\n";
+            std::exit(2);
+        }
+    }
+    return opt;
+}
+
+// sets the bits of the add_points taken.
+struct path_probe
+{
+    static constexpr bool enabled = true;
+    u64* path;
+
+    void operator()(const add_point p, const bool taken) const noexcept
+    {
+        *path |= taken ? u64(1) << static_cast<u32>(p) : 0u;
+    }
+};
+
+u32 flemu_flags(const int e) noexcept
+{
+    return ((e & FE_INVALID)   ? flemu::flag_invalid   : 0u) | ((e & FE_OVERFLOW) ? flemu::flag_overflow : 0u) |
+           ((e & FE_UNDERFLOW) ? flemu::flag_underflow : 0u) | ((e & FE_INEXACT)  ? flemu::flag_inexact  : 0u);
+}
+
+constexpr bool is_nan_bits(const u32 x) noexcept
+{
+    return (x & 0x7FFF'FFFFu) > 0x7F80'0000u;
+}
+
+constexpr u32 quiet(const u32 x) noexcept
+{
+    return is_nan_bits(x) ? (x | 0x0040'0000u) : x;
+}
+
+struct input
+{
+    u32 x, y;
+};
+
+struct result
+{
+    u32 z;
+    u32 flags;
+    u64 path;
+};
+
+template<typename Rounding>
+result run_flemu(const input in, const Rounding& rnd) noexcept
+{
+    result r{0, 0, 0};
+    r.z = flemu::detail::add_unrecorded(flemu::float32(in.x), flemu::float32(in.y), rnd,
+                                        flemu::flags::accumulate{r.flags}, path_probe{&r.path}).base();
+    return r;
+}
+
+result run_flemu(const input in, const std::size_t mode) noexcept
+{
+    switch(mode)
+    {
+        case 0:  return run_flemu(in, flemu::rounding::nearest_even{});
+        case 1:  return run_flemu(in, flemu::rounding::toward_zero{});
+        case 2:  return run_flemu(in, flemu::rounding::toward_positive{});
+        default: return run_flemu(in, flemu::rounding::toward_negative{});
+    }
+}
+
+// the native sum in the current rounding mode and its flags.
+result run_native(const input in) noexcept
+{
+    volatile float xr = flemu::bit_cast<float>(in.x);
+    volatile float yr = flemu::bit_cast<float>(in.y);
+    std::feclearexcept(FE_ALL_EXCEPT);
+    volatile float zr = xr + yr;
+    const u32 flags = flemu_flags(std::fetestexcept(FE_ALL_EXCEPT));
+    return result{flemu::bit_cast<u32>(static_cast<float>(zr)), flags, 0};
+}
+
+// ----------------------------------------------------------------------------
+// mutations
+
+class mutator
+{
+  public:
+
+    explicit mutator(const u64 seed): rng_(seed) {}
+
+    u32 bits() {return static_cast<u32>(rng_());}
+    u32 below(const u32 n) {return std::uniform_int_distribution<u32>(0, n - 1)(rng_);}
+
+    input mutate(input in)
+    {
+        const u32 count = 1 + below(3);
+        for(u32 i=0; i<count; ++i)
+        {
+            in = mutate_once(in);
+        }
+        return input{quiet(in.x), quiet(in.y)};
+    }
+
+  private:
+
+    static constexpr u32 sign_mask     = 0x8000'0000u;
+    static constexpr u32 exponent_mask = 0x7F80'0000u;
+    static constexpr u32 mantissa_mask = 0x007F'FFFFu;
+
+    static u32 with_exponent(const u32 v, const u32 e) noexcept
+    {
+        return (v & ~exponent_mask) | ((e & 0xFFu) << 23);
+    }
+
+    u32 boundary_mantissa()
+    {
+        constexpr std::array<u32, 10> ms = {
+            0x00'0000, 0x00'0001, 0x00'0002, 0x00'0003, 0x00'0004,
+            0x40'0000, 0x40'0001, 0x7F'FFFC, 0x7F'FFFE, 0x7F'FFFF,
+        };
+        return ms[below(ms.size())];
+    }
+
+    input mutate_once(input in)
+    {
+        u32& v = below(2) == 0 ? in.x : in.y;
+        const u32 other = (&v == &in.x) ? in.y : in.x;
+        switch(below(10))
+        {
+            case 0: // flip a bit
+                v ^= u32(1) << below(32);
+                break;
+            case 1: // a few ulps up or down
+                v += (below(2) == 0 ? 1u : u32(-1)) * (1u + below(8));
+                break;
+            case 2: // an exponent gap around the width of the extended mantissa
+            {
+                const int gap = int(below(32)) - 3;
+                const int e   = int((other & exponent_mask) >> 23) - gap;
+                v = with_exponent(v, u32(std::clamp(e, 0, 254)));
+                break;
+            }
+            case 3: // a boundary mantissa
+                v = (v & ~mantissa_mask) | boundary_mantissa();
+                break;
+            case 4: // near-cancellation
+                v = (other ^ sign_mask) + (below(2) == 0 ? 1u : u32(-1)) * below(4);
+                break;
+            case 5: // a boundary exponent
+            {
+                constexpr std::array<u32, 8> es = {0, 1, 2, 126, 127, 253, 254, 255};
+                v = with_exponent(v, es[below(es.size())]);
+                break;
+            }
+            case 6: // the other sign
+                v ^= sign_mask;
+                break;
+            case 7: // the mantissa of the other one, shifted
+                v = (v & ~mantissa_mask) | (((other & mantissa_mask) >> below(4)) & mantissa_mask);
+                break;
+            case 8: // low bits of the mantissa only, to make ties and sticky bits
+                v = (v & ~u32(0xFF)) | (bits() & 0xFFu & (0xFFu >> below(8)));
+                break;
+            default: // a fresh one
+                v = bits();
+                break;
+        }
+        return in;
+    }
+
+    std::mt19937_64 rng_;
+};
+
+// ----------------------------------------------------------------------------
+// shared state
+
+struct mismatch
+{
+    input       in;
+    std::size_t mode;
+    result      got;
+    result      expected;
+};
+
+struct corpus
+{
+    std::mutex                 mutex;
+    std::vector<input>         entries;
+    std::unordered_set<u64>    paths;   // path | (mode << 56)
+    std::vector<mismatch>      mismatches;
+    u64                        num_mismatches = 0;
+
+    // per mode, the points that have been taken and not taken
+    std::array<std::atomic<u64>, 4> taken{};
+    std::array<std::atomic<u64>, 4> not_taken{};
+};
+
+std::vector<input> seeds()
+{
+    constexpr std::array<u32, 12> values = {
+        0x0000'0000, 0x0000'0001, 0x007F'FFFF, 0x0080'0000, 0x0080'0001, 0x00FF'FFFF,
+        0x3F80'0000, 0x3FFF'FFFF, 0x7F7F'FFFF, 0x7F80'0000, 0x7FC0'0000, 0x4B80'0000,
+    };
+    std::vector<input> in;
+    for(const u32 x : values)
+    {
+        for(const u32 y : values)
+        {
+            in.push_back(input{x, y});
+            in.push_back(input{x, y ^ 0x8000'0000u});
+        }
+    }
+    return in;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+
+    corpus shared;
+    shared.entries = seeds();
+
+    std::atomic<u64> execs{0};
+    std::atomic<bool> done{false};
+    const auto start = std::chrono::steady_clock::now();
+    const auto elapsed = [&] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::cerr << "fuzz: " << opt.threads << " threads for " << opt.time << " s" << std::endl;
+
+    flemu::parallel_for(opt.threads, opt.threads, [&](const std::size_t worker, const std::size_t) {
+        mutator mut(opt.seed + 0x9E37'79B9'7F4A'7C15ull * (worker + 1));
+        std::vector<input> local;
+        std::unordered_set<u64> known;
+        std::size_t synced = 0;
+        auto last_report = std::chrono::steady_clock::now();
+
+        for(u64 iter=0; !done.load(std::memory_order_relaxed); ++iter)
+        {
+            // take the new entries of the corpus every so often
+            if(iter % 4096 == 0)
+            {
+                const std::lock_guard<std::mutex> lock(shared.mutex);
+                local.insert(local.end(), shared.entries.begin() + std::ptrdiff_t(synced), shared.entries.end());
+                synced = shared.entries.size();
+                known.insert(shared.paths.begin(), shared.paths.end());
+
+                if(elapsed() >= opt.time)
+                {
+                    done.store(true);
+                }
+                if(worker == 0 && std::chrono::steady_clock::now() - last_report > std::chrono::seconds(10))
+                {
+                    last_report = std::chrono::steady_clock::now();
+                    std::cerr << "fuzz: " << execs.load() << " inputs, " << shared.paths.size()
+                              << " paths, " << shared.num_mismatches << " mismatches" << std::endl;
+                }
+            }
+
+            const input in = (iter < local.size() && iter < 1024) ? local[iter] :
+                             mut.mutate(local[mut.below(u32(local.size()))]);
+            bool novel = false;
+            for(std::size_t m=0; m<modes.size(); ++m)
+            {
+                std::fesetround(modes[m]);
+                const result expected = run_native(in);
+                const result got      = run_flemu(in, m);
+
+                shared.taken[m].fetch_or(got.path, std::memory_order_relaxed);
+                shared.not_taken[m].fetch_or(~got.path, std::memory_order_relaxed);
+
+                const u64 key = got.path | (u64(m) << 56);
+                if(known.insert(key).second)
+                {
+                    const std::lock_guard<std::mutex> lock(shared.mutex);
+                    novel = shared.paths.insert(key).second || novel;
+                }
+
+                const bool same = (is_nan_bits(expected.z) ? is_nan_bits(got.z) : got.z == expected.z) &&
+                                  got.flags == expected.flags;
+                if(!same)
+                {
+                    const std::lock_guard<std::mutex> lock(shared.mutex);
+                    shared.num_mismatches += 1;
+                    if(shared.mismatches.size() < opt.examples)
+                    {
+                        shared.mismatches.push_back(mismatch{in, m, got, expected});
+                    }
+                    novel = novel || shared.num_mismatches <= 1024; // mutate around it
+                }
+            }
+            std::fesetround(FE_TONEAREST);
+            if(novel)
+            {
+                const std::lock_guard<std::mutex> lock(shared.mutex);
+                shared.entries.push_back(in);
+            }
+            execs.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // ------------------------------------------------------------------------
+    // report
+
+    const double seconds = elapsed();
+    for(const auto& m : shared.mismatches)
+    {
+        std::printf("%s: %s + %s = %s (flags %u), expected %s (flags %u)\n", mode_names[m.mode],
+            flemu::format_bits(m.in.x).data(), flemu::format_bits(m.in.y).data(),
+            flemu::format_bits(m.got.z).data(), m.got.flags,
+            flemu::format_bits(m.expected.z).data(), m.expected.flags);
+        std::printf("    path:");
+        for(std::size_t p=0; p<num_add_points; ++p)
+        {
+            if((m.got.path >> p) & 1u) {std::printf(" %s", add_point_names[p]);}
+        }
+        std::printf("\n");
+    }
+    for(std::size_t m=0; m<modes.size(); ++m)
+    {
+        const u64 taken = shared.taken[m].load(), not_taken = shared.not_taken[m].load();
+        std::printf("%s: never taken:", mode_names[m]);
+        for(std::size_t p=0; p<num_add_points; ++p)
+        {
+            if(((taken >> p) & 1u) == 0) {std::printf(" %s", add_point_names[p]);}
+            if(((not_taken >> p) & 1u) == 0) {std::printf(" !%s", add_point_names[p]);}
+        }
+        std::printf("\n");
+    }
+    std::printf("inputs: %llu, corpus: %zu, paths: %zu, mismatches: %llu\n",
+                static_cast<unsigned long long>(execs.load()), shared.entries.size(), shared.paths.size(),
+                static_cast<unsigned long long>(shared.num_mismatches));
+    std::printf("elapsed: %.1f s, %.3g inputs/s\n", seconds,
+                seconds == 0.0 ? 0.0 : static_cast<double>(execs.load()) / seconds);
+    return shared.num_mismatches == 0 ? 0 : 1;
+}
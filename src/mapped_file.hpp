@@ -0,0 +1,93 @@
+#ifndef FLEMU_MAPPED_FILE_HPP
+#define FLEMU_MAPPED_FILE_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+
+#include <string>
+
+// memory mapping of a whole file for the tools. the kernel reads the pages of
+// an input on demand and writes back the pages of an output, so the tools
+// work on the mapping directly without copying it into buffers.
+
+namespace flemu::tools
+{
+
+class mapped_file
+{
+  public:
+
+    // maps an existing file read-only.
+    explicit mapped_file(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            return;
+        }
+        struct stat st;
+        if(::fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            map(fd, static_cast<std::size_t>(st.st_size), PROT_READ);
+            if(data_ != nullptr)
+            {
+                ::madvise(data_, size_, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+    }
+
+    // creates (or truncates) a file of `size` bytes and maps it writable.
+    mapped_file(const std::string& path, const std::size_t size)
+    {
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0)
+        {
+            return;
+        }
+        if(size != 0 && ::ftruncate(fd, static_cast<off_t>(size)) == 0)
+        {
+            map(fd, size, PROT_READ | PROT_WRITE);
+        }
+        ::close(fd);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    ~mapped_file()
+    {
+        if(data_ != nullptr)
+        {
+            ::munmap(data_, size_);
+        }
+    }
+
+    // nullptr if the file could not be mapped (or is empty).
+    unsigned char*       data()       noexcept {return static_cast<unsigned char*>(data_);}
+    const unsigned char* data() const noexcept {return static_cast<const unsigned char*>(data_);}
+    std::size_t          size() const noexcept {return size_;}
+
+  private:
+
+    void map(const int fd, const std::size_t size, const int prot) noexcept
+    {
+        void* p = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+        if(p != MAP_FAILED)
+        {
+            data_ = p;
+            size_ = size;
+        }
+    }
+
+  private:
+
+    void*       data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // flemu::tools
+#endif // FLEMU_MAPPED_FILE_HPP
@@ -0,0 +1,438 @@
+#include <flemu/adder.hpp>
+#include "bench_inputs.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// microbenchmark of the scalar add for each class of inputs. it compares the
+// current branch-free implementation with the previous branchy one, kept
+// below as flemu::legacy::add, and with the current one under
+// assume::finite_ftz_daz (see flemu/assumptions.hpp; "-" for the classes that
+// have inf or nan, which it does not allow).
+
+namespace flemu::legacy
+{
+
+inline float32 add(const float32& x_, const float32& y_) noexcept
+{
+    // ------------------------------------------------------------------------
+    // always make x <= y
+    const auto [x, y] = [&]
+    {
+        if(x_.exponent() == y_.exponent())
+        {
+            if(x_.mantissa() < y_.mantissa())
+            {
+                return std::make_pair(x_, y_);
+            }
+            else
+            {
+                return std::make_pair(y_, x_);
+            }
+        }
+        else
+        {
+            if(x_.exponent() < y_.exponent())
+            {
+                return std::make_pair(x_, y_);
+            }
+            else
+            {
+                return std::make_pair(y_, x_);
+            }
+        }
+    }();
+
+    const std::uint32_t xsgn(x.sign());
+    const std::uint32_t xexp(x.exponent());
+    const std::uint32_t xman(x.mantissa());
+
+    const std::uint32_t ysgn(y.sign());
+    const std::uint32_t yexp(y.exponent());
+    const std::uint32_t yman(y.mantissa());
+
+    // ------------------------------------------------------------------------
+    // check special values
+    const auto xinf  = (xexp == 0b1111'1111) && (xman == 0);
+    const auto yinf  = (yexp == 0b1111'1111) && (yman == 0);
+    const auto xnan  = (xexp == 0b1111'1111) && (xman != 0);
+    const auto ynan  = (yexp == 0b1111'1111) && (yman != 0);
+    const auto xzero = (xexp == 0) && (xman == 0);
+    const auto yzero = (yexp == 0) && (yman == 0);
+    const auto xdenorm = (xexp == 0) && (xman != 0);
+    const auto ydenorm = (yexp == 0) && (yman != 0);
+
+    if(xnan || ynan) // z + nan == nan,  nan + z == nan
+    {
+        return float32(0b0, 0b1111'1111, 0b1);
+    }
+    else if (xinf || yinf)
+    {
+        if(xinf && yinf)
+        {
+            if(xsgn != ysgn) // inf - inf == nan, -inf + inf == nan
+            {
+                return float32(0b0, 0b1111'1111, 0b1);
+            }
+            else // inf + inf == inf, -inf + (-inf) = -inf
+            {
+                return float32(std::uint32_t(xsgn), 0b1111'1111, 0b0);
+            }
+        }
+        else if((xinf && xsgn == 0) || (yinf && ysgn == 0)) // inf + * == inf
+        {
+            return float32(0b0, 0b1111'1111, 0b0);
+        }
+        else  // -inf + * == -inf
+        {
+            return float32(0b1, 0b1111'1111, 0b0);
+        }
+    }
+    else if (xzero || yzero)
+    {
+        if(xzero && yzero)
+        {
+            // we here consider only nearest-(even)-rounding.
+            // (+0) + (-0) == (+0), (-0) + (-0) == (-0).
+            // in case of negative-inf-rounding, (+0) + (-0) should be (-0).
+            return float32(std::uint32_t(xsgn & ysgn), 0u, 0u);
+        }
+        else if (xzero)
+        {
+            return y;
+        }
+        else // yzero
+        {
+            return x;
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // align mantissa (always x.exp <= y.exp)
+
+    const auto [xman_aligned, yman_aligned, xexp_norm, yexp_norm] = [&]
+    {
+        std::uint32_t xexp_norm = xexp;
+        std::uint32_t yexp_norm = yexp;
+        std::uint32_t xman_aligned = (1 << 23);
+        std::uint32_t yman_aligned = (1 << 23);
+
+        if(xdenorm)
+        {
+            xman_aligned = 0; // remove implicit 1
+            xexp_norm   += 1;
+        }
+        if(ydenorm)
+        {
+            yman_aligned = 0;
+            yexp_norm   += 1;
+        }
+
+        xman_aligned += std::uint32_t(xman);
+        yman_aligned += std::uint32_t(yman);
+        xman_aligned <<= 3;
+        yman_aligned <<= 3;
+
+        if(xexp_norm == yexp_norm)
+        {
+            return std::make_tuple(xman_aligned, yman_aligned, xexp_norm, yexp_norm);
+        }
+        // exponent is different
+        const std::uint32_t expdiff = std::uint32_t(yexp_norm) - std::uint32_t(xexp_norm);
+
+        //         mantissa      additional bits
+        //    .---------------. .---.
+        // y:| 1.xxxxxxxxxxxxxx|0|0|0|
+        // x:     | 1.xxxxxxxxx|x|x|x|x|x|0|0|0| >> expdiff == e.g. 5
+        //                      | | | '-------'
+        //                      | | |  sticky region
+        //                      | | + sticky bit
+        //                      | + round bit
+        //                      + guard bit
+
+        if(expdiff >= 27) // 1 + 23 + 3
+        {
+            xman_aligned = 0;
+        }
+        else
+        {
+            std::uint32_t sticky = 0;
+            if(expdiff > 3)
+            {
+                const auto sticky_region = xman_aligned & mask<std::uint32_t>(expdiff - 1, 0);
+                sticky = (sticky_region == 0) ? 0 : 1;
+            }
+            xman_aligned >>= expdiff;
+            xman_aligned |= sticky;
+        }
+        return std::make_tuple(xman_aligned, yman_aligned, xexp_norm, yexp_norm);
+    }();
+
+//     std::cerr << "xman_aligned = " << as_bit(xman_aligned) << std::endl;
+//     std::cerr << "yman_aligned = " << as_bit(yman_aligned) << std::endl;
+
+    // ------------------------------------------------------------------------
+    // add/sub mantissa and round
+
+    //           26 25       22 ...  03 02 01 00
+    // y: | 0...| 1| z| z| z| z|... | z| 0| 0| 0|
+    // x: | 0...| 0| 0| 0| 1| z|... | z| z| z| z|
+    //             '-------------------' |  |  +- sticky
+    //                   mantissa        |  +---- round
+    //                                   +------- guard
+
+    std::uint32_t zsgn(ysgn);
+    std::uint32_t zexp(yexp_norm);
+    if(xsgn != ysgn) // subtract. always abs(x) < abs(y), so the sign is y.
+    {
+        std::uint32_t zman = yman_aligned - xman_aligned;
+
+        if(zman == 0)
+        {
+            // zero cannot be normalized. under nearest-(even)-rounding,
+            // x - x is always (+0) regardless of the sign of x.
+            return float32(0u, 0u, 0u);
+        }
+
+        while(bit_at(zman, 26) == 0)
+        {
+            zexp  -= 1;
+            if(zexp == 0)
+            {
+                // since it becomes denormalized number, we don't need to
+                // normalize it.
+                break;
+            }
+            zman <<= 1;
+        }
+
+        if(zexp == 0)
+        {
+            // if it is 0.111...111, then it will be 1.00 after rounding and
+            // will become normalized.
+            if((zman & mask<std::uint32_t>(25, 2)) >> 2 == (1<<24)-1)
+            {
+                return float32(zsgn, std::uint32_t(1), std::uint32_t(0));
+            }
+        }
+
+        // consider nearest-even rounding only
+        if(bit_at(zman, 2) == 1)
+        {
+            if(bit_at(zman, 1) == 0 && bit_at(zman, 0) == 0) // to even
+            {
+                if(bit_at(zman, 3) == 0)
+                {
+                    // already even. do nothing.
+                }
+                else // its odd.
+                {
+                    zman += 0b1000;
+                }
+            }
+            else // to nearest (upper)
+            {
+                zman += 0b1000;
+            }
+        }
+
+        // check carry-up by rounding (1.11111 -> 10.0000)
+        // 10.0000e+2 == 1.0000e+3
+        if(bit_at(zman, 27) == 1)
+        {
+            zexp  += 1;
+            zman >>= 1;
+        }
+        assert(bit_at(zman, 26) == 1 || zexp == 0); // normalized?
+
+        if(zexp == 0b1111'1111)
+        {
+            // it was not nan, so here it should be inf
+            zman = 0;
+        }
+        return float32(zsgn, zexp, std::uint32_t(bit_proxy(zman, 25, 3)));
+    }
+    else // add.
+    {
+        assert(bit_at(xman_aligned, 27) == 0);
+        assert(bit_at(yman_aligned, 27) == 0);
+        std::uint32_t zman = yman_aligned + xman_aligned;
+
+        // check carry-up by addition
+        if(bit_at(zman, 27) == 1)
+        {
+            // if we shift before checking round, the sticky bit will be lost.
+
+            if(bit_at(zman, 3) == 1) // need to round up.
+            {
+                if(bit_at(zman, 2) == 0 && bit_at(zman, 1) == 0 && bit_at(zman, 0) == 0) // to even
+                {
+                    if(bit_at(zman, 4) == 0)
+                    {
+                        // already even. do nothing.
+                    }
+                    else
+                    {
+                        zman += 0b1'0000;
+                    }
+                }
+                else // to nearest (upper)
+                {
+                    zman += 0b1'0000;
+                }
+            }
+            if(bit_at(zman, 28) == 1)
+            {
+                zexp  += 2;
+                zman >>= 2;
+            }
+            else if(bit_at(zman, 27) == 1)
+            {
+                zexp  += 1;
+                zman >>= 1;
+            }
+            else
+            {
+                assert(false);
+            }
+        }
+        else
+        {
+            if(bit_at(zman, 2) == 1) // need to round up.
+            {
+                if(bit_at(zman, 1) == 0 && bit_at(zman, 0) == 0) // to even
+                {
+                    if(bit_at(zman, 3) == 0)
+                    {
+                        // already even. do nothing.
+                    }
+                    else
+                    {
+                        zman += 0b1000;
+                    }
+                }
+                else // to nearest (upper)
+                {
+                    zman += 0b1000;
+                }
+            }
+            // check carry-up by rounding.
+            if(bit_at(zman, 27) == 1)
+            {
+                zexp  += 1;
+                zman >>= 1;
+            }
+        }
+        if(bit_at(zman, 26) == 0)
+        {
+            // denorm + denorm without carry-up is still denormalized.
+            assert(zexp == 1);
+            zexp = 0;
+        }
+
+        if(zexp >= 0b1111'1111)
+        {
+            // it was not nan, so here it should be inf
+            zman = 0;
+        }
+        return float32(zsgn, zexp, std::uint32_t(bit_proxy(zman, 25, 3)));
+    }
+}
+
+} // flemu::legacy
+
+namespace
+{
+
+// the compiler does not know that it is zero.
+volatile std::uint32_t opaque_zero = 0;
+
+template<typename F>
+double throughput_ns(F f, const std::vector<flemu::float32>& xs,
+                     const std::vector<flemu::float32>& ys, std::vector<flemu::float32>& zs,
+                     const std::size_t repeat)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for(std::size_t r=0; r<repeat; ++r)
+    {
+        for(std::size_t i=0; i<xs.size(); ++i)
+        {
+            zs[i] = f(xs[i], ys[i]);
+        }
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (repeat * xs.size());
+}
+
+// each add depends on the previous result, but the inputs keep their class.
+template<typename F>
+double latency_ns(F f, const std::vector<flemu::float32>& xs,
+                  const std::vector<flemu::float32>& ys, std::uint32_t& sink,
+                  const std::size_t repeat)
+{
+    const std::uint32_t zero = opaque_zero;
+    flemu::float32 z(0u);
+    const auto start = std::chrono::steady_clock::now();
+    for(std::size_t r=0; r<repeat; ++r)
+    {
+        for(std::size_t i=0; i<xs.size(); ++i)
+        {
+            z = f(flemu::float32(xs[i].base() ^ (z.base() & zero)), ys[i]);
+        }
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    sink ^= z.base();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (repeat * xs.size());
+}
+
+} // anonymous
+
+int main()
+{
+    const std::size_t N      = 1 << 14;
+    const std::size_t repeat = 200;
+
+    const auto add_legacy  = [](const flemu::float32& x, const flemu::float32& y) {return flemu::legacy::add(x, y);};
+    const auto add_current = [](const flemu::float32& x, const flemu::float32& y) {return flemu::add(x, y);};
+    const auto add_assume  = [](const flemu::float32& x, const flemu::float32& y) {
+        return flemu::add(x, y, flemu::rounding::nearest_even{}, flemu::flags::ignore{},
+                          flemu::assume::finite_ftz_daz{});
+    };
+
+    std::mt19937 rng(123456789);
+    std::uint32_t sink = 0;
+
+    std::printf("%-14s %12s %12s %12s %12s %12s %12s  [ns/op]\n", "class",
+                "thr:legacy", "thr:current", "thr:assume", "lat:legacy", "lat:current", "lat:assume");
+    for(const auto& cls : flemu::bench::input_classes())
+    {
+        std::vector<flemu::float32> xs, ys, zs(N);
+        flemu::bench::generate(cls, rng, N, xs, ys);
+        const double thr_legacy  = throughput_ns(add_legacy,  xs, ys, zs, repeat);
+        sink ^= zs.back().base();
+        const double thr_current = throughput_ns(add_current, xs, ys, zs, repeat);
+        sink ^= zs.back().base();
+        const double lat_legacy  = latency_ns(add_legacy,  xs, ys, sink, repeat);
+        const double lat_current = latency_ns(add_current, xs, ys, sink, repeat);
+
+        const auto is_finite = [](const flemu::float32& x) {return flemu::satisfies<flemu::assume::finite>(x);};
+        const bool finite    = std::all_of(xs.begin(), xs.end(), is_finite) && std::all_of(ys.begin(), ys.end(), is_finite);
+        char thr_assume[16] = "-";
+        char lat_assume[16] = "-";
+        if(finite)
+        {
+            std::snprintf(thr_assume, sizeof(thr_assume), "%.3f", throughput_ns(add_assume, xs, ys, zs, repeat));
+            sink ^= zs.back().base();
+            std::snprintf(lat_assume, sizeof(lat_assume), "%.3f", latency_ns(add_assume, xs, ys, sink, repeat));
+        }
+
+        std::printf("%-14s %12.3f %12.3f %12s %12.3f %12.3f %12s\n", cls.name,
+                    thr_legacy, thr_current, thr_assume, lat_legacy, lat_current, lat_assume);
+    }
+    return sink == 0xDEAD'BEEF ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+#include <flemu/convert.hpp>
+#include <flemu/quantize.hpp>
+#include <flemu/reduce.hpp>
+#include <flemu/work_stealing.hpp>
+#include "mapped_file.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <iostream>
+#include <span>
+#include <string>
+
+// Quantizes a binary file of float32 values (raw, in the byte order of the
+// machine) to an emulated format and reports the error.
+//
+// The input and the output are mapped into memory, and the chunks of the
+// input are converted on all cores directly into the mapping of the output.
+// The output has the values either in the storage of the format (`packed`, 1,
+// 2 or 4 bytes per value) or converted back to float32 (`float32`), to be
+// read by code that does not know the format.
+//
+// With --sum, it also adds up the output with flemu::reduce (pairwise), in
+// the format of the output, and compares it with the sum of the input in double.
+//
+// usage: quantize IN OUT --format bfloat16|float16|tfloat32|float8_e5m2|float8_e4m3
+//                 [--rounding nearest_even|toward_zero|toward_positive|toward_negative|stochastic]
+//                 [--seed S] [--output packed|float32] [--threads N] [--sum]
+
+namespace
+{
+
+struct options
+{
+    std::string   input;
+    std::string   output;
+    std::string   format;
+    std::string   rounding = "nearest_even";
+    std::string   layout   = "packed";
+    std::uint32_t seed     = 0;
+    std::size_t   threads  = flemu::default_concurrency();
+    bool          sum      = false;
+};
+
+[[noreturn]] void usage(const char* argv0)
+{
+    std::cerr << "usage: " << argv0 << " IN OUT --format bfloat16|float16|tfloat32|float8_e5m2|float8_e4m3\n"
+              << "    [--rounding nearest_even|toward_zero|toward_positive|toward_negative|stochastic]\n"
+              << "    [--seed S] [--output packed|float32] [--threads N] [--sum]\n";
+    std::exit(2);
+}
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--format"   && has_value) {opt.format   = argv[++i];}
+        else if(arg == "--rounding" && has_value) {opt.rounding = argv[++i];}
+        else if(arg == "--output"   && has_value) {opt.layout   = argv[++i];}
+        else if(arg == "--seed"     && has_value) {opt.seed     = static_cast<std::uint32_t>(std::stoul(argv[++i]));}
+        else if(arg == "--threads"  && has_value) {opt.threads  = std::max<std::size_t>(1, std::stoull(argv[++i]));}
+        else if(arg == "--sum")                   {opt.sum      = true;}
+        else if(!arg.starts_with("--") && opt.input.empty())  {opt.input  = arg;}
+        else if(!arg.starts_with("--") && opt.output.empty()) {opt.output = arg;}
+        else {usage(argv[0]);}
+    }
+    if(opt.input.empty() || opt.output.empty() || opt.format.empty() ||
+       (opt.layout != "packed" && opt.layout != "float32"))
+    {
+        usage(argv[0]);
+    }
+    return opt;
+}
+
+template<typename To, typename Out, typename Rounding>
+int run(const options& opt, const Rounding& rnd)
+{
+    const flemu::tools::mapped_file in(opt.input);
+    if(in.data() == nullptr || in.size() % sizeof(float) != 0)
+    {
+        std::cerr << "error: cannot map " << opt.input << " as an array of float32" << std::endl;
+        return 2;
+    }
+    const std::size_t n = in.size() / sizeof(float);
+    flemu::tools::mapped_file out(opt.output, n * sizeof(Out));
+    if(out.data() == nullptr)
+    {
+        std::cerr << "error: cannot create " << opt.output << std::endl;
+        return 2;
+    }
+    // float32 and the formats are a single unsigned integer; the mappings are page-aligned.
+    const std::span<const flemu::float32> x(reinterpret_cast<const flemu::float32*>(in.data()), n);
+    const std::span<Out> q(reinterpret_cast<Out*>(out.data()), n);
+
+    const auto start = std::chrono::steady_clock::now();
+    const flemu::quantization_stats stats = flemu::quantize<To>(x, q, rnd, opt.threads);
+    const double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+    std::printf("values: %zu, nonfinite: %llu, overflows: %llu\n", n,
+                static_cast<unsigned long long>(stats.nonfinite),
+                static_cast<unsigned long long>(stats.overflows));
+    std::printf("max error: %.4f ulp, rms error: %.6g\n", stats.max_ulp, stats.rms());
+    std::printf("elapsed: %.3f s, %.3g values/s, %.3f GB/s read, %.3f GB/s written\n", elapsed,
+                elapsed == 0.0 ? 0.0 : static_cast<double>(n) / elapsed,
+                elapsed == 0.0 ? 0.0 : static_cast<double>(in.size()) / elapsed * 1.0e-9,
+                elapsed == 0.0 ? 0.0 : static_cast<double>(out.size()) / elapsed * 1.0e-9);
+
+    if(opt.sum)
+    {
+        double reference = 0.0;
+        for(const auto v : x) {reference += static_cast<double>(flemu::to_float(v));}
+
+        const Out s = flemu::reduce(std::span<const Out>(q), flemu::reduction::pairwise{}, opt.threads);
+        const double sum = static_cast<double>(flemu::to_float(flemu::convert<flemu::float32>(s)));
+        std::printf("sum: %.9g, sum of the input in double: %.9g, relative error: %.3g\n",
+                    sum, reference, reference == 0.0 ? 0.0 : (sum - reference) / reference);
+    }
+    return 0;
+}
+
+template<typename To, typename Rounding>
+int run(const options& opt, const Rounding& rnd)
+{
+    return (opt.layout == "packed") ? run<To, To>(opt, rnd) : run<To, flemu::float32>(opt, rnd);
+}
+
+template<typename To>
+int run(const options& opt)
+{
+    namespace rounding = flemu::rounding;
+    if(opt.rounding == "nearest_even")    {return run<To>(opt, rounding::nearest_even{});}
+    if(opt.rounding == "toward_zero")     {return run<To>(opt, rounding::toward_zero{});}
+    if(opt.rounding == "toward_positive") {return run<To>(opt, rounding::toward_positive{});}
+    if(opt.rounding == "toward_negative") {return run<To>(opt, rounding::toward_negative{});}
+    if(opt.rounding == "stochastic")
+    {
+        return run<To>(opt, rounding::stochastic<rounding::hash_rng>{{opt.seed}});
+    }
+    std::cerr << "error: unknown rounding: " << opt.rounding << std::endl;
+    return 2;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+
+    if(opt.format == "bfloat16")    {return run<flemu::bfloat16>(opt);}
+    if(opt.format == "float16")     {return run<flemu::float16>(opt);}
+    if(opt.format == "tfloat32")    {return run<flemu::tfloat32>(opt);}
+    if(opt.format == "float8_e5m2") {return run<flemu::float8_e5m2>(opt);}
+    if(opt.format == "float8_e4m3") {return run<flemu::float8_e4m3>(opt);}
+    std::cerr << "error: unknown format: " << opt.format << std::endl;
+    return 2;
+}
@@ -0,0 +1,232 @@
+#include <flemu/adder.hpp>
+#include <flemu/fma.hpp>
+#include <flemu/recorder.hpp>
+#include <flemu/work_stealing.hpp>
+#include "mapped_file.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Replays a file written by flemu::recorder and reports the records whose
+// result differs from the one computed by this build of flemu.
+//
+// The file is mapped into memory and split into chunks of records that are
+// replayed on all cores. Records that cannot be replayed (a format that is not
+// one of the predefined ones, stochastic rounding) are counted as skipped.
+//
+// usage: replay FILE [--threads N] [--examples K]
+
+namespace
+{
+
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+using flemu::recorder::record;
+
+constexpr std::size_t chunk_records = std::size_t(1) << 16;
+
+struct options
+{
+    std::string path;
+    std::size_t threads  = flemu::default_concurrency();
+    std::size_t examples = 8;
+};
+
+struct divergence
+{
+    u64 index;
+    record r;
+    u32 replayed;
+};
+
+struct chunk_result
+{
+    u64 skipped = 0;
+    u64 diverged = 0;
+    std::vector<divergence> examples;
+};
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--threads"  && has_value) {opt.threads  = std::max<std::size_t>(1, std::stoull(argv[++i]));}
+        else if(arg == "--examples" && has_value) {opt.examples = std::stoull(argv[++i]);}
+        else if(opt.path.empty() && !arg.starts_with("--")) {opt.path = arg;}
+        else
+        {
+            opt.path.clear();
+            break;
+        }
+    }
+    if(opt.path.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " FILE [--threads N] [--examples K]\n";
+        std::exit(2);
+    }
+    return opt;
+}
+
+const char* format_name(const std::uint16_t format) noexcept
+{
+    using flemu::recorder::format_code;
+    switch(format)
+    {
+        case format_code<flemu::float32>:     return "float32";
+        case format_code<flemu::tfloat32>:    return "tfloat32";
+        case format_code<flemu::float16>:     return "float16";
+        case format_code<flemu::bfloat16>:    return "bfloat16";
+        case format_code<flemu::float8_e5m2>: return "float8_e5m2";
+        case format_code<flemu::float8_e4m3>: return "float8_e4m3";
+        default:                              return "unknown";
+    }
+}
+
+template<typename Float, typename Rounding>
+std::optional<u32> execute(const record& r, const Rounding& rnd) noexcept
+{
+    using base_type = typename Float::base_type;
+    const Float a(static_cast<base_type>(r.a));
+    const Float b(static_cast<base_type>(r.b));
+    const Float c(static_cast<base_type>(r.c));
+    switch(r.op)
+    {
+        case flemu::recorder::opcode::add: return u32(flemu::add(a, b, rnd).base());
+        case flemu::recorder::opcode::fma: return u32(flemu::fma(a, b, c, rnd).base());
+        default:                           return std::nullopt;
+    }
+}
+
+template<typename Float>
+std::optional<u32> execute(const record& r) noexcept
+{
+    using flemu::recorder::rounding_id;
+    switch(r.rounding)
+    {
+        case rounding_id::nearest_even:    return execute<Float>(r, flemu::rounding::nearest_even{});
+        case rounding_id::toward_zero:     return execute<Float>(r, flemu::rounding::toward_zero{});
+        case rounding_id::toward_positive: return execute<Float>(r, flemu::rounding::toward_positive{});
+        case rounding_id::toward_negative: return execute<Float>(r, flemu::rounding::toward_negative{});
+        default:                           return std::nullopt;
+    }
+}
+
+// the result of r computed again, or nullopt if it cannot be replayed.
+std::optional<u32> execute(const record& r) noexcept
+{
+    using flemu::recorder::format_code;
+    switch(r.format)
+    {
+        case format_code<flemu::float32>:     return execute<flemu::float32>(r);
+        case format_code<flemu::tfloat32>:    return execute<flemu::tfloat32>(r);
+        case format_code<flemu::float16>:     return execute<flemu::float16>(r);
+        case format_code<flemu::bfloat16>:    return execute<flemu::bfloat16>(r);
+        case format_code<flemu::float8_e5m2>: return execute<flemu::float8_e5m2>(r);
+        case format_code<flemu::float8_e4m3>: return execute<flemu::float8_e4m3>(r);
+        default:                              return std::nullopt;
+    }
+}
+
+chunk_result replay_chunk(const record* records, const u64 first, const std::size_t n,
+                          const options& opt)
+{
+    chunk_result result;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        const record& r = records[i];
+        const auto z = execute(r);
+        if(!z)
+        {
+            result.skipped += 1;
+        }
+        else if(*z != r.result)
+        {
+            result.diverged += 1;
+            if(result.examples.size() < opt.examples)
+            {
+                result.examples.push_back(divergence{first + i, r, *z});
+            }
+        }
+    }
+    return result;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+
+    const flemu::tools::mapped_file file(opt.path);
+    const flemu::recorder::file_header expected;
+    if(file.data() == nullptr || file.size() < sizeof(expected) ||
+       std::memcmp(file.data(), &expected, sizeof(expected)) != 0)
+    {
+        std::cerr << "error: " << opt.path << " is not a record file of this version" << std::endl;
+        return 2;
+    }
+    if((file.size() - sizeof(expected)) % sizeof(record) != 0)
+    {
+        std::cerr << "warning: " << opt.path << " ends with a partial record; it is ignored" << std::endl;
+    }
+    // the header is 16 bytes and the mapping is page-aligned, so the records are aligned.
+    const record* records = reinterpret_cast<const record*>(file.data() + sizeof(expected));
+    const std::size_t num_records = (file.size() - sizeof(expected)) / sizeof(record);
+    const std::size_t num_chunks  = (num_records + chunk_records - 1) / chunk_records;
+
+    std::cerr << "replay: " << num_records << " records on " << opt.threads << " threads" << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<chunk_result> results(num_chunks);
+    flemu::parallel_for(num_chunks, std::min(opt.threads, std::max<std::size_t>(num_chunks, 1)),
+        [&](const std::size_t c, const std::size_t) {
+            const std::size_t first = c * chunk_records;
+            results[c] = replay_chunk(records + first, first,
+                                      std::min(chunk_records, num_records - first), opt);
+        });
+    const double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+    // ------------------------------------------------------------------------
+    // report. the chunks are in order, so are the examples.
+
+    u64 skipped = 0, diverged = 0;
+    std::size_t shown = 0;
+    for(const auto& res : results)
+    {
+        skipped  += res.skipped;
+        diverged += res.diverged;
+        for(const auto& d : res.examples)
+        {
+            if(shown == opt.examples) {break;}
+            shown += 1;
+
+            const bool is_fma = d.r.op == flemu::recorder::opcode::fma;
+            std::printf("#%llu %s %s(%s, %s%s%s) = %s, replayed %s\n",
+                static_cast<unsigned long long>(d.index), format_name(d.r.format),
+                is_fma ? "fma" : "add",
+                flemu::format_bits(d.r.a).data(), flemu::format_bits(d.r.b).data(),
+                is_fma ? ", " : "", is_fma ? flemu::format_bits(d.r.c).data() : "",
+                flemu::format_bits(d.r.result).data(), flemu::format_bits(d.replayed).data());
+        }
+    }
+    std::printf("records: %zu, replayed: %llu, skipped: %llu, divergences: %llu\n", num_records,
+                static_cast<unsigned long long>(num_records - skipped),
+                static_cast<unsigned long long>(skipped),
+                static_cast<unsigned long long>(diverged));
+    std::printf("elapsed: %.2f s, %.3g records/s\n", elapsed,
+                elapsed == 0.0 ? 0.0 : static_cast<double>(num_records) / elapsed);
+    return diverged == 0 ? 0 : 1;
+}
@@ -1,6 +1,3 @@
-#include <flemu/utility.hpp>
-#include <flemu/bit_proxy.hpp>
-#include <flemu/float32.hpp>
-#include <flemu/adder.hpp>
-
+// the tests are in tests/, one translation unit per header; boost::ut runs
+// the suites that they register when the program exits.
 int main(){}
@@ -0,0 +1,456 @@
+#include <flemu/adder.hpp>
+#include <flemu/counters.hpp>
+#include <flemu/operation_trace.hpp>
+#include "test_detail.hpp"
+
+#include <boost/ut.hpp>
+
+#include <cfenv>
+#include <cmath>
+#include <cstdint>
+
+#include <random>
+
+// the number of random pairs compared with the hardware. it can be raised to
+// 10^9 or so for a long verification run, e.g. -DFLEMU_ADD_TEST_ITERATIONS=1000000000.
+#ifndef FLEMU_ADD_TEST_ITERATIONS
+#define FLEMU_ADD_TEST_ITERATIONS 10000
+#endif
+
+namespace flemu
+{
+
+boost::ut::suite tests_adder = []
+{
+    using namespace boost::ut::literals;
+
+    "add(float32, float32)"_test = []
+    {
+        const auto x1 = to_flemu(1.0f);
+        const auto y1 = to_flemu(1.0f);
+        const auto z1 = add(x1, y1);
+
+        boost::ut::expect(to_float(z1) == 2.0f);
+
+//         std::cout << to_float(x1) << " + " << to_float(y1) << " = " << to_float(z1) << " != 2.0f"<< std::endl;
+//         std::cout << z1.sign() << "|" << z1.exponent() << "|" << z1.mantissa() << std::endl;
+//         std::cout << "========================================================================" << std::endl;
+
+        const auto x2 = to_flemu( 1.0f);
+        const auto y2 = to_flemu(10.0f);
+        const auto z2 = add(x2, y2);
+
+        boost::ut::expect(to_float(z2) == 11.0f);
+
+//         std::cout << to_float(x2) << " + " << to_float(y2) << " = " << to_float(z2) << " != 11.0f"<< std::endl;
+//         std::cout << z2.sign() << "|" << z2.exponent() << "|" << z2.mantissa() << std::endl;
+//         std::cout << "========================================================================" << std::endl;
+
+        const auto x3 = to_flemu(1.0e-30f);
+        const auto y3 = to_flemu(1.0e+30f);
+        const auto z3 = add(x3, y3);
+
+        boost::ut::expect(to_float(z3) == 1.0e+30f);
+
+//         std::cout << to_float(x3) << " + " << to_float(y3) << " = " << to_float(z3) << " != 1.0e+30f"<< std::endl;
+//         std::cout << z3.sign() << "|" << z3.exponent() << "|" << z3.mantissa() << std::endl;
+//         std::cout << "========================================================================" << std::endl;
+
+        std::mt19937 rng(123456789);
+
+        std::uniform_int_distribution<std::uint32_t> sgn(0,   1);
+        std::uniform_int_distribution<std::uint32_t> exp(0, 255); // not including denormalized
+        std::uniform_int_distribution<std::uint32_t> man(0, 0x007F'FFFF);
+
+        // only the bits are recorded in the loop; they are formatted if it fails.
+        operation_trace<std::uint32_t, 2> trace("add");
+
+        const std::size_t N = FLEMU_ADD_TEST_ITERATIONS;
+        for(std::size_t i=0; i<N; ++i)
+        {
+            const std::uint32_t xi = (sgn(rng) << 31) + (exp(rng) << 23) + man(rng);
+            const std::uint32_t yi = (sgn(rng) << 31) + (exp(rng) << 23) + man(rng);
+
+            const float xr = bit_cast<float>(xi);
+            const float yr = bit_cast<float>(yi);
+            const float zr = xr + yr;
+
+            const auto x = to_flemu(xr);
+            const auto y = to_flemu(yr);
+            const auto z = add(x, y);
+
+            trace.record({xi, yi}, z.base(), bit_cast<std::uint32_t>(zr));
+
+            if(z.is_nan())
+            {
+                boost::ut::expect(std::isnan(zr)) << "z is NaN but zr is not\n" << trace;
+            }
+            else
+            {
+                boost::ut::expect(to_float(z) == zr) << trace;
+            }
+        }
+    };
+
+    "add is a constant expression"_test = []
+    {
+        // 1.0 + 1.0 == 2.0 in e4m3
+        static_assert(add(float8_e4m3(0x38), float8_e4m3(0x38)).base() == 0x40);
+        static_assert(add(bfloat16(0x3F80), bfloat16(0xBF80), rounding::toward_negative{}).base() == 0x8000);
+
+#if defined(__cpp_lib_bit_cast)
+        // 1.5 + 2^-24 is a tie; it is rounded to the even one, 1.5.
+        constexpr float32 a = to_flemu(1.5f);
+        constexpr float32 b = to_flemu(0x1.0p-24f);
+        constexpr float32 c = add(a, b);
+        static_assert(to_float(c) == 1.5f);
+        static_assert(add(a, b, rounding::toward_positive{}).base() == a.base() + 1u);
+        static_assert(to_float(add(to_flemu(0x1.FFFFFEp127f), a)) == 0x1.FFFFFEp127f);
+        static_assert(add(to_flemu(0x1.FFFFFEp127f), to_flemu(0x1.0p104f)).is_inf());
+#endif
+        // and the same function at runtime
+        volatile float bv = 0x1.0p-24f;
+        boost::ut::expect(to_float(add(to_flemu(1.5f), to_flemu(bv))) == 1.5f);
+        boost::ut::expect(add(to_flemu(1.5f), to_flemu(bv), rounding::toward_positive{}).base()
+                          == to_flemu(1.5f).base() + 1u);
+    };
+
+    "add probe"_test = []
+    {
+        const auto points = [](const float x, const float y) {
+            std::uint64_t taken = 0;
+            detail::add_unrecorded(to_flemu(x), to_flemu(y), rounding::nearest_even{}, flags::ignore{},
+                                   test_detail::taken_probe{&taken});
+            return taken;
+        };
+        const auto bit = [](const add_point p) {
+            return std::uint64_t(1) << static_cast<std::uint32_t>(p);
+        };
+
+        // 1.FFFFFE + 2^-24 is a tie that rounds up to 2.0
+        const auto tie = points(0x1.FFFFFEp0f, 0x1.0p-24f);
+        boost::ut::expect((tie & bit(add_point::swap)) != 0u);
+        boost::ut::expect((tie & bit(add_point::tie)) != 0u);
+        boost::ut::expect((tie & bit(add_point::round_up)) != 0u);
+        boost::ut::expect((tie & bit(add_point::rounding_carry)) != 0u);
+        boost::ut::expect((tie & bit(add_point::sticky)) == 0u);
+
+        const auto cancel = points(-0x1.FFFFFEp-1f, 1.0f);
+        boost::ut::expect(cancel == (bit(add_point::subtraction) | bit(add_point::exponent_gap_one) |
+                                     bit(add_point::cancellation)));
+
+        const auto over = points(0x1.FFFFFEp127f, 0x1.FFFFFEp127f);
+        boost::ut::expect((over & bit(add_point::overflow)) != 0u);
+        boost::ut::expect((over & bit(add_point::carry)) != 0u);
+
+        boost::ut::expect(points(HUGE_VALF, -HUGE_VALF) & bit(add_point::inf_minus_inf));
+        boost::ut::expect(points(0.0f, -0.0f) & bit(add_point::exact_zero));
+        boost::ut::expect(points(1.0f, 0.0f) & bit(add_point::zero_operand));
+    };
+
+    "add counters"_test = []
+    {
+        // what add does with -DFLEMU_ENABLE_COUNTERS
+        const auto counted_add = [](const float x, const float y) {
+            return detail::add_unrecorded(to_flemu(x), to_flemu(y), rounding::nearest_even{},
+                                          flags::ignore{}, counters::add_probe());
+        };
+        counters::reset();
+        boost::ut::expect(counted_add(1.0f, 0x1.0p-40f).base() == to_flemu(1.0f).base());
+        boost::ut::expect(counted_add(-0x1.FFFFFEp-1f, 1.0f).base() == to_flemu(0x1.0p-24f).base());
+        boost::ut::expect(counted_add(1.0f, 3.0f).base() == to_flemu(4.0f).base());
+
+        const counters::add_counts c = counters::snapshot();
+        const auto taken = [&c](const add_point p) {return c.taken[static_cast<std::uint32_t>(p)];};
+        boost::ut::expect(c.calls == 3u);
+        boost::ut::expect(taken(add_point::all_sticky) == 1u && taken(add_point::cancellation) == 1u);
+        boost::ut::expect(taken(add_point::carry) == 1u && taken(add_point::subtraction) == 1u);
+        boost::ut::expect(c.exponent_gap[add_measure_bins - 1] == 1u && c.exponent_gap[1] == 2u);
+        boost::ut::expect(c.normalization_shift[24] == 1u && c.normalization_shift[0] == 2u);
+        counters::reset();
+    };
+
+    "add(basic_float)"_test = []
+    {
+        using namespace test_detail;
+
+        // fp8: all the 65536 pairs
+        const auto exhaustive = [](auto tag) {
+            using float_type = decltype(tag);
+            for(std::uint32_t xi=0; xi<256; ++xi)
+            {
+                for(std::uint32_t yi=0; yi<256; ++yi)
+                {
+                    const float_type x(static_cast<std::uint8_t>(xi));
+                    const float_type y(static_cast<std::uint8_t>(yi));
+                    const auto z  = add(x, y);
+                    const auto zr = round_to_nearest<float_type>(to_double(x) + to_double(y));
+                    boost::ut::expect(same_value(z, zr)) << bits_of(x.base()) << " + "
+                        << bits_of(y.base()) << " = " << bits_of(z.base()) << " != " << bits_of(zr.base());
+                }
+            }
+        };
+        exhaustive(float8_e4m3{});
+        exhaustive(float8_e5m2{});
+
+        // 16bit: random pairs. to keep the sum exact in double, the exponent
+        // difference of bfloat16 is limited.
+        std::mt19937 rng(123456789);
+        const auto random = [&rng](auto tag, const std::uint32_t exp_lo, const std::uint32_t exp_hi) {
+            using float_type = decltype(tag);
+            using base_type  = typename float_type::base_type;
+            std::uniform_int_distribution<std::uint32_t> sgn(0, 1);
+            std::uniform_int_distribution<std::uint32_t> exp(exp_lo, exp_hi);
+            std::uniform_int_distribution<std::uint32_t> man(0, float_type::mantissa_bits == 7 ? 0x7F : 0x3FF);
+            for(std::size_t i=0; i<100000; ++i)
+            {
+                const float_type x(base_type(sgn(rng)), base_type(exp(rng)), base_type(man(rng)));
+                const float_type y(base_type(sgn(rng)), base_type(exp(rng)), base_type(man(rng)));
+                const auto z  = add(x, y);
+                const auto zr = round_to_nearest<float_type>(to_double(x) + to_double(y));
+                boost::ut::expect(same_value(z, zr)) << bits_of(x.base()) << " + "
+                    << bits_of(y.base()) << " = " << bits_of(z.base()) << " != " << bits_of(zr.base());
+            }
+        };
+        random(float16{},  0,  31);
+        random(bfloat16{}, 0,  40);
+        random(bfloat16{}, 100, 140);
+        random(bfloat16{}, 230, 255);
+    };
+
+    "add(float32, float32, rounding)"_test = []
+    {
+        // compare with the native addition in the same rounding mode.
+        const auto check = [](const auto rnd, const int mode) {
+            std::mt19937 rng(123456789);
+            std::uniform_int_distribution<std::uint32_t> bits;
+            std::uniform_int_distribution<std::uint32_t> exp(0, 255);
+            for(std::size_t i=0; i<10000; ++i)
+            {
+                // close exponents half of the time, to cover the cancellation
+                const std::uint32_t xi = bits(rng);
+                const std::uint32_t yi = (i % 2 == 0) ? bits(rng) :
+                    (bits(rng) & 0x807F'FFFFu) | ((((xi >> 23) & 0xFFu) + exp(rng) % 3) & 0xFFu) << 23;
+
+                volatile float xr = bit_cast<float>(xi);
+                volatile float yr = bit_cast<float>(yi);
+                std::fesetround(mode);
+                const float zr = xr + yr;
+                std::fesetround(FE_TONEAREST);
+
+                const auto z = add(float32(xi), float32(yi), rnd);
+                boost::ut::expect(std::isnan(zr) ? z.is_nan() : z.base() == bit_cast<std::uint32_t>(zr))
+                    << bits_of(xi) << " + " << bits_of(yi) << " = " << bits_of(z.base())
+                    << " != " << bits_of(bit_cast<std::uint32_t>(zr));
+            }
+            // exact zero and overflow
+            const float32 one = to_flemu(1.0f), max = to_flemu(0x1.FFFFFEp127f);
+            volatile float r = 1.0f, m = 0x1.FFFFFEp127f;
+            std::fesetround(mode);
+            const float zero = r - r, over = m + m;
+            std::fesetround(FE_TONEAREST);
+            boost::ut::expect(add(one, float32(one.base() ^ 0x8000'0000u), rnd).base() == bit_cast<std::uint32_t>(zero));
+            boost::ut::expect(add(max, max, rnd).base() == bit_cast<std::uint32_t>(over));
+        };
+        check(rounding::nearest_even{},    FE_TONEAREST);
+        check(rounding::toward_zero{},     FE_TOWARDZERO);
+        check(rounding::toward_positive{}, FE_UPWARD);
+        check(rounding::toward_negative{}, FE_DOWNWARD);
+    };
+
+    "add(float32, float32, rounding, flags)"_test = []
+    {
+        // compare with the hardware flags in the same rounding mode.
+        const auto hardware_flags = [](const int e) {
+            return ((e & FE_INVALID)   ? flag_invalid   : 0u) | ((e & FE_OVERFLOW) ? flag_overflow : 0u) |
+                   ((e & FE_UNDERFLOW) ? flag_underflow : 0u) | ((e & FE_INEXACT)  ? flag_inexact  : 0u);
+        };
+        const auto check = [&](const auto rnd, const int mode) {
+            std::mt19937 rng(123456789);
+            std::uniform_int_distribution<std::uint32_t> bits;
+            std::uniform_int_distribution<std::uint32_t> cls(0, 7);
+            for(std::size_t i=0; i<10000; ++i)
+            {
+                // flemu does not have signaling nans, so use quiet ones
+                const auto generate = [&]() -> std::uint32_t {
+                    const std::uint32_t b = bits(rng);
+                    switch(cls(rng))
+                    {
+                        case 0:  return (b & 0x8000'0000u) | 0x7F80'0000u;             // inf
+                        case 1:  return (b & 0x8040'0000u) | 0x7FC0'0000u;             // nan
+                        case 2:  return (b & 0x807F'FFFFu) | 0x7F00'0000u;             // large
+                        case 3:  return (b & 0x807F'FFFFu);                            // denorm
+                        default: return b & ~((b & 0x7F80'0000u) == 0x7F80'0000u ? 0x0080'0000u : 0u);
+                    }
+                };
+                const std::uint32_t xi = generate();
+                const std::uint32_t yi = generate();
+
+                volatile float xr = bit_cast<float>(xi);
+                volatile float yr = bit_cast<float>(yi);
+                std::feclearexcept(FE_ALL_EXCEPT);
+                std::fesetround(mode);
+                volatile float zr = xr + yr;
+                const std::uint32_t fr = hardware_flags(std::fetestexcept(FE_ALL_EXCEPT));
+                std::fesetround(FE_TONEAREST);
+                static_cast<void>(zr);
+
+                clear_flags();
+                add(float32(xi), float32(yi), rnd, flags::thread_status{});
+                boost::ut::expect(test_flags() == fr) << bits_of(xi) << " + " << bits_of(yi)
+                    << ": " << test_flags() << " != " << fr;
+
+                std::uint32_t word = 0;
+                add(float32(xi), float32(yi), rnd, flags::accumulate{word});
+                boost::ut::expect(word == fr);
+            }
+        };
+        check(rounding::nearest_even{},    FE_TONEAREST);
+        check(rounding::toward_zero{},     FE_TOWARDZERO);
+        check(rounding::toward_positive{}, FE_UPWARD);
+        check(rounding::toward_negative{}, FE_DOWNWARD);
+        clear_flags();
+
+        // flags are not computed nor stored unless asked
+        add(to_flemu(1.0f), to_flemu(0x1.0p-30f));
+        add(to_flemu(HUGE_VALF), to_flemu(-HUGE_VALF), rounding::nearest_even{});
+        boost::ut::expect(test_flags() == 0u);
+    };
+
+    "add(float64, float64, rounding, flags)"_test = []
+    {
+        // the same as float32 with 64-bit registers. compare with double.
+        const auto hardware_flags = [](const int e) {
+            return ((e & FE_INVALID)   ? flag_invalid   : 0u) | ((e & FE_OVERFLOW) ? flag_overflow : 0u) |
+                   ((e & FE_UNDERFLOW) ? flag_underflow : 0u) | ((e & FE_INEXACT)  ? flag_inexact  : 0u);
+        };
+        const auto check = [&](const auto rnd, const int mode) {
+            std::mt19937_64 rng(123456789);
+            std::uniform_int_distribution<std::uint32_t> cls(0, 7);
+            for(std::size_t i=0; i<20000; ++i)
+            {
+                constexpr std::uint64_t inf = 0x7FF0'0000'0000'0000ull;
+                constexpr std::uint64_t man = 0x000F'FFFF'FFFF'FFFFull;
+                constexpr std::uint64_t sgn = 0x8000'0000'0000'0000ull;
+                const auto generate = [&](const std::uint64_t other) -> std::uint64_t {
+                    const std::uint64_t b = rng();
+                    switch(cls(rng))
+                    {
+                        case 0:  return (b & sgn) | inf;                                   // inf
+                        case 1:  return (b & sgn) | inf | 0x0008'0000'0000'0000ull;         // nan
+                        case 2:  return (b & (sgn | man)) | 0x7FE0'0000'0000'0000ull;       // large
+                        case 3:  return (b & (sgn | man));                                  // denorm
+                        case 4:  return (other ^ sgn) + (b % 17) - 8;                       // cancellation
+                        case 5:  return (other & ~inf) |                                    // gap up to 70
+                                        ((((other & inf) >> 52) + b % 141 - 70) & 0x7FE) << 52;
+                        default: return ((b & inf) == inf) ? b & ~(std::uint64_t(1) << 52) : b;
+                    }
+                };
+                // flemu does not have signaling nans, so make them quiet
+                const auto quiet = [](const std::uint64_t v) {
+                    return ((v & inf) == inf && (v & man) != 0) ? v | 0x0008'0000'0000'0000ull : v;
+                };
+                const std::uint64_t xi = quiet(generate(0));
+                const std::uint64_t yi = quiet(generate(xi));
+
+                volatile double xr = bit_cast<double>(xi);
+                volatile double yr = bit_cast<double>(yi);
+                std::feclearexcept(FE_ALL_EXCEPT);
+                std::fesetround(mode);
+                volatile double zr = xr + yr;
+                const std::uint32_t fr = hardware_flags(std::fetestexcept(FE_ALL_EXCEPT));
+                std::fesetround(FE_TONEAREST);
+
+                std::uint32_t word = 0;
+                const float64 z = add(float64(xi), float64(yi), rnd, flags::accumulate{word});
+                const double  r = zr;
+                boost::ut::expect(std::isnan(r) ? z.is_nan() : z.base() == bit_cast<std::uint64_t>(r))
+                    << bits_of(xi) << " + " << bits_of(yi) << " = " << bits_of(z.base());
+                boost::ut::expect(word == fr) << bits_of(xi) << " + " << bits_of(yi)
+                    << ": " << word << " != " << fr;
+            }
+        };
+        check(rounding::nearest_even{},    FE_TONEAREST);
+        check(rounding::toward_zero{},     FE_TOWARDZERO);
+        check(rounding::toward_positive{}, FE_UPWARD);
+        check(rounding::toward_negative{}, FE_DOWNWARD);
+
+        static_assert(add(to_flemu64(0.5), to_flemu64(0.25)).base() == to_flemu64(0.75).base());
+    };
+
+    "add(basic_float, rounding)"_test = []
+    {
+        using namespace test_detail;
+
+        // fp8: all the 65536 pairs in the deterministic modes
+        const auto exhaustive = [](auto tag, const auto rnd) {
+            using float_type = decltype(tag);
+            for(std::uint32_t xi=0; xi<256; ++xi)
+            {
+                for(std::uint32_t yi=0; yi<256; ++yi)
+                {
+                    const float_type x(static_cast<std::uint8_t>(xi));
+                    const float_type y(static_cast<std::uint8_t>(yi));
+                    const double sum = to_double(x) + to_double(y);
+                    const auto z  = add(x, y, rnd);
+                    const auto zr = (sum == 0.0) ?
+                        float_type(static_cast<std::uint8_t>(decltype(rnd)::exact_zero_sign(
+                            std::uint32_t(std::uint8_t(x.sign())), std::uint32_t(std::uint8_t(y.sign()))) << 7)) :
+                        round_to<float_type>(sum, rnd);
+                    boost::ut::expect(same_value(z, zr)) << bits_of(x.base()) << " + "
+                        << bits_of(y.base()) << " = " << bits_of(z.base()) << " != " << bits_of(zr.base());
+                }
+            }
+        };
+        exhaustive(float8_e4m3{}, rounding::toward_zero{});
+        exhaustive(float8_e4m3{}, rounding::toward_positive{});
+        exhaustive(float8_e4m3{}, rounding::toward_negative{});
+        exhaustive(float8_e5m2{}, rounding::toward_zero{});
+        exhaustive(float8_e5m2{}, rounding::toward_positive{});
+        exhaustive(float8_e5m2{}, rounding::toward_negative{});
+
+        // stochastic rounding with constant random bits. all 0 never rounds
+        // up (toward zero), all 1 rounds up if anything is left (away from zero).
+        struct zeros {std::uint32_t operator()(std::uint64_t) const noexcept {return 0u;}};
+        struct ones  {std::uint32_t operator()(std::uint64_t) const noexcept {return ~0u;}};
+        using float_type = float8_e4m3;
+        const double overflow = std::ldexp(1.0, int(float_type::exponent_max) - int(float_type::exponent_bias));
+        for(std::uint32_t xi=0; xi<256; ++xi)
+        {
+            for(std::uint32_t yi=0; yi<256; ++yi)
+            {
+                const float_type x(static_cast<std::uint8_t>(xi));
+                const float_type y(static_cast<std::uint8_t>(yi));
+                const double sum = to_double(x) + to_double(y);
+                if(std::isnan(sum) || sum == 0.0) {continue;}
+
+                const auto z0 = add(x, y, rounding::stochastic<zeros>{});
+                const auto z1 = add(x, y, rounding::stochastic<ones>{});
+                const auto away = std::signbit(sum) ? round_to<float_type>(sum, rounding::toward_negative{})
+                                                    : round_to<float_type>(sum, rounding::toward_positive{});
+                if(std::abs(sum) < overflow)
+                {
+                    boost::ut::expect(same_value(z0, round_to<float_type>(sum, rounding::toward_zero{})))
+                        << bits_of(x.base()) << " + " << bits_of(y.base()) << " = " << bits_of(z0.base());
+                }
+                boost::ut::expect(same_value(z1, away))
+                    << bits_of(x.base()) << " + " << bits_of(y.base()) << " = " << bits_of(z1.base());
+            }
+        }
+
+        // 1 + 2^-5 is 1/4 of the way from 1 to 1 + 2^-3, so it should be
+        // rounded up with probability 1/4 on average.
+        const float_type one(0u, 7u, 0u), small(0u, 2u, 0u), next(0u, 7u, 1u);
+        const std::size_t N = 1 << 14;
+        std::size_t ups = 0;
+        for(std::size_t i=0; i<N; ++i)
+        {
+            const auto z = add(one, small, rounding::stochastic<rounding::hash_rng>{{42u}, i});
+            boost::ut::expect(z.base() == one.base() || z.base() == next.base());
+            ups += (z.base() == next.base()) ? 1 : 0;
+        }
+        boost::ut::expect(std::abs(double(ups) / N - 0.25) < 0.02) << "P(up) = " << double(ups) / N;
+    };
+};
+
+} // flemu
@@ -0,0 +1,201 @@
+#include <flemu/assumptions.hpp>
+#include <flemu/adder.hpp>
+#include <flemu/batch_adder.hpp>
+#include "test_detail.hpp"
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <random>
+#include <span>
+#include <vector>
+
+#if defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+
+namespace flemu
+{
+
+namespace
+{
+
+// the references of DAZ and FTZ on top of add without them.
+template<typename Float>
+Float denormal_to_zero(const Float x)
+{
+    using base_type = typename Float::base_type;
+    return (base_type(x.exponent()) == 0) ? Float(base_type(x.sign()), 0, 0) : x;
+}
+
+template<typename Float, typename Assume>
+Float add_reference(const Float x, const Float y, std::uint32_t& f)
+{
+    using base_type = typename Float::base_type;
+    const Float x1 = Assume::denormals_are_zero ? denormal_to_zero(x) : x;
+    const Float y1 = Assume::denormals_are_zero ? denormal_to_zero(y) : y;
+    const Float z  = add(x1, y1, rounding::nearest_even{}, flags::accumulate{f});
+
+    // a tiny sum is exact, so tiny before and after rounding are the same.
+    if(Assume::flush_to_zero && base_type(z.exponent()) == 0 && base_type(z.mantissa()) != 0)
+    {
+        f |= flag_underflow | flag_inexact;
+        return Float(base_type(z.sign()), 0, 0);
+    }
+    return z;
+}
+
+// all the pairs of an 8-bit format, except inf and nan for `finite`.
+template<typename Float, typename Assume>
+bool exhaustive_matches()
+{
+    bool ok = true;
+    for(std::uint32_t i=0; i<256; ++i)
+    {
+        for(std::uint32_t j=0; j<256; ++j)
+        {
+            const Float x{std::uint8_t(i)};
+            const Float y{std::uint8_t(j)};
+            if(!satisfies<Assume>(x) || !satisfies<Assume>(y))
+            {
+                continue;
+            }
+            std::uint32_t f = 0, g = 0;
+            const Float z = add(x, y, rounding::nearest_even{}, flags::accumulate{f}, Assume{});
+            const Float r = add_reference<Float, Assume>(x, y, g);
+            ok = ok && test_detail::same_value(z, r) && f == g;
+        }
+    }
+    return ok;
+}
+
+template<typename Assume>
+bool exhaustive_matches_all()
+{
+    return exhaustive_matches<float8_e5m2, Assume>() && exhaustive_matches<float8_e4m3, Assume>();
+}
+
+} // anonymous
+
+boost::ut::suite tests_assumptions = []
+{
+    using namespace boost::ut::literals;
+
+    "satisfies"_test = []
+    {
+        const float16 inf(0, float16::exponent_max, 0);
+        const float16 nan(1, float16::exponent_max, 3);
+        const float16 denorm(0, 0, 1);
+        boost::ut::expect(satisfies<assume::none>(inf) && satisfies<assume::none>(nan));
+        boost::ut::expect(!satisfies<assume::finite>(inf) && !satisfies<assume::finite>(nan));
+        boost::ut::expect(satisfies<assume::finite>(denorm) && satisfies<assume::finite_ftz_daz>(denorm));
+        boost::ut::expect(satisfies<assume::ftz_daz>(inf));
+    };
+
+    "add with assumptions, exhaustive"_test = []
+    {
+        boost::ut::expect(exhaustive_matches_all<assume::none>());
+        boost::ut::expect(exhaustive_matches_all<assume::finite>());
+        boost::ut::expect(exhaustive_matches_all<assume::mode<false, true, false>>());
+        boost::ut::expect(exhaustive_matches_all<assume::mode<false, false, true>>());
+        boost::ut::expect(exhaustive_matches_all<assume::ftz_daz>());
+        boost::ut::expect(exhaustive_matches_all<assume::finite_ftz_daz>());
+    };
+
+    "add with assumptions, examples"_test = []
+    {
+        // the difference of the two smallest normals is the smallest denormal.
+        const float32 min_normal(0, 1, 0);
+        const float32 next_normal(0, 1, 1);
+        const float32 min_denorm(0, 0, 1);
+        std::uint32_t f = 0;
+        boost::ut::expect(add(next_normal, float32(1, 1, 0)).base() == min_denorm.base());
+        boost::ut::expect(add(next_normal, float32(1, 1, 0), rounding::nearest_even{}, flags::accumulate{f},
+                              assume::ftz_daz{}).base() == 0u);
+        boost::ut::expect(f == (flag_underflow | flag_inexact));
+
+        // the sign of a flushed result is the sign of the sum.
+        boost::ut::expect(add(float32(1, 1, 1), min_normal, rounding::nearest_even{}, flags::ignore{},
+                              assume::ftz_daz{}).base() == float32(1, 0, 0).base());
+
+        // a denormal operand is a zero with DAZ, and keeps its sign.
+        boost::ut::expect(add(min_denorm, min_normal, rounding::nearest_even{}, flags::ignore{},
+                              assume::mode<false, true, false>{}).base() == min_normal.base());
+        boost::ut::expect(add(float32(1, 0, 5), float32(1, 0, 0), rounding::nearest_even{}, flags::ignore{},
+                              assume::ftz_daz{}).base() == float32(1, 0, 0).base());
+        boost::ut::expect(add(float32(1, 0, 5), float32(0, 0, 0), rounding::toward_negative{}, flags::ignore{},
+                              assume::ftz_daz{}).base() == float32(1, 0, 0).base());
+
+        // a finite overflow still becomes inf.
+        const float32 max(0, 254, 0x7FFFFF);
+        boost::ut::expect(add(max, max, rounding::nearest_even{}, flags::ignore{},
+                              assume::finite{}).is_inf());
+
+        constexpr float16 z = add(float16(0, 1, 1), float16(1, 1, 0), rounding::nearest_even{},
+                                  flags::ignore{}, assume::finite_ftz_daz{});
+        static_assert(z.base() == 0);
+    };
+
+#if defined(__SSE2__)
+    // MXCSR has FTZ (bit 15) and DAZ (bit 6); the hardware detects tininess
+    // after rounding, but a tiny sum is exact, so it does not matter here.
+    "add with ftz_daz, compared with the hardware"_test = []
+    {
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits;
+        std::uniform_int_distribution<std::uint32_t> exp(0, 4);
+
+        const unsigned int csr = _mm_getcsr();
+        _mm_setcsr(csr | 0x8040u);
+        bool ok = true;
+        for(std::size_t i=0; i<100000; ++i)
+        {
+            // exponents near the denormal boundary, so that DAZ and FTZ are taken.
+            const std::uint32_t xb = (bits(rng) & 0x807F'FFFFu) | (exp(rng) << 23);
+            const std::uint32_t yb = (bits(rng) & 0x807F'FFFFu) | (exp(rng) << 23);
+            volatile float xf = bit_cast<float>(xb);
+            volatile float yf = bit_cast<float>(yb);
+            const float zf = xf + yf;
+
+            const float32 z = add(float32(xb), float32(yb), rounding::nearest_even{}, flags::ignore{},
+                                  assume::finite_ftz_daz{});
+            ok = ok && z.base() == bit_cast<std::uint32_t>(zf);
+        }
+        _mm_setcsr(csr);
+        boost::ut::expect(ok);
+    };
+#endif
+
+    "span add with assumptions"_test = []
+    {
+        std::mt19937 rng(987654321);
+        std::uniform_int_distribution<std::uint32_t> bits;
+        std::uniform_int_distribution<std::uint32_t> exp(0, 3);
+
+        const std::size_t n = 1000;
+        std::vector<float32> x(n), y(n), z(n);
+        for(std::size_t i=0; i<n; ++i)
+        {
+            x[i] = float32((bits(rng) & 0x807F'FFFFu) | (exp(rng) << 23));
+            y[i] = float32((bits(rng) & 0x807F'FFFFu) | (exp(rng) << 23));
+        }
+
+        const auto check = [&](const auto assume) {
+            std::uint32_t f = 0, g = 0;
+            add(std::span<const float32>(x), std::span<const float32>(y), std::span<float32>(z),
+                rounding::nearest_even{}, flags::accumulate{f}, assume);
+            bool ok = true;
+            for(std::size_t i=0; i<n; ++i)
+            {
+                ok = ok && z[i].base() == add_reference<float32, decltype(assume)>(x[i], y[i], g).base();
+            }
+            return ok && f == g;
+        };
+        boost::ut::expect(check(assume::finite{}));
+        boost::ut::expect(check(assume::ftz_daz{}));
+        boost::ut::expect(check(assume::finite_ftz_daz{}));
+    };
+};
+
+} // flemu
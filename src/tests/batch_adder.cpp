@@ -0,0 +1,229 @@
+#include <flemu/batch_adder.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_batch_adder = []
+{
+    using namespace boost::ut::literals;
+
+    "add(span, span, span) is a constant expression"_test = []
+    {
+        // a table of bfloat16 constants, made by the compiler
+        constexpr auto table = [] {
+            std::array<bfloat16, 4> x{}, y{}, z{};
+            for(std::size_t i=0; i<x.size(); ++i)
+            {
+                x[i] = bfloat16(0, 127 + i, 0);   // 2^i
+                y[i] = bfloat16(0, 127, 0x40);    // 1.5
+            }
+            add<8, 7, 127, std::uint16_t>(x, y, z);
+            return z;
+        }();
+        static_assert(table[0].base() == 0x4020); // 2.5
+        static_assert(table[3].base() == 0x4118); // 9.5
+        boost::ut::expect(table[1].base() == 0x4060u); // 3.5
+    };
+
+    "add(span, span, span)"_test = []
+    {
+        std::mt19937 rng(123456789);
+
+        std::uniform_int_distribution<std::uint32_t> sgn(0,   1);
+        std::uniform_int_distribution<std::uint32_t> exp(0, 255);
+        std::uniform_int_distribution<std::uint32_t> man(0, 0x007F'FFFF);
+        std::uniform_int_distribution<std::uint32_t> cls(0,   7);
+
+        // mix normal, denormal, zero, inf, nan and near-cancellation
+        const auto generate = [&](const std::uint32_t other) -> std::uint32_t {
+            switch(cls(rng))
+            {
+                case 0: return (sgn(rng) << 31) + man(rng);                    // denorm
+                case 1: return (sgn(rng) << 31);                               // zero
+                case 2: return (sgn(rng) << 31) + (0xFFu << 23) + (man(rng) % 2); // inf/nan
+                case 3: return (other ^ 0x8000'0000u) + man(rng) % 5 - 2;     // cancellation
+                default: return (sgn(rng) << 31) + (exp(rng) << 23) + man(rng);
+            }
+        };
+
+        const std::size_t N = 10003; // not a multiple of the vector width
+        std::vector<float32> xs(N), ys(N), zs(N), ref(N);
+        for(std::size_t i=0; i<N; ++i)
+        {
+            xs[i] = float32(generate(0));
+            ys[i] = float32(generate(xs[i].base()));
+            ref[i] = add(xs[i], ys[i]);
+        }
+
+        const auto check = [&](const char* name) {
+            for(std::size_t i=0; i<N; ++i)
+            {
+                boost::ut::expect(zs[i].base() == ref[i].base()) << name << ": "
+                    << bits_of(xs[i].base()) << " + " << bits_of(ys[i].base()) << " = "
+                    << bits_of(zs[i].base()) << " != " << bits_of(ref[i].base());
+            }
+        };
+
+        add(xs, ys, zs);
+        check("dispatched");
+
+        detail::add_kernel_scalar(xs.data(), ys.data(), zs.data(), N);
+        check("scalar");
+
+#ifdef FLEMU_BATCH_ADDER_X86
+        if(__builtin_cpu_supports("avx2"))
+        {
+            detail::add_kernel_avx2(xs.data(), ys.data(), zs.data(), N);
+            check("avx2");
+        }
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd"))
+        {
+            detail::add_kernel_avx512(xs.data(), ys.data(), zs.data(), N);
+            check("avx512");
+        }
+#endif
+
+        add(xs, ys, zs, rounding::nearest_even{});
+        check("nearest_even");
+
+        // flags of a batch are the OR of the flags of the elements. check
+        // each kernel on chunks, so that a flag raised in one lane is seen.
+        for(std::size_t first=0; first<N; first+=37)
+        {
+            const std::size_t n = std::min<std::size_t>(37, N - first);
+            std::uint32_t expected = 0;
+            for(std::size_t i=first; i<first+n; ++i)
+            {
+                add(xs[i], ys[i], rounding::nearest_even{}, flags::accumulate{expected});
+            }
+            const auto xp = xs.data() + first;
+            const auto yp = ys.data() + first;
+            const auto zp = zs.data() + first;
+
+            std::uint32_t word = 0;
+            add(std::span<const float32>(xp, n), std::span<const float32>(yp, n),
+                std::span<float32>(zp, n), rounding::nearest_even{}, flags::accumulate{word});
+            boost::ut::expect(word == expected) << "dispatched: " << word << " != " << expected;
+
+            boost::ut::expect(detail::add_kernel_scalar<true>(xp, yp, zp, n) == expected);
+#ifdef FLEMU_BATCH_ADDER_X86
+            if(__builtin_cpu_supports("avx2"))
+            {
+                boost::ut::expect(detail::add_kernel_avx2<true>(xp, yp, zp, n) == expected)
+                    << "avx2: " << detail::add_kernel_avx2<true>(xp, yp, zp, n) << " != " << expected;
+            }
+            if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd"))
+            {
+                boost::ut::expect(detail::add_kernel_avx512<true>(xp, yp, zp, n) == expected)
+                    << "avx512: " << detail::add_kernel_avx512<true>(xp, yp, zp, n) << " != " << expected;
+            }
+#endif
+        }
+        check("flags");
+
+        // the i-th element draws the random bits at counter + i
+        const rounding::stochastic<rounding::hash_rng> sr{{12345u}, 1000u};
+        for(std::size_t i=0; i<N; ++i)
+        {
+            ref[i] = add(xs[i], ys[i], rounding::stochastic<rounding::hash_rng>{{12345u}, 1000u + i});
+        }
+        add(xs, ys, zs, sr);
+        check("stochastic");
+    };
+
+    "add(span<float64>, span<float64>, span<float64>)"_test = []
+    {
+        std::mt19937_64 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> cls(0, 7);
+
+        constexpr std::uint64_t sgn = 0x8000'0000'0000'0000ull;
+        constexpr std::uint64_t inf = 0x7FF0'0000'0000'0000ull;
+        constexpr std::uint64_t man = 0x000F'FFFF'FFFF'FFFFull;
+        const auto generate = [&](const std::uint64_t other) -> std::uint64_t {
+            const std::uint64_t b = rng();
+            switch(cls(rng))
+            {
+                case 0: return (b & (sgn | man));                       // denorm
+                case 1: return (b & sgn);                               // zero
+                case 2: return (b & sgn) | inf | (b >> 63);             // inf/nan
+                case 3: return (other ^ sgn) + b % 5 - 2;               // cancellation
+                case 4: return (b & (sgn | man)) | 0x7FE0'0000'0000'0000ull; // overflow
+                default: return b;
+            }
+        };
+
+        const std::size_t N = 10003;
+        std::vector<float64> xs(N), ys(N), zs(N), ref(N);
+        for(std::size_t i=0; i<N; ++i)
+        {
+            xs[i]  = float64(generate(0));
+            ys[i]  = float64(generate(xs[i].base()));
+            ref[i] = add(xs[i], ys[i]);
+        }
+        const auto check = [&](const char* name) {
+            bool ok = true;
+            for(std::size_t i=0; i<N; ++i)
+            {
+                ok = ok && zs[i].base() == ref[i].base();
+            }
+            boost::ut::expect(ok) << name;
+        };
+
+        add(xs, ys, zs);
+        check("dispatched");
+        detail::add_kernel_scalar(xs.data(), ys.data(), zs.data(), N);
+        check("scalar");
+#ifdef FLEMU_BATCH_ADDER_X86
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd"))
+        {
+            detail::add_kernel_f64_avx512(xs.data(), ys.data(), zs.data(), N);
+            check("avx512");
+        }
+#endif
+
+        for(std::size_t first=0; first<N; first+=37)
+        {
+            const std::size_t n = std::min<std::size_t>(37, N - first);
+            std::uint32_t expected = 0;
+            for(std::size_t i=first; i<first+n; ++i)
+            {
+                add(xs[i], ys[i], rounding::nearest_even{}, flags::accumulate{expected});
+            }
+            const auto xp = xs.data() + first;
+            const auto yp = ys.data() + first;
+            const auto zp = zs.data() + first;
+
+            std::uint32_t word = 0;
+            add(std::span<const float64>(xp, n), std::span<const float64>(yp, n),
+                std::span<float64>(zp, n), rounding::nearest_even{}, flags::accumulate{word});
+            boost::ut::expect(word == expected) << "dispatched: " << word << " != " << expected;
+#ifdef FLEMU_BATCH_ADDER_X86
+            if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd"))
+            {
+                boost::ut::expect(detail::add_kernel_f64_avx512<true>(xp, yp, zp, n) == expected)
+                    << "avx512: " << detail::add_kernel_f64_avx512<true>(xp, yp, zp, n) << " != " << expected;
+            }
+#endif
+        }
+        check("flags");
+
+        for(std::size_t i=0; i<N; ++i)
+        {
+            ref[i] = add(xs[i], ys[i], rounding::toward_negative{});
+        }
+        add(xs, ys, zs, rounding::toward_negative{});
+        check("toward_negative");
+    };
+};
+
+} // flemu
@@ -0,0 +1,193 @@
+#include <flemu/batch_convert.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <array>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_batch_convert = []
+{
+    using namespace boost::ut::literals;
+
+    "convert(span<float32>, span<To>) is a constant expression"_test = []
+    {
+        constexpr auto table = [] {
+            std::array<float32, 3> x{float32(0x3F80'0000u), float32(0x4049'0FDBu), float32(0xFF80'0000u)};
+            std::array<bfloat16, 3> z{};
+            convert<bfloat16>(std::span<const float32>(x), std::span<bfloat16>(z));
+            return z;
+        }();
+        static_assert(table[0].base() == 0x3F80); // 1
+        static_assert(table[1].base() == 0x4049); // 3.140625
+        static_assert(table[2].base() == 0xFF80); // -inf
+        boost::ut::expect(table[1].base() == 0x4049u);
+    };
+
+    "convert(span<float32>, span<To>)"_test = []
+    {
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits;
+        std::uniform_int_distribution<std::uint32_t> cls(0, 7);
+
+        // every class of the narrower formats: around their overflow and
+        // denormal boundaries, float32 denormals, inf and nan
+        const std::size_t N = 10007;
+        std::vector<float32> xs(N);
+        for(auto& x : xs)
+        {
+            const std::uint32_t b = bits(rng);
+            switch(cls(rng))
+            {
+                case 0:  x = float32((b & 0x807F'FFFFu) | ((100 + b % 60) << 23)); break;
+                case 1:  x = float32((b & 0x807F'FFFFu) | ((30 + b % 70) << 23)); break;
+                case 2:  x = float32(b & 0x807F'FFFFu); break;
+                case 3:  x = float32((b & 0x8000'0000u) | 0x7F80'0000u | (b & 1u)); break;
+                case 4:  x = float32((b & 0x8000'0000u) | (b & 0x7Fu) << 16 | 0x4780'0000u); break;
+                default: x = float32(b); break;
+            }
+        }
+
+        const auto check = [&]<typename To, typename Rounding>(const To, const Rounding rnd, const char* name) {
+            std::vector<To> zs(N), ref(N);
+            for(std::size_t i=0; i<N; ++i)
+            {
+                ref[i] = convert<To>(xs[i], rnd);
+            }
+            const auto same = [&](const char* kernel) {
+                bool ok = true;
+                for(std::size_t i=0; i<N; ++i)
+                {
+                    ok = ok && zs[i].base() == ref[i].base();
+                }
+                boost::ut::expect(ok) << name << kernel;
+            };
+
+            convert(std::span<const float32>(xs), std::span<To>(zs), rnd);
+            same(": dispatched");
+#ifdef FLEMU_BATCH_CONVERT_X86
+            if(__builtin_cpu_supports("avx2"))
+            {
+                detail::narrow_kernel_avx2<To, Rounding>(xs.data(), zs.data(), N);
+                same(": avx2");
+            }
+            if(__builtin_cpu_supports("avx512f"))
+            {
+                detail::narrow_kernel_avx512<To, Rounding>(xs.data(), zs.data(), N);
+                same(": avx512");
+            }
+#endif
+
+            // flags, in chunks that have one or none of them
+            for(std::size_t first=0; first<N; first+=37)
+            {
+                const std::size_t n = std::min<std::size_t>(37, N - first);
+                std::uint32_t expected = 0;
+                for(std::size_t i=first; i<first+n; ++i)
+                {
+                    convert<To>(xs[i], rnd, flags::accumulate{expected});
+                }
+                std::uint32_t word = 0;
+                convert(std::span<const float32>(xs.data() + first, n), std::span<To>(zs.data() + first, n),
+                        rnd, flags::accumulate{word});
+                boost::ut::expect(word == expected) << name << ": " << word << " != " << expected;
+#ifdef FLEMU_BATCH_CONVERT_X86
+                if(__builtin_cpu_supports("avx2"))
+                {
+                    const auto f = detail::narrow_kernel_avx2<To, Rounding, true>(
+                        xs.data() + first, zs.data() + first, n);
+                    boost::ut::expect(f == expected) << name << ": avx2: " << f << " != " << expected;
+                }
+#endif
+            }
+            same(": flags");
+        };
+        const auto check_all = [&](const auto to, const char* name) {
+            check(to, rounding::nearest_even{},    name);
+            check(to, rounding::toward_zero{},     name);
+            check(to, rounding::toward_positive{}, name);
+            check(to, rounding::toward_negative{}, name);
+            check(to, rounding::saturating<rounding::nearest_even>{},    name);
+            check(to, rounding::saturating<rounding::toward_positive>{}, name);
+        };
+        check_all(tfloat32{},    "tfloat32");
+        check_all(bfloat16{},    "bfloat16");
+        check_all(float16{},     "float16");
+        check_all(float8_e5m2{}, "float8_e5m2");
+        check_all(float8_e4m3{}, "float8_e4m3");
+    };
+
+    "convert(span<From>, span<float32>)"_test = []
+    {
+        // all the encodings of the 8- and 16-bit formats
+        const auto check = [&]<typename From>(const From, const char* name) {
+            using base_type = typename From::base_type;
+            const std::size_t N = std::size_t(1) << (From::sign_bit + 1);
+            std::vector<From> xs(N);
+            std::vector<float32> zs(N), ref(N);
+            for(std::size_t i=0; i<N; ++i)
+            {
+                xs[i]  = From(static_cast<base_type>(i));
+                ref[i] = convert<float32>(xs[i]);
+            }
+            const auto same = [&](const char* kernel) {
+                bool ok = true;
+                for(std::size_t i=0; i<N; ++i)
+                {
+                    ok = ok && zs[i].base() == ref[i].base();
+                }
+                boost::ut::expect(ok) << name << kernel;
+            };
+
+            std::uint32_t word = 0;
+            convert(std::span<const From>(xs), std::span<float32>(zs), rounding::nearest_even{},
+                    flags::accumulate{word});
+            same(": dispatched");
+            boost::ut::expect(word == 0u) << name << ": the widening is exact";
+#ifdef FLEMU_BATCH_CONVERT_X86
+            if(__builtin_cpu_supports("avx2"))
+            {
+                detail::widen_kernel_avx2(xs.data(), zs.data(), N);
+                same(": avx2");
+            }
+            if(__builtin_cpu_supports("avx512f"))
+            {
+                detail::widen_kernel_avx512(xs.data(), zs.data(), N);
+                same(": avx512");
+            }
+#endif
+        };
+        check(bfloat16{},    "bfloat16");
+        check(float16{},     "float16");
+        check(float8_e5m2{}, "float8_e5m2");
+        check(float8_e4m3{}, "float8_e4m3");
+    };
+
+    "stochastic rounding runs the scalar convert"_test = []
+    {
+        std::vector<float32> xs(1000);
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits;
+        for(auto& x : xs) {x = float32(bits(rng));}
+
+        static_assert(!detail::is_vector_conversion<float32, float16, rounding::stochastic<rounding::hash_rng>>);
+
+        std::vector<float16> zs(xs.size());
+        const rounding::stochastic<rounding::hash_rng> sr{{12345u}, 1000u};
+        convert(std::span<const float32>(xs), std::span<float16>(zs), sr);
+        bool ok = true;
+        for(std::size_t i=0; i<xs.size(); ++i)
+        {
+            ok = ok && zs[i].base() == convert<float16>(xs[i], sr.for_element(i)).base();
+        }
+        boost::ut::expect(ok);
+    };
+};
+
+} // flemu
@@ -0,0 +1,101 @@
+#include <flemu/bit_proxy.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+namespace flemu
+{
+
+boost::ut::suite tests_bit_proxy = []
+{
+    using namespace boost::ut::literals;
+
+    "bit_proxy_substitution"_test = []
+    {
+        std::uint32_t u32 = 0x00FF'0F0F;
+        bit_proxy proxy1(u32, 15, 0);
+
+        boost::ut::expect(proxy1.start() ==  0);
+        boost::ut::expect(proxy1.stop()  == 15);
+        boost::ut::expect(proxy1.width() == 16);
+
+        const std::uint32_t proxy1_data(proxy1);
+        boost::ut::expect(proxy1      == 0x0F0F);
+        boost::ut::expect(proxy1_data == 0x0F0F);
+
+        proxy1 = 0xF0F0;
+        boost::ut::expect(u32 == 0x00FF'F0F0);
+
+        bit_proxy proxy2(u32, 23, 8);
+        boost::ut::expect(proxy2 == 0xFFF0);
+
+        proxy2 = 0x000F;
+        boost::ut::expect(u32 == 0x0000'0FF0);
+        boost::ut::expect(proxy2 == 0x000F);
+
+        bit_proxy proxy3(u32, 31, 16);
+        boost::ut::expect(proxy3 == 0x0000);
+
+        proxy3 = 0xDEAD;
+        boost::ut::expect(u32 == 0xDEAD'0FF0);
+        boost::ut::expect(proxy3 == 0xDEAD);
+
+        proxy1 = 0xBEEF'BEEF;
+        boost::ut::expect(u32 == 0xDEAD'BEEF);
+
+        bit_proxy proxy4(u32, 31, 31);
+        boost::ut::expect(proxy4 == 1);
+    };
+
+    "bit_proxy_comparison"_test = []
+    {
+        std::uint32_t u32 = 0x00FF'0F0F;
+        bit_proxy proxy1(u32, 15,  0); // 0F0F
+        bit_proxy proxy2(u32, 23,  8); // FF0F
+        bit_proxy proxy3(u32, 31, 16); // 00FF
+
+        boost::ut::expect(proxy1 < proxy2);
+        boost::ut::expect(proxy1 > proxy3);
+        boost::ut::expect(proxy2 > proxy3);
+    };
+
+    "static_bit_proxy"_test = []
+    {
+        std::uint32_t u32 = 0x00FF'0F0F;
+        static_bit_proxy<std::uint32_t,  0, 15> proxy1(u32);
+        static_bit_proxy<std::uint32_t,  8, 23> proxy2(u32);
+        static_bit_proxy<std::uint32_t, 31, 31> proxy3(u32);
+
+        static_assert(sizeof(proxy1) == sizeof(std::uint32_t*));
+        static_assert(proxy2.start() == 8 && proxy2.stop() == 23 && proxy2.width() == 16);
+        static_assert(decltype(proxy2)::field_mask == 0x00FF'FF00u);
+
+        boost::ut::expect(proxy1 == 0x0F0F);
+        boost::ut::expect(proxy2 == 0xFF0F);
+        boost::ut::expect(proxy3 == 0);
+
+        proxy1 = 0xBEEF'BEEF; // truncated to the width
+        boost::ut::expect(u32 == 0x00FF'BEEF);
+        proxy2 = 0xAD'BE;
+        boost::ut::expect(u32 == 0x00AD'BEEF);
+        proxy3 = 1;
+        boost::ut::expect(u32 == 0x80AD'BEEF);
+
+        const std::uint32_t c32 = 0xDEAD'BEEF;
+        const_static_bit_proxy<std::uint32_t, 16, 31> proxy4(c32);
+        boost::ut::expect(proxy4 == 0xDEAD);
+        boost::ut::expect(proxy4 > 0xDEAC);
+        boost::ut::expect(std::uint32_t(proxy4) == 0xDEADu);
+
+        // the conversion is a constant expression
+        static_assert([] {
+            std::uint8_t u8 = 0b1010'0110;
+            static_bit_proxy<std::uint8_t, 2, 5> p(u8);
+            p = 0b0011;
+            return std::uint8_t(p) == 0b0011 && u8 == 0b1000'1110;
+        }());
+    };
+};
+
+} // flemu
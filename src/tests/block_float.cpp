@@ -0,0 +1,259 @@
+#include <flemu/block_float.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace flemu
+{
+
+namespace
+{
+
+// the reference of a block: the exponent of the largest element, or the
+// next one if a rounded mantissa reaches 2^Mantissa (up to 254), and each
+// element rounded in double, where the values and the sums of the tests are
+// exact.
+template<typename Block, typename Rounding>
+std::vector<double> reference_block(const std::vector<double>& vs, const std::uint32_t emax, const Rounding&)
+{
+    for(std::uint32_t e=emax; ; ++e)
+    {
+        const double scale = std::ldexp(1.0, int(e) - 127 - int(Block::mantissa_bits - 1));
+        std::vector<double> ms(vs.size());
+        bool fits = true;
+        for(std::size_t i=0; i<vs.size(); ++i)
+        {
+            const double max = std::ldexp(1.0, Block::mantissa_bits) - 1.0;
+            const double r   = std::is_same_v<Rounding, rounding::toward_zero> ?
+                               std::trunc(std::abs(vs[i]) / scale) : std::nearbyint(std::abs(vs[i]) / scale);
+            const double m   = (e == 0xFE) ? std::min(r, max) : r; // saturates
+            fits = fits && m <= max;
+            ms[i] = std::copysign(m * scale, vs[i]);
+        }
+        if(fits)
+        {
+            return ms;
+        }
+    }
+}
+
+template<typename Block, typename Rounding = rounding::nearest_even>
+std::vector<double> reference_assign(const std::vector<float>& xs, const Rounding& rnd = Rounding{})
+{
+    std::vector<double> ref;
+    for(std::size_t first=0; first<xs.size(); first+=Block::block_size)
+    {
+        const std::size_t count = std::min(Block::block_size, xs.size() - first);
+        std::vector<double> vs(xs.begin() + first, xs.begin() + first + count);
+        std::uint32_t emax = 1;
+        for(const float v : vs)
+        {
+            emax = std::max(emax, std::uint32_t(to_flemu(v).exponent()));
+        }
+        const auto block = (emax == 0xFF) ? std::vector<double>(count, std::nan("")) :
+                                            reference_block<Block>(vs, emax, rnd);
+        ref.insert(ref.end(), block.begin(), block.end());
+    }
+    return ref;
+}
+
+template<typename Block>
+std::vector<double> reference_add(const Block& x, const Block& y)
+{
+    std::vector<double> ref;
+    for(std::size_t b=0; b<x.num_blocks(); ++b)
+    {
+        const std::size_t first = b * Block::block_size;
+        const std::size_t count = std::min(Block::block_size, x.size() - first);
+        const std::uint32_t ex = x.exponents()[b];
+        const std::uint32_t ey = y.exponents()[b];
+        std::vector<double> vs(count);
+        for(std::size_t i=0; i<count; ++i)
+        {
+            const double xi = to_float(x[first + i]);
+            const double yi = to_float(y[first + i]);
+            // an exact zero is +0 unless both are -0.
+            vs[i] = (xi + yi == 0.0) ? ((std::signbit(xi) && std::signbit(yi)) ? -0.0 : 0.0) : xi + yi;
+        }
+        const auto block = (ex == 0xFF || ey == 0xFF) ? std::vector<double>(count, std::nan("")) :
+                           reference_block<Block>(vs, std::max(ex, ey), rounding::nearest_even{});
+        ref.insert(ref.end(), block.begin(), block.end());
+    }
+    return ref;
+}
+
+template<typename Block>
+bool same_values(const Block& x, const std::vector<double>& ref)
+{
+    bool ok = x.size() == ref.size();
+    for(std::size_t i=0; ok && i<ref.size(); ++i)
+    {
+        const double v = to_float(x[i]);
+        ok = (std::isnan(v) && std::isnan(ref[i])) || (v == ref[i] && std::signbit(v) == std::signbit(ref[i]));
+    }
+    return ok;
+}
+
+template<typename Block>
+Block from_floats(const std::vector<float>& xs)
+{
+    std::vector<float32> fs(xs.size());
+    std::transform(xs.begin(), xs.end(), fs.begin(), to_flemu);
+    return Block(std::span<const float32>(fs));
+}
+
+// normally distributed values with a scale per block, 2^(-scale_range..scale_range).
+std::vector<float> random_blocks(std::mt19937& rng, const std::size_t n, const std::size_t block_size,
+                                 const int scale_range)
+{
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::uniform_int_distribution<int> scale(-scale_range, scale_range);
+    std::vector<float> xs(n);
+    int s = 0;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        s = (i % block_size == 0) ? scale(rng) : s;
+        xs[i] = std::ldexp(normal(rng), s);
+    }
+    return xs;
+}
+
+} // anonymous
+
+boost::ut::suite tests_block_float = []
+{
+    using namespace boost::ut::literals;
+
+    static_assert(std::is_same_v<msfp12::element_type, std::uint8_t>);
+    static_assert(std::is_same_v<block_float<15, 32>::element_type, std::uint16_t>);
+
+    "block_float conversion"_test = []
+    {
+        std::mt19937 rng(123456789);
+        auto xs = random_blocks(rng, 16 * 40 + 5, 16, 20);
+        xs[3]  = 0.0f;
+        xs[4]  = -0.0f;
+        xs[17] = 1.0e-40f;                // a denormal
+        xs[40] = HUGE_VALF;               // a nan block
+        xs[70] = std::nan("");
+        std::fill(xs.begin() + 96, xs.begin() + 112, 1.0e-42f); // a block of denormals
+        xs[112] = 0.99f;                  // carries out by rounding to 3 bits
+        xs[113] = 0.3f;
+        xs[128] = 3.3e38f;                // saturates in 3 bits
+
+        const auto x12 = from_floats<msfp12>(xs);
+        const auto x16 = from_floats<msfp16>(xs);
+        const auto x32 = from_floats<block_float<24, 32>>(xs);
+        boost::ut::expect(x12.size() == xs.size() && x12.num_blocks() == 41u);
+        boost::ut::expect(same_values(x12, reference_assign<msfp12>(xs)));
+        boost::ut::expect(same_values(x16, reference_assign<msfp16>(xs)));
+        boost::ut::expect(same_values(x32, reference_assign<block_float<24, 32>>(xs)));
+        boost::ut::expect(x12.exponents()[7] == 127u); // 0.99 -> 1.0
+        boost::ut::expect(to_float(x12[128]) == std::ldexp(7.0f, 125));
+
+        // toward zero, and the flags
+        std::vector<float32> fs(xs.size());
+        std::transform(xs.begin(), xs.end(), fs.begin(), to_flemu);
+        msfp16 y;
+        std::uint32_t f = 0;
+        y.assign(std::span<const float32>(fs), rounding::toward_zero{}, flags::accumulate{f});
+        boost::ut::expect(same_values(y, reference_assign<msfp16>(xs, rounding::toward_zero{})));
+        boost::ut::expect(f == flag_inexact); // toward zero does not carry out
+
+        // the values of a block that fit are exact
+        const std::vector<float> exact = {1.5f, -0.25f, 0.0f, 1.75f, -1.0f, 0.25f};
+        f = 0;
+        block_float<3, 4> z;
+        std::vector<float32> es(exact.size());
+        std::transform(exact.begin(), exact.end(), es.begin(), to_flemu);
+        z.assign(std::span<const float32>(es), rounding::nearest_even{}, flags::accumulate{f});
+        const auto back = z.to_float32();
+        for(std::size_t i=0; i<exact.size(); ++i)
+        {
+            boost::ut::expect(to_float(back[i]) == exact[i]);
+        }
+        boost::ut::expect(f == 0u);
+    };
+
+    "block_float add"_test = []
+    {
+        std::mt19937 rng(987654321);
+        const std::size_t n = 32 * 50 + 7;
+
+        // different scales, the same scale (the integer path) and cancellation
+        auto xs = random_blocks(rng, n, 32, 8);
+        auto ys = random_blocks(rng, n, 32, 8);
+        for(std::size_t i=0; i<n; ++i)
+        {
+            const std::size_t b = i / 32;
+            if(b % 5 == 1)
+            {
+                xs[i] = (i % 32 == 0) ?  0.75f : float(int(i % 7) - 3) / 8;
+                ys[i] = (i % 32 == 0) ? -0.75f : float(int(i % 5) - 2) / 8;
+            }
+            if(b % 5 == 2) {ys[i] = -xs[i];}
+            if(b % 5 == 3) {ys[i] = xs[i];} // carries out
+        }
+        xs[32 * 4 + 1] = std::nan("");
+
+        const auto x = from_floats<block_float<7, 32>>(xs);
+        const auto y = from_floats<block_float<7, 32>>(ys);
+        block_float<7, 32> z;
+        std::uint32_t f = 0;
+        add(x, y, z, rounding::nearest_even{}, flags::accumulate{f});
+        boost::ut::expect(same_values(z, reference_add(x, y)));
+        boost::ut::expect(f == flag_inexact);
+        boost::ut::expect(z.exponents()[1] == x.exponents()[1]);
+        boost::ut::expect(z.exponents()[3] == x.exponents()[3] + 1u);
+        boost::ut::expect(z.exponents()[4] == 0xFFu);
+        boost::ut::expect(std::signbit(to_float(z[64])) == false);
+
+        const auto x12 = from_floats<msfp12>(xs);
+        const auto y12 = from_floats<msfp12>(ys);
+        msfp12 z12;
+        add(x12, y12, z12);
+        boost::ut::expect(same_values(z12, reference_add(x12, y12)));
+
+        // acc += x in place
+        auto acc = y;
+        accumulate(acc, x);
+        boost::ut::expect(acc.exponents().size() == z.exponents().size());
+        bool same = true;
+        for(std::size_t i=0; i<n; ++i)
+        {
+            same = same && acc[i].base() == z[i].base();
+        }
+        boost::ut::expect(same);
+
+        // a sum of many blocks of the same scale stays exact until it carries out
+        const std::vector<float> ones(16, 1.0f / 128);
+        auto sum = from_floats<msfp16>(std::vector<float>(16, 0.0f));
+        const auto one = from_floats<msfp16>(ones);
+        for(int i=0; i<100; ++i)
+        {
+            accumulate(sum, one);
+        }
+        boost::ut::expect(to_float(sum[15]) == 100.0f / 128);
+    };
+
+    "block_float add, saturation"_test = []
+    {
+        const auto x = from_floats<msfp12>(std::vector<float>(16, 3.0e38f));
+        msfp12 z;
+        std::uint32_t f = 0;
+        add(x, x, z, rounding::nearest_even{}, flags::accumulate{f});
+        boost::ut::expect(z.exponents()[0] == 0xFEu);
+        boost::ut::expect(to_float(z[0]) == std::ldexp(7.0f, 125));
+        boost::ut::expect(f == (flag_overflow | flag_inexact));
+    };
+};
+
+} // flemu
@@ -0,0 +1,129 @@
+#include <flemu/convert.hpp>
+#include "test_detail.hpp"
+
+#include <boost/ut.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+#include <random>
+#include <span>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_convert = []
+{
+    using namespace boost::ut::literals;
+
+    "convert(float32) to narrower formats"_test = []
+    {
+        // float32 is exact in double, so the reference rounds its value.
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits;
+
+        const auto check = [&]<typename To>(const To, const auto rnd) {
+            for(std::size_t i=0; i<100000; ++i)
+            {
+                const float32 x(bits(rng));
+                const To z  = convert<To>(x, rnd);
+                const To zr = test_detail::round_to<To>(test_detail::to_double(x), rnd);
+                boost::ut::expect(test_detail::same_value(z, zr)) << "convert(" << bits_of(x.base())
+                    << ") = " << bits_of(z.base()) << " != " << bits_of(zr.base());
+            }
+        };
+        const auto check_all = [&](const auto to) {
+            check(to, rounding::nearest_even{});
+            check(to, rounding::toward_zero{});
+            check(to, rounding::toward_positive{});
+            check(to, rounding::toward_negative{});
+        };
+        check_all(tfloat32{});
+        check_all(bfloat16{});
+        check_all(float16{});
+        check_all(float8_e5m2{});
+        check_all(float8_e4m3{});
+
+        // ties, the sign of zero and the flags
+        boost::ut::expect(convert<bfloat16>(to_flemu(1.0f + 0x1.0p-8f)).base() == bfloat16(0, 127, 0).base());
+        boost::ut::expect(convert<bfloat16>(to_flemu(1.0f + 0x3.0p-8f)).base() == bfloat16(0, 127, 2).base());
+        boost::ut::expect(convert<float16>(to_flemu(-0.0f)).base() == float16(1, 0, 0).base());
+
+        std::uint32_t f = 0;
+        convert<float16>(to_flemu(1.0e6f), rounding::nearest_even{}, flags::accumulate{f});
+        boost::ut::expect(f == (flag_overflow | flag_inexact));
+        f = 0;
+        convert<float16>(to_flemu(0x1.8p-25f), rounding::nearest_even{}, flags::accumulate{f});
+        boost::ut::expect(f == (flag_underflow | flag_inexact));
+        f = 0;
+        convert<float16>(to_flemu(0x1.0p-24f), rounding::nearest_even{}, flags::accumulate{f});
+        boost::ut::expect(f == 0u) << "the smallest denormal is exact";
+    };
+
+    "saturating conversion"_test = []
+    {
+        using sat = rounding::saturating<rounding::nearest_even>;
+
+        // an overflow becomes the max finite of its sign, with the same flags
+        std::uint32_t f = 0;
+        boost::ut::expect(convert<float8_e4m3>(to_flemu(1000.0f), sat{}, flags::accumulate{f}).base() ==
+                          float8_e4m3(0, 14, 7).base());
+        boost::ut::expect(f == (flag_overflow | flag_inexact));
+        boost::ut::expect(convert<float16>(to_flemu(-1.0e6f), sat{}).base() == float16(1, 30, 0x3FF).base());
+
+        // inf and nan are kept, and the rest rounds as nearest_even
+        boost::ut::expect(convert<float16>(to_flemu(-HUGE_VALF), sat{}).is_inf());
+        boost::ut::expect(convert<float16>(float32(0x7FC0'0000u), sat{}).is_nan());
+        boost::ut::expect(convert<bfloat16>(to_flemu(1.0f + 0x3.0p-8f), sat{}).base() == bfloat16(0, 127, 2).base());
+
+        // it is a rounding mode of the other operations, too
+        const float16 max(0, 30, 0x3FF);
+        boost::ut::expect(add(max, max, sat{}).base() == max.base());
+        boost::ut::expect(add(max, max).is_inf());
+    };
+
+    "convert to float32 is exact"_test = []
+    {
+        const auto round_trip = []<typename From>(const From) {
+            using base_type = typename From::base_type;
+            bool ok = true;
+            for(std::uint32_t b=0; b < (std::uint32_t(1) << (From::sign_bit + 1)); ++b)
+            {
+                const From x(static_cast<base_type>(b));
+                const float32 y = convert<float32>(x);
+                std::uint32_t f = 0;
+                const From z = convert<From>(y, rounding::nearest_even{}, flags::accumulate{f});
+                ok = ok && test_detail::same_value(z, x) && f == 0 &&
+                     (x.is_nan() || test_detail::to_double(y) == test_detail::to_double(x));
+            }
+            return ok;
+        };
+        boost::ut::expect(round_trip(bfloat16{}));
+        boost::ut::expect(round_trip(float16{}));
+        boost::ut::expect(round_trip(float8_e5m2{}));
+        boost::ut::expect(round_trip(float8_e4m3{}));
+
+#if defined(__cpp_lib_bit_cast)
+        static_assert(to_float(convert<float32>(convert<bfloat16>(to_flemu(3.14159f)))) == 3.140625f);
+#endif
+    };
+
+    "convert(span, span)"_test = []
+    {
+        std::vector<float32> xs(1000);
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits;
+        for(auto& x : xs) {x = float32(bits(rng));}
+
+        std::vector<float8_e4m3> zs(xs.size());
+        const rounding::stochastic<rounding::hash_rng> sr{{12345u}, 1000u};
+        convert(std::span<const float32>(xs), std::span<float8_e4m3>(zs), sr);
+        for(std::size_t i=0; i<xs.size(); ++i)
+        {
+            boost::ut::expect(zs[i].base() == convert<float8_e4m3>(xs[i], sr.for_element(i)).base());
+        }
+    };
+};
+
+} // flemu
@@ -0,0 +1,57 @@
+#include <flemu/counters.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <string>
+#include <thread>
+
+namespace flemu
+{
+namespace counters
+{
+
+boost::ut::suite tests_counters = []
+{
+    using namespace boost::ut::literals;
+
+    "counters"_test = []
+    {
+        // the probe is called by hand here; see the tests of add for the paths.
+        const auto one_add = [](const bool cancel) {
+            const add_probe probe;
+            probe(add_point::subtraction,  cancel);
+            probe(add_point::cancellation, cancel);
+            probe(add_measure::exponent_gap,        cancel ? 0u : 40u);
+            probe(add_measure::normalization_shift, cancel ? 5u : 0u);
+        };
+
+        reset();
+        one_add(true);
+        one_add(false);
+
+        // the counts of an exited thread are kept
+        std::thread([&] {for(int i=0; i<3; ++i) {one_add(true);}}).join();
+
+        const add_counts c = snapshot();
+        boost::ut::expect(c.calls == 5u);
+        boost::ut::expect(c.taken[static_cast<std::uint32_t>(add_point::cancellation)] == 4u);
+        boost::ut::expect(c.not_taken(add_point::subtraction) == 1u);
+        boost::ut::expect(c.not_taken(add_point::swap) == 5u);
+        boost::ut::expect(c.exponent_gap[0] == 4u && c.exponent_gap[add_measure_bins - 1] == 1u);
+        boost::ut::expect(c.normalization_shift[5] == 4u && c.normalization_shift[0] == 1u);
+
+        const std::string json = to_json(c);
+        boost::ut::expect(json.starts_with("{\"calls\": 5,"));
+        boost::ut::expect(json.find("\"cancellation\": {\"taken\": 4, \"not_taken\": 1}") != std::string::npos);
+        boost::ut::expect(json.find("\"normalization_shift\": [1, 0, 0, 0, 0, 4, 0") != std::string::npos);
+        boost::ut::expect(json.ends_with("]}\n"));
+
+        reset();
+        boost::ut::expect(snapshot().calls == 0u);
+    };
+};
+
+} // counters
+} // flemu
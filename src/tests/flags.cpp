@@ -0,0 +1,37 @@
+#include <flemu/flags.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+namespace flemu
+{
+
+boost::ut::suite tests_flags = []
+{
+    using namespace boost::ut::literals;
+
+    "flags"_test = []
+    {
+        clear_flags();
+        boost::ut::expect(test_flags() == 0u);
+
+        flags::thread_status{}.raise(flag_inexact);
+        flags::thread_status{}.raise(flag_overflow);
+        boost::ut::expect(test_flags() == (flag_inexact | flag_overflow));
+        boost::ut::expect(test_flags(flag_invalid) == 0u);
+
+        clear_flags(flag_inexact);
+        boost::ut::expect(test_flags() == flag_overflow);
+        clear_flags();
+        boost::ut::expect(test_flags() == 0u);
+
+        std::uint32_t word = 0;
+        flags::accumulate{word}.raise(flag_invalid);
+        flags::ignore{}.raise(flag_underflow);
+        boost::ut::expect(word == flag_invalid);
+        boost::ut::expect(test_flags() == 0u);
+    };
+};
+
+} // flemu
@@ -0,0 +1,94 @@
+#include <flemu/float32.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <type_traits>
+
+namespace flemu
+{
+
+boost::ut::suite tests_basic_float32 = []
+{
+    using namespace boost::ut::literals;
+
+    "float32"_test = []
+    {
+        float32 x1(0b0'10000000'1101'1011'0110'1101'1011'011);
+
+        boost::ut::expect(x1.base() == 0b0'10000000'1101'1011'0110'1101'1011'011);
+
+        boost::ut::expect(x1.sign() == 0);
+        boost::ut::expect(x1.exponent() == 0b1000'0000);
+        boost::ut::expect(x1.mantissa() == 0b1101'1011'0110'1101'1011'011);
+
+        float32 x2(0b1'01111111'1101'1011'0110'1101'1011'011);
+
+        boost::ut::expect(x2.base() == 0b1'01111111'1101'1011'0110'1101'1011'011);
+
+        boost::ut::expect(x2.sign() == 1);
+        boost::ut::expect(x2.exponent() == 0b0111'1111);
+        boost::ut::expect(x2.mantissa() == 0b1101'1011'0110'1101'1011'011);
+
+        const float32 x3(0b0'10000000'1101'1011'0110'1101'1011'011);
+
+        boost::ut::expect(x3.base() == 0b0'10000000'1101'1011'0110'1101'1011'011);
+
+        boost::ut::expect(x3.sign() == 0);
+        boost::ut::expect(x3.exponent() == 0b1000'0000);
+        boost::ut::expect(x3.mantissa() == 0b1101'1011'0110'1101'1011'011);
+
+        const float32 x4(0b1'01111111'1101'1011'0110'1101'1011'011);
+
+        boost::ut::expect(x4.base() == 0b1'01111111'1101'1011'0110'1101'1011'011);
+
+        boost::ut::expect(x4.sign() == 1);
+        boost::ut::expect(x4.exponent() == 0b0111'1111);
+        boost::ut::expect(x4.mantissa() == 0b1101'1011'0110'1101'1011'011);
+    };
+
+    "float64"_test = []
+    {
+        static_assert(std::is_same_v<float64::base_type, std::uint64_t>);
+        static_assert(float64::exponent_max == 0x7FFu);
+
+        const float64 x = to_flemu64(-1.5);
+        boost::ut::expect(x.base() == 0xBFF8'0000'0000'0000ull);
+        boost::ut::expect(x.sign() == 1u);
+        boost::ut::expect(x.exponent() == 1023u);
+        boost::ut::expect(x.mantissa() == 0x8'0000'0000'0000ull);
+        boost::ut::expect(to_double(x) == -1.5);
+        boost::ut::expect(float64(0, 0x7FF, 0).is_inf() && float64(1, 0x7FF, 1).is_nan());
+    };
+
+    "basic_float"_test = []
+    {
+        static_assert(std::is_same_v<float16::base_type,     std::uint16_t>);
+        static_assert(std::is_same_v<bfloat16::base_type,    std::uint16_t>);
+        static_assert(std::is_same_v<float8_e4m3::base_type, std::uint8_t>);
+        static_assert(std::is_same_v<float8_e5m2::base_type, std::uint8_t>);
+        static_assert(std::is_same_v<tfloat32::base_type,    std::uint32_t>);
+
+        const float8_e4m3 x1(0b1'0110'101);
+        boost::ut::expect(x1.sign() == 1);
+        boost::ut::expect(x1.exponent() == 0b0110);
+        boost::ut::expect(x1.mantissa() == 0b101);
+        boost::ut::expect(float8_e4m3(1, 0b0110, 0b101).base() == x1.base());
+        boost::ut::expect(float8_e4m3(0, 0b1111, 0b000).is_inf());
+        boost::ut::expect(float8_e4m3(0, 0b1111, 0b001).is_nan());
+
+        const bfloat16 x2(0b0'10000000'1101101);
+        boost::ut::expect(x2.sign() == 0);
+        boost::ut::expect(x2.exponent() == 0b1000'0000);
+        boost::ut::expect(x2.mantissa() == 0b1101101);
+        boost::ut::expect(bfloat16(0, 0b1000'0000, 0b1101101).base() == x2.base());
+
+        // tf32 has the same exponent as float32 and uses the lowest 19 bits.
+        const tfloat32 x3(1, 0b1000'0000, 0b11'0110'1101);
+        boost::ut::expect(x3.base() == 0b1'10000000'1101101101);
+        boost::ut::expect(x3.sign() == 1);
+    };
+};
+
+} // flemu
@@ -0,0 +1,109 @@
+#include <flemu/float32_soa.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#include <array>
+#include <random>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_float32_soa = []
+{
+    using namespace boost::ut::literals;
+
+    "float32_soa"_test = []
+    {
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits;
+
+        const std::size_t N = 1003;
+        std::vector<float32> xs(N), ys(N);
+        for(std::size_t i=0; i<N; ++i)
+        {
+            xs[i] = float32(bits(rng));
+            ys[i] = float32((i % 3 == 0) ? (xs[i].base() ^ 0x8000'0000u) + bits(rng) % 5 - 2 : bits(rng));
+        }
+
+        // conversions
+        const float32_soa x(xs), y(ys);
+        boost::ut::expect(x.size() == N);
+        boost::ut::expect(reinterpret_cast<std::uintptr_t>(x.exponents().data()) % float32_soa::alignment == 0u);
+        boost::ut::expect(reinterpret_cast<std::uintptr_t>(x.mantissas().data()) % float32_soa::alignment == 0u);
+        const auto xs_back = x.to_float32();
+        for(std::size_t i=0; i<N; ++i)
+        {
+            boost::ut::expect(x[i].base() == xs[i].base());
+            boost::ut::expect(xs_back[i].base() == xs[i].base());
+            boost::ut::expect(x.exponents()[i] == std::uint32_t(xs[i].exponent()));
+        }
+        std::vector<float> fs(N);
+        for(std::size_t i=0; i<N; ++i) {fs[i] = to_float(xs[i]);}
+        const auto back = float32_soa(fs).to_float();
+        boost::ut::expect(std::memcmp(back.data(), fs.data(), N * sizeof(float)) == 0);
+
+        // add on the planes in each kernel, with and without flags
+        std::vector<float32> ref(N);
+        for(std::size_t i=0; i<N; ++i) {ref[i] = add(xs[i], ys[i]);}
+
+        float32_soa z;
+        const auto check = [&](const char* name) {
+            for(std::size_t i=0; i<N; ++i)
+            {
+                boost::ut::expect(z[i].base() == ref[i].base()) << name << ": " << bits_of(xs[i].base())
+                    << " + " << bits_of(ys[i].base()) << " = " << bits_of(z[i].base())
+                    << " != " << bits_of(ref[i].base());
+            }
+        };
+        add(x, y, z);
+        check("dispatched");
+
+        z = float32_soa(N);
+        detail::soa_add_kernel_scalar(detail::planes_of(x), detail::planes_of(y), detail::planes_of(z), N);
+        check("scalar");
+#ifdef FLEMU_BATCH_ADDER_X86
+        if(__builtin_cpu_supports("avx2"))
+        {
+            z = float32_soa(N);
+            detail::soa_add_kernel_avx2(detail::planes_of(x), detail::planes_of(y), detail::planes_of(z), N);
+            check("avx2");
+        }
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd"))
+        {
+            z = float32_soa(N);
+            detail::soa_add_kernel_avx512(detail::planes_of(x), detail::planes_of(y), detail::planes_of(z), N);
+            check("avx512");
+        }
+#endif
+        std::uint32_t expected = 0, word = 0;
+        for(std::size_t i=0; i<N; ++i) {add(xs[i], ys[i], rounding::nearest_even{}, flags::accumulate{expected});}
+        add(x, y, z, rounding::nearest_even{}, flags::accumulate{word});
+        boost::ut::expect(word == expected) << word << " != " << expected;
+        check("flags");
+
+        for(std::size_t i=0; i<N; ++i) {ref[i] = add(xs[i], ys[i], rounding::toward_zero{});}
+        add(x, y, z, rounding::toward_zero{});
+        check("toward_zero");
+
+        // in place
+        float32_soa w(xs);
+        add(w, y, w);
+        for(std::size_t i=0; i<N; ++i)
+        {
+            boost::ut::expect(w[i].base() == add(xs[i], ys[i]).base());
+        }
+
+        // a pass over only one plane
+        std::array<std::size_t, 256> histogram{};
+        for(const auto e : x.exponents()) {histogram[e] += 1;}
+        std::size_t total = 0;
+        for(const auto h : histogram) {total += h;}
+        boost::ut::expect(total == N);
+    };
+};
+
+} // flemu
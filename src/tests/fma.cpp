@@ -0,0 +1,174 @@
+#include <flemu/fma.hpp>
+#include "test_detail.hpp"
+
+#include <boost/ut.hpp>
+
+#include <cfenv>
+#include <cmath>
+#include <cstdint>
+
+#include <random>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_fma = []
+{
+    using namespace boost::ut::literals;
+
+    "fma(float32, float32, float32)"_test = []
+    {
+        const auto one = to_flemu(1.0f);
+        const auto eps = to_flemu(0x1.0p-23f);
+
+        // (1 + eps)(1 - eps) - 1 == -eps^2, which is lost without FMA
+        const auto z1 = fma(add(one, eps), add(one, float32(eps.base() ^ 0x8000'0000u)),
+                            to_flemu(-1.0f));
+        boost::ut::expect(to_float(z1) == -0x1.0p-46f);
+
+        boost::ut::expect(to_float(fma(to_flemu(2.0f), to_flemu(3.0f), to_flemu(4.0f))) == 10.0f);
+#if defined(__cpp_lib_bit_cast)
+        static_assert(to_float(fma(to_flemu(2.0f), to_flemu(3.0f), to_flemu(4.0f))) == 10.0f);
+        static_assert(to_float(fma(to_flemu(0x1.000002p0f), to_flemu(0x1.FFFFFCp-1f), to_flemu(-1.0f))) == -0x1.0p-46f);
+#endif
+
+        std::mt19937 rng(123456789);
+
+        std::uniform_int_distribution<std::uint32_t> sgn(0,   1);
+        std::uniform_int_distribution<std::uint32_t> exp(0, 255);
+        std::uniform_int_distribution<std::uint32_t> man(0, 0x007F'FFFF);
+        std::uniform_int_distribution<std::uint32_t> cls(0,   7);
+
+        const auto generate = [&](const std::uint32_t e) {
+            return (sgn(rng) << 31) + (e << 23) + man(rng);
+        };
+
+        const std::size_t N = 10000;
+        std::vector<float32> as(N), bs(N), cs(N), zs(N);
+        for(std::size_t i=0; i<N; ++i)
+        {
+            switch(cls(rng))
+            {
+                case 0: // denormal or tiny product
+                {
+                    as[i] = float32(generate(exp(rng) % 64));
+                    bs[i] = float32(generate(exp(rng) % 64 + 64));
+                    cs[i] = float32(generate(exp(rng) % 4));
+                    break;
+                }
+                case 1: // cancellation of c and the product
+                {
+                    as[i] = float32(generate(exp(rng) % 64 + 96));
+                    bs[i] = float32(generate(exp(rng) % 64 + 96));
+                    const float p = to_float(as[i]) * to_float(bs[i]);
+                    cs[i] = float32(bit_cast<std::uint32_t>(-p) + man(rng) % 5 - 2);
+                    break;
+                }
+                case 2: // close exponents
+                {
+                    as[i] = float32(generate(exp(rng) % 32 + 112));
+                    bs[i] = float32(generate(exp(rng) % 32 + 112));
+                    cs[i] = float32(generate(exp(rng) % 64 + 96));
+                    break;
+                }
+                default:
+                {
+                    as[i] = float32(generate(exp(rng)));
+                    bs[i] = float32(generate(exp(rng)));
+                    cs[i] = float32(generate(exp(rng)));
+                    break;
+                }
+            }
+        }
+        fma(as, bs, cs, zs);
+
+        // flags. x86 detects tininess after rounding and flemu before, so
+        // underflow is not compared.
+        const std::uint32_t compared = flag_invalid | flag_overflow | flag_inexact;
+        for(std::size_t i=0; i<N; ++i)
+        {
+            volatile float ar = to_float(as[i]), br = to_float(bs[i]), cr = to_float(cs[i]);
+            std::feclearexcept(FE_ALL_EXCEPT);
+            volatile float zr = std::fma(ar, br, cr);
+            const int e = std::fetestexcept(FE_ALL_EXCEPT);
+            static_cast<void>(zr);
+
+            // signaling nans raise invalid on the hardware
+            const auto snan = [](const float32 v) {return v.is_nan() && (v.base() & 0x0040'0000u) == 0;};
+            if(snan(as[i]) || snan(bs[i]) || snan(cs[i])) {continue;}
+
+            const std::uint32_t fr = ((e & FE_INVALID) ? flag_invalid  : 0u) |
+                ((e & FE_OVERFLOW) ? flag_overflow : 0u) | ((e & FE_INEXACT) ? flag_inexact : 0u);
+            std::uint32_t f = 0;
+            fma(as[i], bs[i], cs[i], rounding::nearest_even{}, flags::accumulate{f});
+            boost::ut::expect((f & compared) == fr) << "fma(" << bits_of(as[i].base()) << ", "
+                << bits_of(bs[i].base()) << ", " << bits_of(cs[i].base()) << "): " << f << " != " << fr;
+        }
+
+        for(std::size_t i=0; i<N; ++i)
+        {
+            const float zr = std::fma(to_float(as[i]), to_float(bs[i]), to_float(cs[i]));
+            const auto  z  = fma(as[i], bs[i], cs[i]);
+
+            boost::ut::expect(z.base() == zs[i].base());
+            if(std::isnan(zr))
+            {
+                boost::ut::expect(z.is_nan()) << "fma(" << bits_of(as[i].base()) << ", "
+                    << bits_of(bs[i].base()) << ", " << bits_of(cs[i].base()) << ") = "
+                    << bits_of(z.base()) << " is not nan";
+            }
+            else
+            {
+                boost::ut::expect(z.base() == bit_cast<std::uint32_t>(zr)) << "fma("
+                    << bits_of(as[i].base()) << ", " << bits_of(bs[i].base()) << ", "
+                    << bits_of(cs[i].base()) << ") = " << bits_of(z.base()) << " != "
+                    << bits_of(bit_cast<std::uint32_t>(zr));
+            }
+        }
+    };
+
+    "fma(basic_float)"_test = []
+    {
+        // a * b + c of fp8 is exact in double.
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits(0, 255);
+        for(std::size_t i=0; i<100000; ++i)
+        {
+            const float8_e4m3 a(static_cast<std::uint8_t>(bits(rng)));
+            const float8_e4m3 b(static_cast<std::uint8_t>(bits(rng)));
+            const float8_e4m3 c(static_cast<std::uint8_t>(bits(rng)));
+            const auto z  = fma(a, b, c);
+            const auto zr = test_detail::round_to_nearest<float8_e4m3>(
+                test_detail::to_double(a) * test_detail::to_double(b) + test_detail::to_double(c));
+            boost::ut::expect(test_detail::same_value(z, zr)) << "fma(" << bits_of(a.base()) << ", "
+                << bits_of(b.base()) << ", " << bits_of(c.base()) << ") = " << bits_of(z.base())
+                << " != " << bits_of(zr.base());
+        }
+
+        // directed rounding. the sign of an exact zero is given by the mode.
+        const auto directed = [&rng, &bits](const auto rnd) {
+            for(std::size_t i=0; i<100000; ++i)
+            {
+                const float8_e4m3 a(static_cast<std::uint8_t>(bits(rng)));
+                const float8_e4m3 b(static_cast<std::uint8_t>(bits(rng)));
+                const float8_e4m3 c(static_cast<std::uint8_t>(bits(rng)));
+                const double v = test_detail::to_double(a) * test_detail::to_double(b) + test_detail::to_double(c);
+                const std::uint32_t psgn = (a.base() ^ b.base()) >> 7;
+                const auto z  = fma(a, b, c, rnd);
+                const auto zr = (v == 0.0) ?
+                    float8_e4m3(static_cast<std::uint8_t>(decltype(rnd)::exact_zero_sign(
+                        psgn, std::uint32_t(c.base() >> 7)) << 7)) :
+                    test_detail::round_to<float8_e4m3>(v, rnd);
+                boost::ut::expect(test_detail::same_value(z, zr)) << "fma(" << bits_of(a.base()) << ", "
+                    << bits_of(b.base()) << ", " << bits_of(c.base()) << ") = " << bits_of(z.base())
+                    << " != " << bits_of(zr.base());
+            }
+        };
+        directed(rounding::toward_zero{});
+        directed(rounding::toward_positive{});
+        directed(rounding::toward_negative{});
+    };
+};
+
+} // flemu
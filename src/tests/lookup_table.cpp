@@ -0,0 +1,78 @@
+#include <flemu/lookup_table.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_lookup_table = []
+{
+    using namespace boost::ut::literals;
+
+    "binary_lookup_table"_test = []
+    {
+        const auto check = [](auto tag) {
+            using float_type = decltype(tag);
+            using base_type  = typename float_type::base_type;
+
+            const auto op = [](const float_type x, const float_type y) {return add(x, y);};
+            boost::ut::expect(lut::add_table<float_type>().verify(op));
+            boost::ut::expect(reinterpret_cast<std::uintptr_t>(lut::add_table<float_type>().data()) % 64 == 0);
+
+            // all the pairs, in an order that is not a multiple of the width
+            std::vector<float_type> xs, ys;
+            for(std::uint32_t x=0; x<256; ++x)
+            {
+                for(std::uint32_t y=0; y<256; ++y)
+                {
+                    xs.emplace_back(base_type(x));
+                    ys.emplace_back(base_type(y));
+                }
+            }
+            xs.emplace_back(base_type(0x42));
+            ys.emplace_back(base_type(0x24));
+
+            std::vector<float_type> zs(xs.size());
+            const auto check_all = [&](const char* name) {
+                for(std::size_t i=0; i<xs.size(); ++i)
+                {
+                    boost::ut::expect(zs[i].base() == add(xs[i], ys[i]).base()) << name << ": "
+                        << bits_of(xs[i].base()) << " + " << bits_of(ys[i].base());
+                }
+            };
+
+            lut::add<float_type::exponent_bits, float_type::mantissa_bits,
+                     float_type::exponent_bias, base_type>(xs, ys, zs);
+            check_all("dispatched");
+
+            const auto raw = [](auto& v) {return reinterpret_cast<std::uint8_t*>(v.data());};
+            const auto* table = lut::add_table<float_type>().data();
+            detail::lookup_kernel_scalar(table, raw(xs), raw(ys), raw(zs), zs.size());
+            check_all("scalar");
+#ifdef FLEMU_LOOKUP_TABLE_X86
+            if(__builtin_cpu_supports("avx2"))
+            {
+                detail::lookup_kernel_avx2(table, raw(xs), raw(ys), raw(zs), zs.size());
+                check_all("avx2");
+            }
+            if(__builtin_cpu_supports("avx512f"))
+            {
+                detail::lookup_kernel_avx512(table, raw(xs), raw(ys), raw(zs), zs.size());
+                check_all("avx512");
+            }
+#endif
+            for(std::size_t i=0; i<xs.size(); i += 97)
+            {
+                boost::ut::expect(lut::add(xs[i], ys[i]).base() == add(xs[i], ys[i]).base());
+            }
+        };
+        check(float8_e4m3{});
+        check(float8_e5m2{});
+    };
+};
+
+} // flemu
@@ -0,0 +1,47 @@
+#include <flemu/operation_trace.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <sstream>
+
+namespace flemu
+{
+
+boost::ut::suite tests_operation_trace = []
+{
+    using namespace boost::ut::literals;
+
+    "operation_trace"_test = []
+    {
+        operation_trace<std::uint8_t, 2, 3> trace("add");
+        boost::ut::expect(trace.size() == 0u);
+
+        trace.record({1, 2}, 3, 3);
+        trace.record({4, 5}, 9, 9);
+        boost::ut::expect(trace.size() == 2u);
+        boost::ut::expect(trace[0].result == 3u);
+
+        // wraps around; the oldest one is dropped
+        trace.record({6, 7}, 13, 13);
+        trace.record({8, 9}, 16, 17);
+        boost::ut::expect(trace.size() == 3u);
+        boost::ut::expect(trace.count() == 4u);
+        boost::ut::expect(trace[0].operands[0] == 4u);
+        boost::ut::expect(trace[2].operands[1] == 9u);
+
+        std::ostringstream oss;
+        oss << trace;
+        boost::ut::expect(oss.str() ==
+            "last 3 of 4 add:\n"
+            "  add(0000'0100, 0000'0101) = 0000'1001, expected 0000'1001\n"
+            "  add(0000'0110, 0000'0111) = 0000'1101, expected 0000'1101\n"
+            "  add(0000'1000, 0000'1001) = 0001'0000, expected 0001'0001 <-\n") << oss.str();
+
+        trace.clear();
+        boost::ut::expect(trace.size() == 0u);
+    };
+};
+
+} // flemu
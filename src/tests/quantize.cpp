@@ -0,0 +1,61 @@
+#include <flemu/quantize.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cmath>
+
+#include <algorithm>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_quantize = []
+{
+    using namespace boost::ut::literals;
+
+    "quantize"_test = []
+    {
+        std::mt19937 rng(123456789);
+        std::normal_distribution<float> dist(0.0f, 100.0f);
+        std::vector<float32> xs(200000);
+        for(auto& x : xs) {x = to_flemu(dist(rng));}
+        xs[10] = to_flemu(HUGE_VALF);
+        xs[11] = to_flemu(1.0e6f); // overflows in float16
+        const std::span<const float32> x(xs);
+
+        std::vector<float16> qs(xs.size());
+        std::vector<float32> ys(xs.size());
+        const auto s1 = quantize<float16>(x, std::span<float16>(qs), 1);
+        const auto s4 = quantize<float16>(x, std::span<float32>(ys), 4);
+
+        bool ok = true;
+        for(std::size_t i=0; i<xs.size(); ++i)
+        {
+            ok = ok && qs[i].base() == convert<float16>(xs[i]).base() &&
+                 ys[i].base() == convert<float32>(qs[i]).base();
+        }
+        boost::ut::expect(ok);
+
+        boost::ut::expect(s1.count == xs.size() - 2 && s1.nonfinite == 1u && s1.overflows == 1u);
+        boost::ut::expect(s1.max_ulp <= 0.5 && s1.max_ulp > 0.49) << s1.max_ulp;
+        boost::ut::expect(s1.rms() > 0.0);
+        boost::ut::expect(s1.sum_squared_error == s4.sum_squared_error && s1.max_ulp == s4.max_ulp);
+
+        // truncation is off by up to 1 ulp. stochastic rounding does not depend on the threads.
+        const auto tz = quantize<bfloat16>(x, std::span<float32>(ys), rounding::toward_zero{});
+        boost::ut::expect(tz.max_ulp < 1.0 && tz.max_ulp > 0.99) << tz.max_ulp;
+
+        const rounding::stochastic<rounding::hash_rng> sr{{42u}};
+        std::vector<float32> zs(xs.size());
+        const auto sr1 = quantize<bfloat16>(x, std::span<float32>(ys), sr, 1);
+        const auto sr3 = quantize<bfloat16>(x, std::span<float32>(zs), sr, 3);
+        boost::ut::expect(std::equal(ys.begin(), ys.end(), zs.begin(),
+                          [](const float32 a, const float32 b) {return a.base() == b.base();}));
+        boost::ut::expect(sr1.sum_squared_error == sr3.sum_squared_error);
+    };
+};
+
+} // flemu
@@ -0,0 +1,106 @@
+#include <flemu/radix_sort.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_radix_sort = []
+{
+    using namespace boost::ut::literals;
+
+    // larger than detail::parallel_sort_threshold, not a multiple of the chunk
+    constexpr std::size_t N = (std::size_t(1) << 18) + 123;
+
+    const auto random_inputs = []<typename Float>(const Float, const std::size_t n) {
+        using base_type = typename Float::base_type;
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits;
+        std::vector<Float> xs(n);
+        for(auto& x : xs) {x = Float(static_cast<base_type>(bits(rng)));}
+        return xs;
+    };
+
+    "radix_sort"_test = [=]
+    {
+        const auto check = [&]<typename Float>(const Float f, const char* name) {
+            const auto xs = random_inputs(f, N);
+            auto ref = xs;
+            std::stable_sort(ref.begin(), ref.end(), total_order_less{});
+            for(const std::size_t threads : {1, 3})
+            {
+                auto zs = xs;
+                radix_sort(std::span<Float>(zs), threads);
+                bool ok = true;
+                for(std::size_t i=0; i<N; ++i) {ok = ok && zs[i].base() == ref[i].base();}
+                boost::ut::expect(ok) << name << " on " << threads << " threads";
+            }
+        };
+        check(float32{},     "float32");
+        check(tfloat32{},    "tfloat32");
+        check(float16{},     "float16");
+        check(float8_e4m3{}, "float8_e4m3");
+
+        // a pass where all the keys have the same digit is skipped
+        std::vector<float32> same_exponent(1000);
+        for(std::size_t i=0; i<same_exponent.size(); ++i)
+        {
+            same_exponent[i] = float32(0x3F80'0000u + std::uint32_t(same_exponent.size() - i));
+        }
+        radix_sort(std::span<float32>(same_exponent));
+        boost::ut::expect(std::is_sorted(same_exponent.begin(), same_exponent.end(), total_order_less{}));
+
+        std::vector<float32> empty;
+        radix_sort(std::span<float32>(empty));
+    };
+
+    "top_k"_test = [=]
+    {
+        const auto check = [&]<typename Float>(const Float f, const char* name) {
+            const auto xs = random_inputs(f, N);
+            auto ref = xs;
+            std::sort(ref.begin(), ref.end(), total_order_less{});
+            std::reverse(ref.begin(), ref.end());
+            for(const std::size_t k : {std::size_t(0), std::size_t(1), std::size_t(1000), N, N + 1})
+            {
+                for(const std::size_t threads : {1, 3})
+                {
+                    const auto top = top_k(std::span<const Float>(xs), k, threads);
+                    bool ok = top.size() == std::min(k, N);
+                    for(std::size_t i=0; ok && i<top.size(); ++i) {ok = top[i].base() == ref[i].base();}
+                    boost::ut::expect(ok) << name << ": k = " << k << " on " << threads << " threads";
+                }
+            }
+        };
+        check(float32{},     "float32");
+        check(float16{},     "float16");
+        check(float8_e5m2{}, "float8_e5m2"); // many ties at the k-th key
+    };
+
+    "key_histogram"_test = [=]
+    {
+        const auto xs = random_inputs(float16{}, N);
+        for(const std::size_t bits : {1, 6, 16})
+        {
+            std::vector<std::uint64_t> ref(std::size_t(1) << bits);
+            for(const auto& x : xs) {ref[total_order_key(x) >> (16 - bits)] += 1;}
+            boost::ut::expect(key_histogram(std::span<const float16>(xs), bits, 1) == ref);
+            boost::ut::expect(key_histogram(std::span<const float16>(xs), bits, 3) == ref);
+        }
+
+        // binades: the bin of 1 + exponent_bits bits has the sign and the exponent
+        const std::vector<float16> ones{float16(0, 15, 0), float16(0, 15, 0x3FF), float16(1, 15, 1)};
+        const auto h = key_histogram(std::span<const float16>(ones), 6);
+        boost::ut::expect(h[32 + 15] == 2u);
+        boost::ut::expect(h[31 - 15] == 1u);
+    };
+};
+
+} // flemu
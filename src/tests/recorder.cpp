@@ -0,0 +1,122 @@
+#include <flemu/recorder.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <filesystem>
+#include <future>
+#include <thread>
+
+namespace flemu
+{
+
+boost::ut::suite tests_recorder = []
+{
+    using namespace boost::ut::literals;
+
+    "recorder"_test = []
+    {
+        static_assert(recorder::format_code<float32>     == 0x0817);
+        static_assert(recorder::format_code<bfloat16>    == 0x0807);
+        static_assert(recorder::format_code<float8_e4m3> == 0x0403);
+        static_assert(recorder::format_code<basic_float<5, 2, 16>> == 0); // not an IEEE bias
+
+        const auto path = std::filesystem::temp_directory_path() / "flemu_recorder_test.bin";
+
+        // nothing is recorded while it is stopped
+        recorder::record_op<float32, rounding::nearest_even>(recorder::opcode::add,
+            float32(1u), float32(2u), float32(0u), float32(3u));
+
+        boost::ut::expect(recorder::start(path));
+        boost::ut::expect(!recorder::start(path)) << "already running";
+
+        // more than a buffer, so that it is written in two or more parts
+        const std::size_t n = recorder::detail::buffer_records + 10;
+        for(std::size_t i=0; i<n; ++i)
+        {
+            recorder::record_op<float32, rounding::toward_zero>(recorder::opcode::add,
+                float32(std::uint32_t(i)), float32(2u), float32(0u), float32(std::uint32_t(i + 2)));
+        }
+        recorder::record_op<bfloat16, rounding::stochastic<rounding::hash_rng>>(recorder::opcode::fma,
+            bfloat16(std::uint16_t(1)), bfloat16(std::uint16_t(2)), bfloat16(std::uint16_t(3)),
+            bfloat16(std::uint16_t(4)));
+        recorder::stop();
+
+        // stopped again
+        recorder::record_op<float32, rounding::nearest_even>(recorder::opcode::add,
+            float32(1u), float32(2u), float32(0u), float32(3u));
+
+        const auto records = recorder::read_records(path);
+        boost::ut::expect(records.size() == n + 1) << records.size();
+        if(records.size() == n + 1)
+        {
+            bool ok = true;
+            for(std::size_t i=0; i<n; ++i)
+            {
+                const auto& r = records[i];
+                ok = ok && r.op == recorder::opcode::add && r.rounding == recorder::rounding_id::toward_zero &&
+                     r.format == 0x0817 && r.a == i && r.b == 2u && r.c == 0u && r.result == i + 2;
+            }
+            boost::ut::expect(ok);
+
+            const auto& r = records[n];
+            boost::ut::expect(r.op == recorder::opcode::fma && r.rounding == recorder::rounding_id::other &&
+                              r.format == 0x0807 && r.a == 1u && r.b == 2u && r.c == 3u && r.result == 4u);
+        }
+        std::filesystem::remove(path);
+    };
+
+    "recorder, records of an older session"_test = []
+    {
+        const auto old_path = std::filesystem::temp_directory_path() / "flemu_recorder_old.bin";
+        const auto new_path = std::filesystem::temp_directory_path() / "flemu_recorder_new.bin";
+        const auto op = [](const std::uint32_t a) {
+            recorder::record_op<float32, rounding::nearest_even>(recorder::opcode::add,
+                float32(a), float32(0u), float32(0u), float32(a));
+        };
+
+        // two threads record to the first session and do not flush. after the
+        // restart, one records again (its buffer is reused) and the other only
+        // exits (its buffer is flushed).
+        std::promise<void> recorded_1, recorded_2, restarted_1, restarted_2;
+        auto restart_1 = restarted_1.get_future();
+        auto restart_2 = restarted_2.get_future();
+        boost::ut::expect(recorder::start(old_path));
+        std::thread t1([&] {
+            op(1); op(2);
+            recorded_1.set_value();
+            restart_1.wait();
+            op(10); op(11);
+        });
+        std::thread t2([&] {
+            op(3);
+            recorded_2.set_value();
+            restart_2.wait();
+        });
+        recorded_1.get_future().wait();
+        recorded_2.get_future().wait();
+        recorder::stop();
+
+        boost::ut::expect(recorder::start(new_path));
+        op(12);
+        restarted_1.set_value();
+        restarted_2.set_value();
+        t1.join();
+        t2.join();
+        recorder::stop();
+
+        const auto records = recorder::read_records(new_path);
+        std::uint32_t sum = 0;
+        for(const auto& r : records)
+        {
+            sum += r.a;
+        }
+        boost::ut::expect(records.size() == 3u && sum == 10u + 11u + 12u) << records.size();
+        boost::ut::expect(recorder::read_records(old_path).empty());
+        std::filesystem::remove(old_path);
+        std::filesystem::remove(new_path);
+    };
+};
+
+} // flemu
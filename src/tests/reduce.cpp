@@ -0,0 +1,89 @@
+#include <flemu/reduce.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_reduce = []
+{
+    using namespace boost::ut::literals;
+
+    // the orders written as plain recursions
+    const auto reference_pairwise = [](std::span<const float32> x) {
+        const auto rec = [](const auto& self, std::span<const float32> v) -> float32 {
+            if(v.size() == 1) {return v[0];}
+            const std::size_t m = std::bit_floor(v.size() - 1);
+            return add(self(self, v.first(m)), self(self, v.subspan(m)));
+        };
+        return x.empty() ? float32(0u) : rec(rec, x);
+    };
+    const auto reference_blocked = [=](std::span<const float32> x, const std::size_t block) {
+        constexpr std::size_t lanes = reduction::blocked_tree::lanes;
+        std::vector<float32> sums;
+        for(std::size_t b=0; b<x.size(); b+=block)
+        {
+            const auto blk = x.subspan(b, std::min(block, x.size() - b));
+            std::vector<float32> acc(blk.begin(), blk.begin() + std::min(lanes, blk.size()));
+            for(std::size_t i=lanes; i<blk.size(); ++i)
+            {
+                acc[i % lanes] = add(acc[i % lanes], blk[i]);
+            }
+            sums.push_back(reference_pairwise(acc));
+        }
+        return reference_pairwise(sums);
+    };
+
+    "reduce"_test = [=]
+    {
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> sgn(0, 1);
+        std::uniform_int_distribution<std::uint32_t> exp(100, 150);
+        std::uniform_int_distribution<std::uint32_t> man(0, 0x007F'FFFF);
+
+        std::vector<float32> xs(300000);
+        for(auto& x : xs)
+        {
+            x = float32((sgn(rng) << 31) + (exp(rng) << 23) + man(rng));
+        }
+
+        for(const std::size_t n : {0, 1, 2, 3, 7, 64, 65, 4095, 4096, 4097, 100000, 300000})
+        {
+            const std::span<const float32> x(xs.data(), n);
+
+            float32 seq = n == 0 ? float32(0u) : x[0];
+            for(std::size_t i=1; i<n; ++i) {seq = add(seq, x[i]);}
+            const float32 pw  = reference_pairwise(x);
+            const float32 blk = reference_blocked(x, 1000);
+
+            for(const std::size_t threads : {1, 2, 3, 8})
+            {
+                boost::ut::expect(reduce(x, reduction::sequential{}, threads).base() == seq.base())
+                    << "sequential, n = " << n << ", threads = " << threads;
+                boost::ut::expect(reduce(x, reduction::pairwise{}, threads).base() == pw.base())
+                    << "pairwise, n = " << n << ", threads = " << threads;
+                boost::ut::expect(reduce(x, reduction::blocked_tree{1000}, threads).base() == blk.base())
+                    << "blocked_tree, n = " << n << ", threads = " << threads;
+            }
+        }
+
+        // the orders do make a difference
+        const std::span<const float32> x(xs);
+        boost::ut::expect(reduce(x, reduction::sequential{}).base() != reduce(x, reduction::pairwise{}).base());
+
+        // other formats use the scalar batch add
+        std::vector<bfloat16> hs(5000, bfloat16(0, 127, 0)); // 1.0
+        const std::span<const bfloat16> h(hs);
+        boost::ut::expect(reduce(h, reduction::pairwise{}).base() == bfloat16(0, 127 + 12, 0x1C).base()); // 4096 + 904 ~ 5000
+        boost::ut::expect(reduce(h, reduction::sequential{}).base() == bfloat16(0, 127 + 8, 0).base()); // stops at 256
+    };
+};
+
+} // flemu
@@ -0,0 +1,116 @@
+#ifndef FLEMU_TESTS_TEST_DETAIL_HPP
+#define FLEMU_TESTS_TEST_DETAIL_HPP
+
+#include <flemu/add_probe.hpp>
+#include <flemu/rounding.hpp>
+#include <flemu/utility.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+#include <type_traits>
+
+// the reference implementations that the tests of several headers compare
+// with.
+namespace flemu
+{
+
+namespace test_detail
+{
+
+// exact value of x in double. it is exact for the formats up to 16 bits.
+template<typename Float>
+double to_double(const Float x)
+{
+    using base_type = typename Float::base_type;
+    const double sgn = (base_type(x.sign()) == 0) ? 1.0 : -1.0;
+    const int    exp = base_type(x.exponent());
+    const double man = base_type(x.mantissa());
+    if(x.is_nan()) {return std::nan("");}
+    if(x.is_inf()) {return sgn * HUGE_VAL;}
+
+    const int scale = int(Float::exponent_bias + Float::mantissa_bits);
+    return (exp == 0) ? sgn * std::ldexp(man, 1 - scale) :
+        sgn * std::ldexp(man + std::ldexp(1.0, Float::mantissa_bits), exp - scale);
+}
+
+// reference rounding of a double to the format in a deterministic rounding
+// mode. it binary-searches the encodings of non-negative numbers, which are
+// sorted by value. the sign of zero is the sign of v.
+template<typename Float, typename Rounding>
+Float round_to(const double v, const Rounding&)
+{
+    using base_type = typename Float::base_type;
+    const base_type sgn = std::signbit(v) ? 1 : 0;
+    const double a = std::abs(v);
+    if(std::isnan(v)) {return Float(0, Float::exponent_max, 1);}
+    if(std::isinf(v)) {return Float(sgn, Float::exponent_max, 0);}
+
+    // the encoding of inf is the next power of 2 of the max finite number.
+    const std::uint64_t inf = std::uint64_t(Float::exponent_max) << Float::mantissa_bits;
+    const auto value = [](const std::uint64_t enc) {
+        return to_double(Float(0, base_type(enc >> Float::mantissa_bits),
+                               base_type(enc & mask<std::uint64_t>(Float::mantissa_bits-1, 0))));
+    };
+    const auto next_value = [&](const std::uint64_t enc) {
+        return (enc + 1 == inf) ? std::ldexp(1.0, int(Float::exponent_max) - int(Float::exponent_bias))
+                                : value(enc + 1);
+    };
+
+    std::uint64_t lo = 0, hi = inf; // value(lo) <= a < value(hi)
+    if(a >= next_value(inf - 1))
+    {
+        const std::uint64_t enc = inf - Rounding::overflow_to_max(std::uint32_t(sgn));
+        return Float(base_type((std::uint64_t(sgn) << Float::sign_bit) | enc));
+    }
+    while(hi - lo > 1)
+    {
+        const std::uint64_t mid = lo + (hi - lo) / 2;
+        if(value(mid) <= a) {lo = mid;} else {hi = mid;}
+    }
+    const double lower = value(lo);
+    const double upper = next_value(lo);
+    bool up = false;
+    if constexpr(std::is_same_v<Rounding, rounding::nearest_even>)
+    {
+        up = a - lower > upper - a || (a - lower == upper - a && lo % 2 == 1);
+    }
+    else if constexpr(std::is_same_v<Rounding, rounding::toward_positive>)
+    {
+        up = a != lower && sgn == 0;
+    }
+    else if constexpr(std::is_same_v<Rounding, rounding::toward_negative>)
+    {
+        up = a != lower && sgn == 1;
+    }
+    const std::uint64_t enc = lo + (up ? 1 : 0);
+    return Float(base_type((std::uint64_t(sgn) << Float::sign_bit) | enc));
+}
+
+template<typename Float>
+Float round_to_nearest(const double v)
+{
+    return round_to<Float>(v, rounding::nearest_even{});
+}
+
+template<typename Float>
+bool same_value(const Float x, const Float y)
+{
+    return (x.is_nan() && y.is_nan()) || x.base() == y.base();
+}
+
+// sets the bits of the add_points taken.
+struct taken_probe
+{
+    static constexpr bool enabled = true;
+    std::uint64_t* taken;
+
+    void operator()(const add_point p, const bool t) const noexcept
+    {
+        *taken |= t ? std::uint64_t(1) << static_cast<std::uint32_t>(p) : 0u;
+    }
+};
+
+} // test_detail
+} // flemu
+#endif // FLEMU_TESTS_TEST_DETAIL_HPP
@@ -0,0 +1,82 @@
+#include <flemu/total_order.hpp>
+#include "test_detail.hpp"
+
+#include <boost/ut.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_total_order = []
+{
+    using namespace boost::ut::literals;
+
+    "total_order_key"_test = []
+    {
+        // all the encodings of float16, sorted by the key
+        std::vector<float16> xs;
+        for(std::uint32_t b=0; b<0x10000u; ++b)
+        {
+            xs.push_back(float16(static_cast<std::uint16_t>(b)));
+        }
+        std::sort(xs.begin(), xs.end(), total_order_less{});
+
+        bool bijective = true;
+        bool ordered   = true;
+        for(std::size_t i=0; i<xs.size(); ++i)
+        {
+            bijective = bijective && total_order_key(xs[i]) == i &&
+                        from_total_order_key<float16>(static_cast<std::uint16_t>(i)).base() == xs[i].base();
+            if(i != 0 && !xs[i].is_nan() && !xs[i-1].is_nan())
+            {
+                const double prev = test_detail::to_double(xs[i-1]);
+                const double curr = test_detail::to_double(xs[i]);
+                ordered = ordered && (prev < curr || (prev == 0.0 && curr == 0.0 &&
+                                                      std::signbit(prev) && !std::signbit(curr)));
+            }
+        }
+        boost::ut::expect(bijective);
+        boost::ut::expect(ordered);
+
+        // -nan first, +nan last
+        boost::ut::expect(xs.front().is_nan() && xs.front().sign() == 1u);
+        boost::ut::expect(xs.back().is_nan()  && xs.back().sign()  == 0u);
+        boost::ut::expect(xs[0x3FF].is_inf() && xs[0x3FF].sign() == 1u) << "-inf after the 0x3FF -nans";
+    };
+
+    "total_order"_test = []
+    {
+        const float32 neg_zero(0x8000'0000u), pos_zero(0u);
+        const float32 neg_nan(0xFFC0'0000u), pos_nan(0x7FC0'0000u), neg_inf(0xFF80'0000u);
+        boost::ut::expect( total_order(neg_zero, pos_zero));
+        boost::ut::expect(!total_order(pos_zero, neg_zero));
+        boost::ut::expect( total_order(neg_nan, neg_inf));
+        boost::ut::expect( total_order(neg_inf, pos_nan));
+        boost::ut::expect( total_order(pos_nan, pos_nan));
+        boost::ut::expect(total_order_compare(neg_zero, pos_zero) == std::strong_ordering::less);
+        boost::ut::expect(total_order_compare(pos_nan, pos_nan) == std::strong_ordering::equal);
+        static_assert(total_order_key(float8_e4m3(0x80u)) == 0x7Fu);
+
+        // the same as the hardware order on the numbers
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits;
+        bool same = true;
+        for(std::size_t i=0; i<100000; ++i)
+        {
+            const float32 x(bits(rng)), y(bits(rng));
+            if(x.is_nan() || y.is_nan()) {continue;}
+            const float xf = to_float(x), yf = to_float(y);
+            if(xf == yf) {continue;}
+            same = same && (total_order_less{}(x, y) == (xf < yf));
+        }
+        boost::ut::expect(same);
+    };
+};
+
+} // flemu
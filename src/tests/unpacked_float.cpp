@@ -0,0 +1,104 @@
+#include <flemu/unpacked_float.hpp>
+#include <flemu/operation_trace.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <random>
+
+namespace flemu
+{
+
+boost::ut::suite tests_unpacked_float = []
+{
+    using namespace boost::ut::literals;
+
+    "unpack/pack"_test = []
+    {
+        // all the bits of 8 and 16-bit formats go back to themselves
+        const auto roundtrip = [](auto tag) {
+            using float_type = decltype(tag);
+            using base_type  = typename float_type::base_type;
+            for(std::uint32_t i=0; i < (1u << (1 + float_type::sign_bit)); ++i)
+            {
+                const float_type x(static_cast<base_type>(i));
+                boost::ut::expect(pack(unpack(x)).base() == x.base()) << bits_of(x.base());
+            }
+        };
+        roundtrip(float8_e4m3{});
+        roundtrip(float8_e5m2{});
+        roundtrip(bfloat16{});
+        roundtrip(float16{});
+
+        constexpr auto one = unpack(float32(0x3F80'0000u));
+        static_assert(one.cls == float_class::finite && one.exponent == 0 && one.significand == 0x80'0000u);
+        constexpr auto den = unpack(float32(0x0000'0001u));
+        static_assert(den.exponent == -126 && den.significand == 1);
+        static_assert(unpack(float32(0xFF80'0000u)).is_inf() && unpack(float32(0x8000'0000u)).is_zero());
+    };
+
+    "add(unpacked_float)"_test = []
+    {
+        // fp8: all the pairs in all the modes, with the flags
+        const auto exhaustive = [](auto tag, const auto rnd) {
+            using float_type = decltype(tag);
+            for(std::uint32_t xi=0; xi<256; ++xi)
+            {
+                for(std::uint32_t yi=0; yi<256; ++yi)
+                {
+                    const float_type x(static_cast<std::uint8_t>(xi));
+                    const float_type y(static_cast<std::uint8_t>(yi));
+                    std::uint32_t f = 0, fu = 0;
+                    const auto z  = add(x, y, rnd, flags::accumulate{f});
+                    const auto zu = pack(add(unpack(x), unpack(y), rnd, flags::accumulate{fu}));
+                    boost::ut::expect(zu.base() == z.base() && fu == f) << bits_of(x.base()) << " + "
+                        << bits_of(y.base()) << " = " << bits_of(zu.base()) << " != " << bits_of(z.base());
+                }
+            }
+        };
+        exhaustive(float8_e4m3{}, rounding::nearest_even{});
+        exhaustive(float8_e4m3{}, rounding::toward_zero{});
+        exhaustive(float8_e4m3{}, rounding::toward_positive{});
+        exhaustive(float8_e5m2{}, rounding::toward_negative{});
+        exhaustive(float8_e5m2{}, rounding::nearest_even{});
+        exhaustive(float8_e5m2{}, rounding::stochastic<rounding::hash_rng>{rounding::hash_rng{42}, 7});
+
+        // float32: long chains stay bit-identical to the packed ones
+        std::mt19937 rng(123456789);
+        std::uniform_int_distribution<std::uint32_t> bits;
+        std::uniform_int_distribution<std::uint32_t> exp(90, 160);
+        operation_trace<std::uint32_t, 2> trace("add");
+        for(std::size_t chain=0; chain<100; ++chain)
+        {
+            float32 acc(0u);
+            auto uacc = unpack(acc);
+            for(std::size_t i=0; i<1000; ++i)
+            {
+                // occasionally a special value or a denormal
+                std::uint32_t xi = (bits(rng) & 0x807F'FFFFu) | (exp(rng) << 23);
+                xi = (i % 97 == 0) ? (xi & 0x807F'FFFFu) : (i % 331 == 0) ? (xi | 0x7F80'0000u) : xi;
+
+                const auto prev = acc.base();
+                acc  = add(acc, float32(xi));
+                uacc = add(uacc, unpack(float32(xi)));
+                trace.record({prev, xi}, pack(uacc).base(), acc.base());
+                if(pack(uacc).base() != acc.base())
+                {
+                    break;
+                }
+            }
+            boost::ut::expect(pack(uacc).base() == acc.base()) << trace;
+        }
+
+        // the rounding and the overflow
+        constexpr auto max = unpack(float32(0x7F7F'FFFFu));
+        static_assert(add(max, max).is_inf());
+        static_assert(pack(add(max, max, rounding::toward_zero{})).base() == 0x7F7F'FFFFu);
+        static_assert(pack(add(unpack(float32(0x3F80'0000u)), unpack(float32(0x3380'0000u)))).base() == 0x3F80'0000u);
+        static_assert(pack(add(unpack(float32(0x3F80'0000u)), unpack(float32(0x3380'0000u)),
+                               rounding::toward_positive{})).base() == 0x3F80'0001u);
+    };
+};
+
+} // flemu
@@ -0,0 +1,53 @@
+#include <flemu/utility.hpp>
+
+#include <boost/ut.hpp>
+
+#include <cstdint>
+
+#include <sstream>
+#include <string>
+
+namespace flemu
+{
+
+boost::ut::suite tests_utility = [] {
+    using namespace boost::ut::literals;
+
+    "mask"_test = [] {
+        boost::ut::expect(mask<std::uint32_t>( 1,  3) == 0b00001110);
+        boost::ut::expect(mask<std::uint32_t>( 3,  1) == 0b00001110);
+        boost::ut::expect(mask<std::uint32_t>( 3,  3) == 0b00001000);
+        boost::ut::expect(mask<std::uint32_t>(31,  0) == 0xFFFFFFFF);
+        boost::ut::expect(mask<std::uint32_t>( 0, 31) == 0xFFFFFFFF);
+        boost::ut::expect(mask<std::uint32_t>(31, 31) == 0x80000000);
+
+        boost::ut::expect(mask<std::uint64_t>(31,  0) == 0xFFFF'FFFF);
+        boost::ut::expect(mask<std::uint64_t>(47, 32) == 0x0000'FFFF'0000'0000);
+        boost::ut::expect(mask<std::uint64_t>(63,  0) == 0xFFFF'FFFF'FFFF'FFFFull);
+        boost::ut::expect(mask<std::uint64_t>(63, 63) == 0x8000'0000'0000'0000ull);
+    };
+
+    "bit_cast"_test = [] {
+#if defined(__cpp_lib_bit_cast)
+        static_assert(bit_cast<std::uint32_t>(1.0f) == 0x3F80'0000u);
+        static_assert(bit_cast<float>(0xC000'0000u) == -2.0f);
+#endif
+        boost::ut::expect(bit_cast<std::uint32_t>(1.0f) == 0x3F80'0000u);
+        boost::ut::expect(bit_cast<float>(0xC000'0000u) == -2.0f);
+    };
+
+    "format_bits"_test = [] {
+        static_assert(format_bits(std::uint8_t(0x5A)).view() == "0101'1010");
+        static_assert(bit_string<std::uint16_t>::length == 19);
+
+        boost::ut::expect(format_bits(0xDEAD'BEEFu).view() == "1101'1110'1010'1101'1011'1110'1110'1111");
+        boost::ut::expect(format_bits(std::uint64_t(1)).view().size() == 64 + 15);
+        boost::ut::expect(std::string(format_bits(0xDEAD'BEEFu).data()) == as_bit(0xDEAD'BEEFu));
+
+        std::ostringstream oss;
+        oss << bits_of(std::uint16_t(0x8001)) << ' ' << format_bits(std::uint8_t(3));
+        boost::ut::expect(oss.str() == "1000'0000'0000'0001 0000'0011");
+    };
+};
+
+} // flemu
@@ -0,0 +1,37 @@
+#include <flemu/work_stealing.hpp>
+
+#include <boost/ut.hpp>
+
+#include <atomic>
+#include <vector>
+
+namespace flemu
+{
+
+boost::ut::suite tests_work_stealing = []
+{
+    using namespace boost::ut::literals;
+
+    "parallel_for"_test = []
+    {
+        for(const std::size_t num_tasks : {0, 1, 7, 1000})
+        {
+            for(const std::size_t num_workers : {1, 2, 3, 8})
+            {
+                std::vector<std::atomic<int>> counts(num_tasks);
+                parallel_for(num_tasks, num_workers,
+                    [&](const std::size_t task, const std::size_t worker) {
+                        boost::ut::expect(worker < num_workers);
+                        counts[task].fetch_add(1);
+                    });
+                for(std::size_t i=0; i<num_tasks; ++i)
+                {
+                    boost::ut::expect(counts[i].load() == 1)
+                        << "task " << i << " ran " << counts[i].load() << " times";
+                }
+            }
+        }
+    };
+};
+
+} // flemu
@@ -0,0 +1,416 @@
+#include <flemu/adder.hpp>
+#include <flemu/batch_adder.hpp>
+#include <flemu/work_stealing.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Differential verification of flemu::add against the native float addition.
+//
+// The input space is divided into slices that are swept in parallel:
+//
+//  - exponent_pair(ex, ey): all 256x256 exponent pairs. boundary mantissas
+//    (all combinations x 4 sign patterns) + `samples` random pairs.
+//  - denormal(i)          : all 2^23 denormal mantissas (1/64 per slice) added
+//    to normal numbers with small exponents, including the denormal boundary.
+//  - cancellation(e)      : x + (-x + a few ulps) and x + (-y) with exp(y) ==
+//    exp(x) - 1, where massive normalization shift happens.
+//
+// Finished slices are appended to the checkpoint file, so an interrupted
+// campaign can be resumed by running it again with the same options.
+//
+// usage: verify [--threads N] [--samples M] [--seed S] [--examples K]
+//               [--checkpoint FILE] [--target scalar|batch]
+
+namespace
+{
+
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+
+constexpr std::size_t num_exponent_pair_slices = 256 * 256;
+constexpr std::size_t num_denormal_slices      = 64;
+constexpr std::size_t num_cancellation_slices  = 254;
+constexpr std::size_t num_slices = num_exponent_pair_slices +
+    num_denormal_slices + num_cancellation_slices;
+
+constexpr std::array<u32, 12> boundary_mantissas = {
+    0x00'0000, 0x00'0001, 0x00'0002, 0x00'0003, 0x00'0007, 0x00'0008,
+    0x3F'FFFF, 0x40'0000, 0x40'0001, 0x7F'FFFC, 0x7F'FFFE, 0x7F'FFFF,
+};
+
+struct options
+{
+    std::size_t threads  = flemu::default_concurrency();
+    std::size_t samples  = 1 << 14;
+    std::size_t examples = 4;
+    u64         seed     = 123456789;
+    std::string checkpoint;
+    std::string target   = "scalar";
+};
+
+struct counterexample
+{
+    u32 x, y, got, expected;
+};
+
+struct slice_result
+{
+    std::size_t id      = 0;
+    u64 checked         = 0;
+    u64 mismatches      = 0;
+    std::vector<counterexample> examples;
+};
+
+// counter-based, so that each slice generates the same inputs on resume
+// regardless of which thread runs it.
+constexpr u64 splitmix64(u64 x) noexcept
+{
+    x += 0x9E37'79B9'7F4A'7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58'476D'1CE4'E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D0'49BB'1331'11EBull;
+    return x ^ (x >> 31);
+}
+
+struct counter_rng
+{
+    u64 key;
+    u64 counter = 0;
+    u32 operator()() noexcept {return static_cast<u32>(splitmix64(key ^ splitmix64(counter++)));}
+};
+
+constexpr u32 pack(const u32 sgn, const u32 exp, const u32 man) noexcept
+{
+    return (sgn << 31) | ((exp & 0xFF) << 23) | (man & 0x7F'FFFF);
+}
+
+constexpr bool is_nan_bits(const u32 x) noexcept
+{
+    return (x & 0x7FFF'FFFFu) > 0x7F80'0000u;
+}
+
+std::string slice_name(const std::size_t id)
+{
+    std::ostringstream oss;
+    if(id < num_exponent_pair_slices)
+    {
+        oss << "exponent_pair(" << id / 256 << ", " << id % 256 << ")";
+    }
+    else if(id < num_exponent_pair_slices + num_denormal_slices)
+    {
+        oss << "denormal(" << id - num_exponent_pair_slices << ")";
+    }
+    else
+    {
+        oss << "cancellation(" << id - num_exponent_pair_slices - num_denormal_slices + 1 << ")";
+    }
+    return oss.str();
+}
+
+void generate_slice(const std::size_t id, const options& opt,
+                    std::vector<flemu::float32>& xs, std::vector<flemu::float32>& ys)
+{
+    xs.clear();
+    ys.clear();
+    counter_rng rng{splitmix64(opt.seed) ^ (u64(id) << 32)};
+    const auto push = [&](const u32 x, const u32 y) {
+        xs.emplace_back(x);
+        ys.emplace_back(y);
+    };
+
+    if(id < num_exponent_pair_slices)
+    {
+        const u32 ex = id / 256;
+        const u32 ey = id % 256;
+        for(const u32 mx : boundary_mantissas)
+        {
+            for(const u32 my : boundary_mantissas)
+            {
+                for(u32 s=0; s<4; ++s)
+                {
+                    push(pack(s & 1, ex, mx), pack(s >> 1, ey, my));
+                }
+            }
+        }
+        for(std::size_t i=0; i<opt.samples; ++i)
+        {
+            const u32 r = rng();
+            push(pack(r & 1, ex, rng()), pack((r >> 1) & 1, ey, rng()));
+        }
+    }
+    else if(id < num_exponent_pair_slices + num_denormal_slices)
+    {
+        const u32 stride = (1u << 23) / num_denormal_slices;
+        const u32 first  = (id - num_exponent_pair_slices) * stride;
+        for(u32 mx=first; mx<first+stride; ++mx)
+        {
+            const u32 r = rng();
+            push(pack(r & 1, 0, mx), pack((r >> 1) & 1, (r >> 2) % 28, rng()));
+        }
+    }
+    else
+    {
+        const u32 e = id - num_exponent_pair_slices - num_denormal_slices + 1;
+        for(std::size_t i=0; i<opt.samples; ++i)
+        {
+            const u32 r = rng();
+            const u32 x = pack(r & 1, e, rng());
+            if((r >> 1) & 1)
+            {
+                const u32 delta = (r >> 2) % 129; // +- 64 ulps
+                push(x, (x ^ 0x8000'0000u) + delta - 64);
+            }
+            else
+            {
+                push(x, pack(((r & 1) ^ 1), e - 1, rng() | 0x40'0000));
+            }
+        }
+    }
+}
+
+slice_result run_slice(const std::size_t id, const options& opt,
+                       std::vector<flemu::float32>& xs, std::vector<flemu::float32>& ys,
+                       std::vector<flemu::float32>& zs)
+{
+    generate_slice(id, opt, xs, ys);
+    zs.resize(xs.size());
+
+    if(opt.target == "batch")
+    {
+        flemu::add(xs, ys, zs);
+    }
+    else
+    {
+        for(std::size_t i=0; i<xs.size(); ++i)
+        {
+            zs[i] = flemu::add(xs[i], ys[i]);
+        }
+    }
+
+    slice_result result;
+    result.id      = id;
+    result.checked = xs.size();
+    for(std::size_t i=0; i<xs.size(); ++i)
+    {
+        const float xr = flemu::to_float(xs[i]);
+        const float yr = flemu::to_float(ys[i]);
+        const u32 expected = flemu::bit_cast<u32>(xr + yr);
+        const u32 got      = zs[i].base();
+
+        const bool ok = is_nan_bits(expected) ? is_nan_bits(got) : (got == expected);
+        if(!ok)
+        {
+            result.mismatches += 1;
+            if(result.examples.size() < opt.examples)
+            {
+                result.examples.push_back({xs[i].base(), ys[i].base(), got, expected});
+            }
+        }
+    }
+    return result;
+}
+
+std::string checkpoint_header(const options& opt)
+{
+    std::ostringstream oss;
+    oss << "# flemu-verify seed=" << opt.seed << " samples=" << opt.samples
+        << " target=" << opt.target;
+    return oss.str();
+}
+
+void write_slice(std::ostream& os, const slice_result& r)
+{
+    os << "slice " << r.id << ' ' << r.checked << ' ' << r.mismatches << ' ' << r.examples.size();
+    for(const auto& ex : r.examples)
+    {
+        os << ' ' << ex.x << ' ' << ex.y << ' ' << ex.got << ' ' << ex.expected;
+    }
+    os << '\n';
+}
+
+// returns false if the checkpoint was created with different options.
+bool read_checkpoint(const options& opt, std::vector<slice_result>& done, std::vector<bool>& is_done)
+{
+    std::ifstream ifs(opt.checkpoint);
+    if(!ifs.good())
+    {
+        return true; // new campaign
+    }
+    std::string line;
+    if(std::getline(ifs, line) && line != checkpoint_header(opt))
+    {
+        std::cerr << "error: " << opt.checkpoint << " was created with different options: "
+                  << line << std::endl;
+        return false;
+    }
+    while(std::getline(ifs, line))
+    {
+        std::istringstream iss(line);
+        std::string tag;
+        slice_result r;
+        std::size_t num_examples = 0;
+        if(!(iss >> tag >> r.id >> r.checked >> r.mismatches >> num_examples) ||
+           tag != "slice" || r.id >= num_slices)
+        {
+            continue; // a partially written line of an interrupted run
+        }
+        for(std::size_t i=0; i<num_examples; ++i)
+        {
+            counterexample ex;
+            if(iss >> ex.x >> ex.y >> ex.got >> ex.expected)
+            {
+                r.examples.push_back(ex);
+            }
+        }
+        if(!is_done[r.id])
+        {
+            is_done[r.id] = true;
+            done.push_back(std::move(r));
+        }
+    }
+    return true;
+}
+
+options parse_options(int argc, char** argv)
+{
+    options opt;
+    for(int i=1; i<argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const bool has_value = (i + 1 < argc);
+        if     (arg == "--threads"    && has_value) {opt.threads    = std::stoull(argv[++i]);}
+        else if(arg == "--samples"    && has_value) {opt.samples    = std::stoull(argv[++i]);}
+        else if(arg == "--seed"       && has_value) {opt.seed       = std::stoull(argv[++i]);}
+        else if(arg == "--examples"   && has_value) {opt.examples   = std::stoull(argv[++i]);}
+        else if(arg == "--checkpoint" && has_value) {opt.checkpoint = argv[++i];}
+        else if(arg == "--target"     && has_value) {opt.target     = argv[++i];}
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--threads N] [--samples M] [--seed S]"
+                         " [--examples K] [--checkpoint FILE] [--target scalar|batch]\n";
+            std::exit(2);
+        }
+    }
+    if(opt.target != "scalar" && opt.target != "batch")
+    {
+        std::cerr << "error: unknown target: " << opt.target << std::endl;
+        std::exit(2);
+    }
+    return opt;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    const options opt = parse_options(argc, argv);
+
+    std::vector<slice_result> results;
+    std::vector<bool> is_done(num_slices, false);
+    if(!opt.checkpoint.empty() && !read_checkpoint(opt, results, is_done))
+    {
+        return 2;
+    }
+    std::vector<std::size_t> todo;
+    for(std::size_t id=0; id<num_slices; ++id)
+    {
+        if(!is_done[id]) {todo.push_back(id);}
+    }
+    std::cerr << "verify: " << todo.size() << " / " << num_slices << " slices to run on "
+              << opt.threads << " threads" << std::endl;
+
+    std::ofstream checkpoint;
+    if(!opt.checkpoint.empty())
+    {
+        const bool fresh = results.empty();
+        checkpoint.open(opt.checkpoint, std::ios::app);
+        if(fresh)
+        {
+            checkpoint << checkpoint_header(opt) << '\n';
+        }
+    }
+
+    struct alignas(64) buffers
+    {
+        std::vector<flemu::float32> xs, ys, zs;
+    };
+    std::vector<buffers> workspace(opt.threads);
+
+    std::mutex mtx;
+    std::size_t finished = 0;
+    u64 checked_now = 0;
+    auto last_report = std::chrono::steady_clock::now();
+    const auto start = last_report;
+
+    flemu::parallel_for(todo.size(), opt.threads,
+        [&](const std::size_t task, const std::size_t worker) {
+            auto& ws = workspace[worker];
+            slice_result r = run_slice(todo[task], opt, ws.xs, ws.ys, ws.zs);
+
+            std::lock_guard<std::mutex> lk(mtx);
+            if(checkpoint.is_open())
+            {
+                write_slice(checkpoint, r);
+                checkpoint.flush();
+            }
+            checked_now += r.checked;
+            results.push_back(std::move(r));
+            finished += 1;
+
+            const auto now = std::chrono::steady_clock::now();
+            if(now - last_report > std::chrono::seconds(10))
+            {
+                last_report = now;
+                std::cerr << "verify: " << finished << " / " << todo.size() << " slices done"
+                          << std::endl;
+            }
+        });
+
+    const double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+    // ------------------------------------------------------------------------
+    // report
+
+    std::sort(results.begin(), results.end(),
+              [](const auto& lhs, const auto& rhs) {return lhs.id < rhs.id;});
+
+    u64 checked = 0, mismatches = 0;
+    for(const auto& r : results)
+    {
+        checked    += r.checked;
+        mismatches += r.mismatches;
+    }
+    for(const auto& r : results)
+    {
+        if(r.mismatches == 0) {continue;}
+
+        std::printf("%s: %llu / %llu mismatches\n", slice_name(r.id).c_str(),
+                    static_cast<unsigned long long>(r.mismatches),
+                    static_cast<unsigned long long>(r.checked));
+        for(const auto& ex : r.examples)
+        {
+            std::printf("    %s + %s = %s, expected %s\n",
+                flemu::format_bits(ex.x).data(), flemu::format_bits(ex.y).data(),
+                flemu::format_bits(ex.got).data(), flemu::format_bits(ex.expected).data());
+        }
+    }
+    std::printf("slices: %zu / %zu, comparisons: %llu, mismatches: %llu\n",
+                results.size(), num_slices,
+                static_cast<unsigned long long>(checked),
+                static_cast<unsigned long long>(mismatches));
+    std::printf("elapsed: %.1f s, %.3g comparisons/s in this run\n", elapsed,
+                elapsed == 0.0 ? 0.0 : static_cast<double>(checked_now) / elapsed);
+    return mismatches == 0 ? 0 : 1;
+}